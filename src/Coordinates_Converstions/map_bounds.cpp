@@ -5,29 +5,15 @@
 #include "m1.h"
 #include "../ms1helpers.h"
 #include "coords_conversions.hpp"
+#include "../map_data/map_store.hpp"
 
 double find_map_bounds() {
-    globals.max_lat = std::numeric_limits<double>::lowest();
-    globals.max_lon = std::numeric_limits<double>::lowest();
-    globals.min_lat = std::numeric_limits<double>::max();
-    globals.min_lon = std::numeric_limits<double>::max();
-    for (int i = 0; i < getNumberOfNodes(); ++i) {
-        const OSMNode* currentNode = getNodeByIndex(i);
-        LatLon coords = getNodeCoords(currentNode);
-        if (coords.latitude() > globals.max_lat) {
-            globals.max_lat = coords.latitude();
-        }
-        if (coords.latitude() < globals.min_lat) {
-            globals.min_lat = coords.latitude();
-        }
-        if (coords.longitude() > globals.max_lon) {
-            globals.max_lon = coords.longitude();
-        }
-        if (coords.longitude() < globals.min_lon) {
-            globals.min_lon = coords.longitude();
-        }
-    }
-
+    // the node bounding box is precomputed by osm_converter
+    const auto& summary = gisevo::map_data::streets_store().summary();
+    globals.max_lat = summary.max_lat;
+    globals.max_lon = summary.max_lon;
+    globals.min_lat = summary.min_lat;
+    globals.min_lon = summary.min_lon;
 
     return ((globals.min_lat + globals.max_lat)/2) * kDegreeToRadian;
 }
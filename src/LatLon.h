@@ -0,0 +1,25 @@
+#pragma once
+
+#include <ostream>
+
+/*
+ * A geographic position in degrees, as read from the converted map binaries
+ */
+class LatLon {
+public:
+    LatLon() = default;
+    LatLon(double latitude, double longitude) : latitude_(latitude), longitude_(longitude) {}
+
+    double latitude() const { return latitude_; }
+    double longitude() const { return longitude_; }
+
+    bool operator==(const LatLon& other) const = default;
+
+private:
+    double latitude_ = 0.0;
+    double longitude_ = 0.0;
+};
+
+inline std::ostream& operator<<(std::ostream& os, const LatLon& point) {
+    return os << "(" << point.latitude() << "," << point.longitude() << ")";
+}
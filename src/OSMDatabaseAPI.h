@@ -0,0 +1,75 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "LatLon.h"
+#include "OSMID.h"
+
+/*
+ * Raw OSM entity view of a map converted by tools/osm_converter
+ *
+ * The converter keeps the highway nodes and ways in <map>.streets.bin and the points of
+ * interest in <map>.osm.bin, so nodes and ways are served from the streets mapping and
+ * require loadStreetsDatabaseBIN() to have been called first.
+ *
+ * OSMNode and OSMWay are views into the memory-mapped file: the pointers returned by
+ * getNodeByIndex()/getWayByIndex() stay valid until the map is closed and must never be
+ * copied by value or deleted.
+ */
+
+class OSMEntity {
+public:
+    OSMEntity(const OSMEntity&) = delete;
+    OSMEntity& operator=(const OSMEntity&) = delete;
+
+protected:
+    OSMEntity() = default;
+};
+
+class OSMNode : public OSMEntity {
+public:
+    OSMID id() const;
+    LatLon coords() const;
+};
+
+class OSMWay : public OSMEntity {
+public:
+    OSMID id() const;
+    bool isClosed() const;
+};
+
+class OSMRelation : public OSMEntity {
+public:
+    OSMID id() const;
+};
+
+// Loading and closing
+bool loadOSMDatabaseBIN(const std::string& map_osm_database_filename);
+void closeOSMDatabase();
+
+// Counts
+int getNumberOfNodes();
+int getNumberOfWays();
+int getNumberOfRelations();
+
+// Entities by index
+const OSMNode* getNodeByIndex(int idx);
+const OSMWay* getWayByIndex(int idx);
+const OSMRelation* getRelationByIndex(int idx);
+
+// Tags
+// Ways carry the highway, name and maxspeed tags recovered from the converter output
+int getTagCount(const OSMNode* node);
+int getTagCount(const OSMWay* way);
+int getTagCount(const OSMRelation* relation);
+std::pair<std::string, std::string> getTagPair(const OSMNode* node, int tagIdx);
+std::pair<std::string, std::string> getTagPair(const OSMWay* way, int tagIdx);
+std::pair<std::string, std::string> getTagPair(const OSMRelation* relation, int tagIdx);
+
+// Geometry and membership
+LatLon getNodeCoords(const OSMNode* node);
+std::vector<OSMID> getWayMembers(const OSMWay* way);
+bool isClosedWay(const OSMWay* way);
+std::vector<TypedOSMID> getRelationMembers(const OSMRelation* relation);
+std::vector<std::string> getRelationMemberRoles(const OSMRelation* relation);
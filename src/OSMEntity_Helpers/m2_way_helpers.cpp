@@ -105,8 +105,7 @@ std::vector<way_info> create_vector_of_ways(std::unordered_map<OSMID, feature_da
             }
             way_nodes = getWayMembers(current_way);
             for (int j = 0; j < way_nodes.size(); ++j) {
-                auto search = globals.node_to_id.find(way_nodes[j]);
-                const OSMNode *current_node = search->second;
+                const OSMNode *current_node = findNodeByOSMID(way_nodes[j]);
                 LatLon node_position = current_node->coords();
                 double x_pos = lon_to_x(node_position.longitude());
                 double y_pos = lat_to_y(node_position.latitude());
@@ -140,9 +139,8 @@ void assign_type_to_way() {
     globals.ss_road_type.resize(getNumStreetSegments());
     for (uint i = 0; i < getNumStreetSegments(); ++i) {
         StreetSegmentInfo info = getStreetSegmentInfo(i);
-        auto search = globals.id_to_way.find(info.wayOSMID);
-        if (search != globals.id_to_way.end()) {
-            const OSMWay *current_way = search->second;
+        const OSMWay *current_way = findWayByOSMID(info.wayOSMID);
+        if (current_way != nullptr) {
             for (uint j = 0; j < getTagCount(current_way); ++j) {
                 std::pair<std::string, std::string> tag_pair = getTagPair(current_way, j);
                 if (tag_pair.first == "highway") {
@@ -177,11 +175,14 @@ void sortSubwayLines() {
                         std::vector<Point2D> a_way;
                         //Do not need to draw the platform
                         if (subway_relation.relation_roles[member_idx] != "platform") {
-                            const OSMWay *way = globals.id_to_way[osmId];
+                            const OSMWay *way = findWayByOSMID(osmId);
+                            if (way == nullptr) {
+                                continue;
+                            }
                             const std::vector<OSMID> &way_nodes = getWayMembers(way);
                             //loop through the nodes in the ways
                             for (const auto node: way_nodes) {
-                                const OSMNode *node_ptr = globals.node_to_id[node];
+                                const OSMNode *node_ptr = findNodeByOSMID(node);
                                 Point2D loc = latlonTopoint(getNodeCoords(node_ptr));
                                 a_way.push_back(loc);
                             }
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+// OpenStreetMap identifiers, stored as the signed 64-bit ids written by osm_converter
+using OSMID = std::int64_t;
+
+/*
+ * An OSMID tagged with the kind of entity it refers to
+ * Converts implicitly to the bare OSMID so it can be used as a lookup key
+ */
+class TypedOSMID {
+public:
+    enum EntityType {
+        Invalid = 0,
+        Node,
+        Way,
+        Relation
+    };
+
+    TypedOSMID() = default;
+    TypedOSMID(EntityType type, OSMID id) : type_(type), id_(id) {}
+
+    EntityType type() const { return type_; }
+    operator OSMID() const { return id_; }
+
+private:
+    EntityType type_ = Invalid;
+    OSMID id_ = 0;
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <string>
+#include "LatLon.h"
+#include "OSMID.h"
+
+/*
+ * Street-level view of a map converted by tools/osm_converter
+ *
+ * loadStreetsDatabaseBIN() memory-maps <map>.streets.bin; every accessor below reads
+ * straight out of the mapping, so opening a map costs little more than the page faults
+ * for the data that is actually touched, and concurrent processes share one physical copy.
+ * Points of interest live in <map>.osm.bin and become available once loadOSMDatabaseBIN()
+ * has been called for the same map.
+ */
+
+using IntersectionIdx = int;
+using StreetSegmentIdx = int;
+using StreetIdx = int;
+using POIIdx = int;
+using FeatureIdx = int;
+
+enum FeatureType {
+    UNKNOWN = 0,
+    PARK,
+    BEACH,
+    LAKE,
+    RIVER,
+    ISLAND,
+    BUILDING,
+    GREENSPACE,
+    GOLFCOURSE,
+    STREAM,
+    GLACIER
+};
+
+struct StreetSegmentInfo {
+    OSMID wayOSMID;         // OSM way this segment was split from
+    IntersectionIdx from;   // start of the segment (direction of travel for one way streets)
+    IntersectionIdx to;     // end of the segment
+    bool oneWay;            // true if travel is only allowed from -> to
+    int numCurvePoints;     // number of shape points between from and to
+    float speedLimit;       // in m/s
+    StreetIdx streetID;     // street this segment belongs to
+};
+
+// Loading and closing
+bool loadStreetsDatabaseBIN(const std::string& map_streets_database_filename);
+void closeStreetDatabase();
+
+// Counts
+int getNumIntersections();
+int getNumStreetSegments();
+int getNumStreets();
+int getNumPointsOfInterest();
+int getNumFeatures();
+
+// Intersections
+std::string getIntersectionName(IntersectionIdx intersectionIdx);
+LatLon getIntersectionPosition(IntersectionIdx intersectionIdx);
+OSMID getIntersectionOSMNodeID(IntersectionIdx intersectionIdx);
+int getNumIntersectionStreetSegment(IntersectionIdx intersectionIdx);
+StreetSegmentIdx getIntersectionStreetSegment(int streetSegmentNum, IntersectionIdx intersectionIdx);
+
+// Street segments
+StreetSegmentInfo getStreetSegmentInfo(StreetSegmentIdx streetSegmentIdx);
+LatLon getStreetSegmentCurvePoint(int curvePointNum, StreetSegmentIdx streetSegmentIdx);
+
+// Streets
+std::string getStreetName(StreetIdx streetIdx);
+
+// Points of interest
+std::string getPOIType(POIIdx poiIdx);
+std::string getPOIName(POIIdx poiIdx);
+LatLon getPOIPosition(POIIdx poiIdx);
+OSMID getPOIOSMNodeID(POIIdx poiIdx);
+
+// Natural features (the converter does not emit any yet, so the count is always 0)
+std::string getFeatureName(FeatureIdx featureIdx);
+FeatureType getFeatureType(FeatureIdx featureIdx);
+TypedOSMID getFeatureOSMID(FeatureIdx featureIdx);
+int getNumFeaturePoints(FeatureIdx featureIdx);
+LatLon getFeaturePoint(int pointIdx, FeatureIdx featureIdx);
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "StreetsDatabaseAPI.h"
+#include "m4.h"
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+// A delivery order better than every one reported before it
+struct CourierImprovement {
+    // the intersections in the order they are visited, from the depot back to it
+    const std::vector<IntersectionIdx>& stops;
+    // seconds, from the travel time matrix
+    double travel_time;
+    // since travelingCourier was called
+    std::chrono::milliseconds elapsed;
+};
+
+/*
+ * When travelingCourier stops improving its delivery order, and how it reports progress
+ * The optimiser threads stop at the first of: the time budget running out, the best order coming
+ * within target_gap of a lower bound on the travel time, or every thread trying stall_iterations
+ * moves in a row without improving on the best order it has seen. The budget runs from the call,
+ * so it includes computing the travel time matrix; searching for the routes of the final order
+ * afterwards is not counted.
+ *
+ * The lower bound is the cheapest leg into every stop and back into a depot, so it is loose and a
+ * small target gap may never be reached.
+ */
+struct CourierSolveOptions {
+    std::chrono::milliseconds time_budget{48000};
+    // (travel time - lower bound) / lower bound to stop at; 0 to only stop on time or stalling
+    double target_gap = 0;
+    std::size_t stall_iterations = 200000;
+    // optimiser threads, 0 for half the hardware threads
+    unsigned threads = 0;
+    // Called with the first order found and with every improvement on it, from the thread that
+    // found it, one call at a time
+    std::function<void(const CourierImprovement&)> on_improvement;
+};
+
+std::vector<CourierSubPath> travelingCourier(float turn_penalty, const std::vector<DeliveryInf>& deliveries,
+                                             const std::vector<IntersectionIdx>& depots,
+                                             const CourierSolveOptions& options);
@@ -0,0 +1,294 @@
+#include "courier_tour.hpp"
+#include "ms4helpers.hpp"
+
+#include <algorithm>
+#include <utility>
+
+CourierTour::CourierTour(const RouteMatrix& routes_matrix, const std::vector<IntersectionIdx>& path,
+                         const std::unordered_map<IntersectionIdx, int>& intersection_to_index,
+                         const std::unordered_map<IntersectionIdx, Delivery_details>& delivery_info)
+    : routes_matrix_(routes_matrix),
+      key_(path.size()),
+      position_(path.size()),
+      order_(path.size()),
+      forward_(path.size(), 0.0),
+      backward_(path.size(), 0.0),
+      before_(path.size()),
+      after_(path.size()) {
+    const int size = static_cast<int>(path.size());
+    // the first and last visit of every stop between the depots
+    std::unordered_map<IntersectionIdx, std::pair<int, int>> visits;
+    for (int p = 0; p < size; ++p) {
+        key_[p] = intersection_to_index.at(path[p]);
+        order_[p] = p;
+        if (p == 0 || p == size - 1) {
+            continue;
+        }
+        auto [visit, inserted] = visits.try_emplace(path[p], p, p);
+        if (!inserted) {
+            visit->second.second = p;
+        }
+    }
+
+    for (const auto& [pick_up, details] : delivery_info) {
+        const auto pick_up_visits = visits.find(pick_up);
+        if (pick_up_visits == visits.end()) {
+            continue;
+        }
+        for (const IntersectionIdx drop_off : details.corres_dropoff) {
+            const auto drop_off_visits = visits.find(drop_off);
+            if (drop_off == pick_up || drop_off_visits == visits.end()) {
+                continue;
+            }
+            after_[pick_up_visits->second.first].push_back(drop_off_visits->second.second);
+            before_[drop_off_visits->second.second].push_back(pick_up_visits->second.first);
+        }
+    }
+    for (int v = 0; v < size; ++v) {
+        for (std::vector<int>* visits_of : {&before_[v], &after_[v]}) {
+            std::sort(visits_of->begin(), visits_of->end());
+            visits_of->erase(std::unique(visits_of->begin(), visits_of->end()), visits_of->end());
+        }
+        for (const int drop_off : after_[v]) {
+            pairs_.emplace_back(v, drop_off);
+        }
+    }
+    refresh(0);
+}
+
+std::vector<IntersectionIdx> CourierTour::path() const {
+    std::vector<IntersectionIdx> path;
+    path.reserve(order_.size());
+    for (const int visit : order_) {
+        path.push_back(routes_matrix_.intersection(key_[visit]));
+    }
+    return path;
+}
+
+double CourierTour::leg(const int from_visit, const int to_visit) const {
+    return routes_matrix_.cost(key_[from_visit], key_[to_visit]);
+}
+
+void CourierTour::refresh(const int first) {
+    for (int p = first; p < size(); ++p) {
+        position_[order_[p]] = p;
+        if (p > 0) {
+            forward_[p] = forward_[p - 1] + leg_at(p - 1, p);
+            backward_[p] = backward_[p - 1] + leg_at(p, p - 1);
+        }
+    }
+}
+
+double CourierTour::swap_delta(int a, int b) const {
+    if (a > b) {
+        std::swap(a, b);
+    }
+    if (b == a + 1) {
+        return leg_at(a - 1, b) + leg_at(b, a) + leg_at(a, b + 1) -
+               (leg_at(a - 1, a) + leg_at(a, b) + leg_at(b, b + 1));
+    }
+    return leg_at(a - 1, b) + leg_at(b, a + 1) + leg_at(b - 1, a) + leg_at(a, b + 1) -
+           (leg_at(a - 1, a) + leg_at(a, a + 1) + leg_at(b - 1, b) + leg_at(b, b + 1));
+}
+
+// The visit at a moves later to b and the one at b earlier to a, past everything in between
+bool CourierTour::swap_feasible(int a, int b) const {
+    if (a > b) {
+        std::swap(a, b);
+    }
+    for (const int visit : after_[order_[a]]) {
+        if (position_[visit] <= b) {
+            return false;
+        }
+    }
+    for (const int visit : before_[order_[b]]) {
+        if (position_[visit] >= a) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void CourierTour::swap(const int a, const int b) {
+    std::swap(order_[a], order_[b]);
+    refresh(std::min(a, b));
+}
+
+// Taking the visit out joins its neighbours; it goes back in between the visits that end up
+// either side of position `to`
+double CourierTour::relocate_delta(const int from, const int to) const {
+    if (from == to) {
+        return 0;
+    }
+    const int before = from < to ? to : to - 1;
+    const int after = before + 1;
+    return leg_at(from - 1, from + 1) - leg_at(from - 1, from) - leg_at(from, from + 1) +
+           leg_at(before, from) + leg_at(from, after) - leg_at(before, after);
+}
+
+bool CourierTour::relocate_feasible(const int from, const int to) const {
+    const int visit = order_[from];
+    if (from < to) {
+        for (const int later : after_[visit]) {
+            if (position_[later] <= to) {
+                return false;
+            }
+        }
+    } else {
+        for (const int earlier : before_[visit]) {
+            if (position_[earlier] >= to) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void CourierTour::relocate(const int from, const int to) {
+    if (from < to) {
+        std::rotate(order_.begin() + from, order_.begin() + from + 1, order_.begin() + to + 1);
+    } else {
+        std::rotate(order_.begin() + to, order_.begin() + from, order_.begin() + from + 1);
+    }
+    refresh(std::min(from, to));
+}
+
+double CourierTour::reverse_delta(const int first, const int last) const {
+    const double inside = forward_[last] - forward_[first];
+    const double inside_reversed = backward_[last] - backward_[first];
+    return leg_at(first - 1, last) + inside_reversed + leg_at(first, last + 1) -
+           (leg_at(first - 1, first) + inside + leg_at(last, last + 1));
+}
+
+// Reversing only breaks the rule for a pick-up and drop-off that are both inside the run
+bool CourierTour::reverse_feasible(const int first, const int last) const {
+    for (int p = first; p <= last; ++p) {
+        for (const int later : after_[order_[p]]) {
+            if (position_[later] <= last) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void CourierTour::reverse(const int first, const int last) {
+    std::reverse(order_.begin() + first, order_.begin() + last + 1);
+    refresh(first);
+}
+
+bool CourierTour::tied(const int first, const int last, const int other_first, const int other_last) const {
+    auto inside = [this](int visit, int from, int to) { return position_[visit] >= from && position_[visit] <= to; };
+    if (last - first <= other_last - other_first) {
+        for (int p = first; p <= last; ++p) {
+            for (const int later : after_[order_[p]]) {
+                if (inside(later, other_first, other_last)) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+    for (int p = other_first; p <= other_last; ++p) {
+        for (const int earlier : before_[order_[p]]) {
+            if (inside(earlier, first, last)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Taking the run out joins its neighbours; the legs inside it turn around if it is reversed
+double CourierTour::move_run_delta(const int first, const int last, const int to, const bool reversed) const {
+    const int head = reversed ? last : first;
+    const int tail = reversed ? first : last;
+    const double inside = reversed ? (backward_[last] - backward_[first]) - (forward_[last] - forward_[first]) : 0;
+    return leg_at(first - 1, last + 1) - leg_at(first - 1, first) - leg_at(last, last + 1) +
+           leg_at(to, head) + leg_at(tail, to + 1) - leg_at(to, to + 1) + inside;
+}
+
+// The run passes the visits between it and `to`, so it cannot be tied to them
+bool CourierTour::move_run_feasible(const int first, const int last, const int to, const bool reversed) const {
+    if (reversed && !reverse_feasible(first, last)) {
+        return false;
+    }
+    return to > last ? !tied(first, last, last + 1, to) : !tied(to + 1, first - 1, first, last);
+}
+
+void CourierTour::move_run(const int first, const int last, const int to, const bool reversed) {
+    const int length = last - first + 1;
+    int start;
+    if (to > last) {
+        std::rotate(order_.begin() + first, order_.begin() + last + 1, order_.begin() + to + 1);
+        start = to - length + 1;
+    } else {
+        std::rotate(order_.begin() + to + 1, order_.begin() + first, order_.begin() + last + 1);
+        start = to + 1;
+    }
+    if (reversed) {
+        std::reverse(order_.begin() + start, order_.begin() + start + length);
+    }
+    refresh(std::min(first, to + 1));
+}
+
+std::pair<int, int> CourierTour::pair_positions(const int pair) const {
+    return {position_[pairs_[pair].first], position_[pairs_[pair].second]};
+}
+
+int CourierTour::next_without(int p, const int skip, const int also_skip) const {
+    do {
+        ++p;
+    } while (p == skip || p == also_skip);
+    return p;
+}
+
+double CourierTour::move_pair_delta(const int pick_up, const int drop_off, const int to) const {
+    double delta;
+    if (drop_off == pick_up + 1) {
+        delta = leg_at(pick_up - 1, drop_off + 1) -
+                (leg_at(pick_up - 1, pick_up) + leg_at(pick_up, drop_off) + leg_at(drop_off, drop_off + 1));
+    } else {
+        delta = leg_at(pick_up - 1, pick_up + 1) - leg_at(pick_up - 1, pick_up) - leg_at(pick_up, pick_up + 1) +
+                leg_at(drop_off - 1, drop_off + 1) - leg_at(drop_off - 1, drop_off) - leg_at(drop_off, drop_off + 1);
+    }
+    // the visits either side of the gap the pair goes into, once it is taken out
+    const int after = next_without(to, pick_up, drop_off);
+    return delta + leg_at(to, pick_up) + leg_at(pick_up, drop_off) + leg_at(drop_off, after) - leg_at(to, after);
+}
+
+// The pair keeps its own order; every other visit tied to either of them ends up on the side of
+// `to` it has to be on
+bool CourierTour::move_pair_feasible(const int pick_up, const int drop_off, const int to) const {
+    for (const int p : {pick_up, drop_off}) {
+        for (const int earlier : before_[order_[p]]) {
+            if (position_[earlier] > to && position_[earlier] != pick_up) {
+                return false;
+            }
+        }
+        for (const int later : after_[order_[p]]) {
+            if (position_[later] <= to && position_[later] != drop_off) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void CourierTour::move_pair(const int pick_up, const int drop_off, const int to) {
+    const int pick_up_visit = order_[pick_up];
+    const int drop_off_visit = order_[drop_off];
+    std::vector<int> order;
+    order.reserve(order_.size());
+    for (int p = 0; p < size(); ++p) {
+        if (p != pick_up && p != drop_off) {
+            order.push_back(order_[p]);
+        }
+        if (p == to) {
+            order.push_back(pick_up_visit);
+            order.push_back(drop_off_visit);
+        }
+    }
+    order_.swap(order);
+    refresh(std::min(pick_up, to + 1));
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "StreetsDatabaseAPI.h"
+#include "struct.h"
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class RouteMatrix;
+
+/*
+ * A delivery order that the courier local search changes in place
+ * The order is a sequence of visits between the two depot visits at its ends. An intersection
+ * that is both a pick-up and a drop-off can be visited twice, so the pick-up before drop-off rule
+ * is kept per visit: each delivery is tied to the first visit of its pick-up and the last visit of
+ * its drop-off in the starting order, and every visit knows the visits that must stay before it
+ * and after it. With the position of every visit at hand, checking a move only looks at the
+ * visits that move, or at those inside a reversed run.
+ *
+ * The cost of a move comes from the few legs it replaces, read from the RouteMatrix, instead of
+ * rescoring the order. Reversing a run also turns the legs inside it around, which prefix sums of
+ * the legs in both directions price in O(1). Applying a move only rotates, swaps or reverses the
+ * visits between its ends and refreshes the sums from there on.
+ *
+ * Positions run from 0 (the start depot) to size() - 1 (the end depot); moves only take
+ * positions in between.
+ *
+ * Besides the swap (exchange), relocate and 2-opt reversal, a run of visits can be moved elsewhere
+ * as it is or reversed (Or-opt for short runs, the segment insertion 3-opt for long ones), and a
+ * pick-up can be moved together with one of its drop-offs. Moving a run past another is only
+ * illegal if the two are tied, which is checked from whichever of them is shorter.
+ */
+class CourierTour {
+public:
+    CourierTour(const RouteMatrix& routes_matrix, const std::vector<IntersectionIdx>& path,
+                const std::unordered_map<IntersectionIdx, int>& intersection_to_index,
+                const std::unordered_map<IntersectionIdx, Delivery_details>& delivery_info);
+
+    int size() const { return static_cast<int>(order_.size()); }
+    double cost() const { return forward_.back(); }
+    std::vector<IntersectionIdx> path() const;
+
+    // Exchanges the visits at positions a and b
+    double swap_delta(int a, int b) const;
+    bool swap_feasible(int a, int b) const;
+    void swap(int a, int b);
+
+    // Takes the visit at position `from` out and puts it back so it ends up at position `to`
+    double relocate_delta(int from, int to) const;
+    bool relocate_feasible(int from, int to) const;
+    void relocate(int from, int to);
+
+    // Reverses the visits at positions first to last, both included (first < last)
+    double reverse_delta(int first, int last) const;
+    bool reverse_feasible(int first, int last) const;
+    void reverse(int first, int last);
+
+    // Moves the visits at positions first to last, reversed or not, in between the visits at
+    // positions to and to + 1 (to is outside first - 1 to last)
+    double move_run_delta(int first, int last, int to, bool reversed) const;
+    bool move_run_feasible(int first, int last, int to, bool reversed) const;
+    void move_run(int first, int last, int to, bool reversed);
+
+    // The pick-up and drop-off visits tied together, by the positions they are at
+    int pair_count() const { return static_cast<int>(pairs_.size()); }
+    std::pair<int, int> pair_positions(int pair) const;
+
+    // Takes the visits at positions pick_up and drop_off (pick_up < drop_off) out and puts them
+    // back next to each other, right after the visit at position `to` (neither of the two)
+    double move_pair_delta(int pick_up, int drop_off, int to) const;
+    bool move_pair_feasible(int pick_up, int drop_off, int to) const;
+    void move_pair(int pick_up, int drop_off, int to);
+
+private:
+    double leg(int from_visit, int to_visit) const;
+    // The leg from the visit at position p to the one at position q
+    double leg_at(int p, int q) const { return leg(order_[p], order_[q]); }
+    // Refreshes positions and prefix sums from position `first` on
+    void refresh(int first);
+    // Whether a visit at positions first to last must come before one at other_first to other_last
+    bool tied(int first, int last, int other_first, int other_last) const;
+    // The position after p once the visits at positions skip and also_skip are taken out
+    int next_without(int p, int skip, int also_skip) const;
+
+    const RouteMatrix& routes_matrix_;
+    // per visit: its matrix index and its position in order_
+    std::vector<int> key_;
+    std::vector<int> position_;
+    // visits by position
+    std::vector<int> order_;
+    // forward_[p]: the legs from position 0 to p in order; backward_[p]: the same legs turned around
+    std::vector<double> forward_;
+    std::vector<double> backward_;
+    // per visit: the visits that must come before it (pick-ups it drops off) and after it
+    std::vector<std::vector<int>> before_;
+    std::vector<std::vector<int>> after_;
+    // every (pick-up, drop-off) pair of visits in before_ and after_
+    std::vector<std::pair<int, int>> pairs_;
+};
@@ -20,36 +20,9 @@ public:
     // this hold the strings of all the map paths, and if they are already open or closed as a boolean
     std::unordered_map<std::string, bool> loadedMap;
 
-    // vector of vectors of street segment id organized by intersection id
-    std::vector<std::vector<StreetSegmentIdx>> intersection_street_segments;
-
-    // multimap of street names in alphabetical order (key: name, data: street ID)
-    std::multimap<std::string, StreetIdx> ordered_street_name;
-
     // this string holds the path of the current map file
     std::string current_map_open;
 
-    // vector of struct streetinfo, organized by street id
-    std::vector<StreetsInfo> vec_streetinfo;
-
-    // holds the total distance corresponding with each OSMWay
-    std::unordered_map <OSMID, double> way_distance;
-
-    // relates a given intersection, with a vector of all adjacent intersections
-    std::unordered_map<IntersectionIdx, std::vector<IntersectionIdx>> adjacent_intersections;
-
-    // used to find any OSMNode given an OSMID
-    std::unordered_map<OSMID, const OSMNode*> node_to_id;
-
-    // used to find any OSMWay given an OSMID
-    std::unordered_map<OSMID, const OSMWay*> id_to_way;
-
-    // used to find any OSMRelation given an OSMID
-    std::unordered_map<OSMID, const OSMRelation*> id_to_relation;
-
-    // vector of struct streetSegmentDistance, organized by street segment id
-    std::vector<StreetSegmentDistance> vec_segmentdis;
-
     // The following values are the maximum and minimum longitudes for the current map, as well as the average latitude
     double max_lat, min_lat, max_lon, min_lon, map_lat_avg;
 
@@ -74,16 +47,19 @@ public:
     // Vector of top 30 shops in the city
     std::vector<internet_poi> city_shops;
 
-    // Holds a struct of all street segments in the city
+    // Render data of every street segment in the city (routing data stays in the streets.bin mapping)
     std::vector<street_segment_info> all_street_segments;
 
+    // Street name label of every street segment in the city
+    std::vector<street_segment_label> street_segment_labels;
+
     std::vector<RoadType> ss_road_type;
 
     std::vector<bool> draw_which_poi;
 
     bool dark_mode = false;
 
-    // maximum speed of the region loaded
+    // maximum speed of the region loaded, precomputed by osm_converter
     float max_speed;
 
     std::unordered_map<IntersectionIdx ,Delivery_Stop> delivery_stops;
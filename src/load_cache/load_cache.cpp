@@ -0,0 +1,444 @@
+#include "load_cache.hpp"
+
+#include <exception>
+#include <iostream>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "converter/section_writer.hpp"
+#include "../globals.h"
+#include "../OSMEntity_Helpers/m2_way_helpers.hpp"
+#include "../OSMEntity_Helpers/typed_osmid_helper.hpp"
+#include "../POI/POI_helpers.hpp"
+#include "../POI/POI_setup.hpp"
+#include "../m3_algo/landmarks.hpp"
+
+namespace gisevo {
+namespace {
+
+using converter::SectionId;
+
+template <typename Offset>
+bool offsets_cover(std::span<const Offset> offsets, std::size_t count, std::size_t target_size) {
+    return offsets.size() == count + 1 && offsets.front() == 0 && offsets.back() == target_size;
+}
+
+// Strings of the cache, each distinct value stored once
+class StringTable {
+public:
+    StringTable() {
+        offsets_.push_back(0);
+        add("");
+    }
+
+    std::uint32_t add(const std::string& value) {
+        auto [iter, inserted] = lookup_.try_emplace(value, static_cast<std::uint32_t>(lookup_.size()));
+        if (inserted) {
+            data_.insert(data_.end(), value.begin(), value.end());
+            offsets_.push_back(data_.size());
+        }
+        return iter->second;
+    }
+
+    const std::vector<std::uint64_t>& offsets() const { return offsets_; }
+    const std::vector<char>& data() const { return data_; }
+
+private:
+    std::vector<std::uint64_t> offsets_;
+    std::vector<char> data_;
+    std::unordered_map<std::string, std::uint32_t> lookup_;
+};
+
+template <typename T, typename Offset>
+void append_run(std::vector<T>& values, std::vector<Offset>& offsets, const std::vector<T>& run) {
+    values.insert(values.end(), run.begin(), run.end());
+    offsets.push_back(static_cast<Offset>(values.size()));
+}
+
+}  // namespace
+
+LoadCacheKey load_cache_key(const map_data::StreetsStore& streets, const map_data::OsmStore& osm) {
+    LoadCacheKey key{};
+    key.streets_hash = streets.content_hash();
+    key.osm_hash = osm.content_hash();
+    key.code_version = kLoadCacheCodeVersion;
+    return key;
+}
+
+std::filesystem::path load_cache_path(const std::filesystem::path& streets_path) {
+    std::string name = streets_path.filename().string();
+    constexpr std::string_view kSuffix = ".streets.bin";
+    if (name.size() > kSuffix.size() && name.compare(name.size() - kSuffix.size(), kSuffix.size(), kSuffix) == 0) {
+        name.resize(name.size() - kSuffix.size());
+    }
+    return streets_path.parent_path() / (name + ".cache.bin");
+}
+
+bool LoadCache::open(const std::filesystem::path& path, const LoadCacheKey& key) {
+    close();
+    std::error_code error;
+    if (!std::filesystem::exists(path, error)) {
+        return false;
+    }
+    try {
+        file_.open(path, converter::kLoadCacheMagic, converter::kLoadCacheSchemaVersion);
+        const auto stored = file_.section<LoadCacheKey>(SectionId::kCacheKey);
+        if (stored.size() != 1 || stored[0].streets_hash != key.streets_hash || stored[0].osm_hash != key.osm_hash ||
+            stored[0].code_version != key.code_version) {
+            close();
+            return false;
+        }
+        map_sections();
+    } catch (const std::exception& ex) {
+        std::cerr << "[load_cache] Ignoring " << path.string() << ": " << ex.what() << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void LoadCache::close() {
+    file_.close();
+    *this = LoadCache();
+}
+
+void LoadCache::map_sections() {
+    string_offsets_ = file_.section<std::uint64_t>(SectionId::kCacheStringOffsets);
+    string_data_ = file_.section<char>(SectionId::kCacheStringData);
+
+    segments_ = file_.section<Segment>(SectionId::kCacheSegments);
+    segment_line_offsets_ = file_.section<std::uint32_t>(SectionId::kCacheSegmentLineOffsets);
+    segment_lines_ = file_.section<Line>(SectionId::kCacheSegmentLines);
+    segment_arrow_offsets_ = file_.section<std::uint32_t>(SectionId::kCacheSegmentArrowOffsets);
+    segment_arrows_ = file_.section<Line>(SectionId::kCacheSegmentArrows);
+    segment_zoom_offsets_ = file_.section<std::uint32_t>(SectionId::kCacheSegmentZoomOffsets);
+    segment_zoom_levels_ = file_.section<ZoomLevels>(SectionId::kCacheSegmentZoomLevels);
+    segment_text_offsets_ = file_.section<std::uint32_t>(SectionId::kCacheSegmentTextOffsets);
+    segment_texts_ = file_.section<Text>(SectionId::kCacheSegmentTexts);
+
+    ways_ = file_.section<Way>(SectionId::kCacheWays);
+    way_point_offsets_ = file_.section<std::uint64_t>(SectionId::kCacheWayPointOffsets);
+    way_points_ = file_.section<Point2D>(SectionId::kCacheWayPoints);
+
+    features_ = file_.section<Feature>(SectionId::kCacheFeatures);
+    feature_point_offsets_ = file_.section<std::uint64_t>(SectionId::kCacheFeaturePointOffsets);
+    feature_points_ = file_.section<Point2D>(SectionId::kCacheFeaturePoints);
+
+    pois_ = file_.section<Poi>(SectionId::kCachePois);
+
+    subway_lines_ = file_.section<SubwayLine>(SectionId::kCacheSubwayLines);
+    subway_way_offsets_ = file_.section<std::uint32_t>(SectionId::kCacheSubwayWayOffsets);
+    subway_point_offsets_ = file_.section<std::uint64_t>(SectionId::kCacheSubwayPointOffsets);
+    subway_points_ = file_.section<Point2D>(SectionId::kCacheSubwayPoints);
+
+    landmark_unit_ = file_.section<double>(SectionId::kCacheLandmarkUnit);
+    landmarks_ = file_.section<std::int32_t>(SectionId::kCacheLandmarks);
+    landmark_times_ = file_.section<std::uint16_t>(SectionId::kCacheLandmarkTimes);
+
+    // As for streets.bin only the shape of the tables is checked; the key already ties the
+    // contents to these exact map files
+    const bool shape_ok =
+        !string_offsets_.empty() && !subway_point_offsets_.empty() &&
+        offsets_cover(string_offsets_, string_offsets_.size() - 1, string_data_.size()) &&
+        segments_.size() == static_cast<std::size_t>(getNumStreetSegments()) &&
+        offsets_cover(segment_line_offsets_, segments_.size(), segment_lines_.size()) &&
+        offsets_cover(segment_arrow_offsets_, segments_.size(), segment_arrows_.size()) &&
+        offsets_cover(segment_zoom_offsets_, segments_.size(), segment_zoom_levels_.size()) &&
+        offsets_cover(segment_text_offsets_, segments_.size(), segment_texts_.size()) &&
+        offsets_cover(way_point_offsets_, ways_.size(), way_points_.size()) &&
+        offsets_cover(feature_point_offsets_, features_.size(), feature_points_.size()) &&
+        offsets_cover(subway_way_offsets_, subway_lines_.size(), subway_point_offsets_.size() - 1) &&
+        offsets_cover(subway_point_offsets_, subway_point_offsets_.size() - 1, subway_points_.size()) &&
+        landmark_unit_.size() == 1 && landmarks_.size() <= LandmarkTable::kMaxLandmarks &&
+        landmark_times_.size() == 2 * landmarks_.size() * static_cast<std::size_t>(getNumIntersections());
+    if (!shape_ok) {
+        throw std::runtime_error("the cache tables do not match the map");
+    }
+}
+
+std::string LoadCache::string(std::uint32_t index) const {
+    return std::string(string_data_.data() + string_offsets_[index],
+                       string_offsets_[index + 1] - string_offsets_[index]);
+}
+
+void LoadCache::restore_street_segments() const {
+    const std::size_t count = segments_.size();
+    globals.all_street_segments.assign(count, street_segment_info{});
+    globals.street_segment_labels.assign(count, street_segment_label{});
+    globals.ss_road_type.assign(count, RoadType::primary);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const Segment& cached = segments_[i];
+        street_segment_info& segment = globals.all_street_segments[i];
+        segment.num_curve_point = cached.num_curve_point;
+        segment.max_pos = cached.max_pos;
+        segment.min_pos = cached.min_pos;
+        segment.type = static_cast<RoadType>(cached.type);
+        segment.road_colour = cached.road_colour;
+        segment.dark_road_colour = cached.dark_road_colour;
+        segment.arrow_colour = cached.arrow_colour;
+        segment.x_avg = cached.x_avg;
+        segment.y_avg = cached.y_avg;
+        segment.arrow_width = cached.arrow_width;
+        segment.arrow_zoom_dep = cached.arrow_zoom_dep;
+        for (const Line& line : run(segment_lines_, segment_line_offsets_, i)) {
+            segment.lines_to_draw.emplace_back(line.from, line.to);
+        }
+        for (const Line& arrow : run(segment_arrows_, segment_arrow_offsets_, i)) {
+            segment.arrows_to_draw.emplace_back(arrow.from, arrow.to);
+        }
+        for (const ZoomLevels& levels : run(segment_zoom_levels_, segment_zoom_offsets_, i)) {
+            segment.zoom_levels.emplace_back(levels.first, levels.second);
+        }
+
+        street_segment_label& label = globals.street_segment_labels[i];
+        label.text_colour = cached.text_colour;
+        label.dark_text_colour = cached.dark_text_colour;
+        label.text_rotation = cached.text_rotation;
+        for (const Text& text : run(segment_texts_, segment_text_offsets_, i)) {
+            label.text_to_draw.push_back(text_prop{text.loc, string(text.label), text.length_x, text.length_y});
+        }
+
+        // compute_streets_info copies each segment's road type from ss_road_type
+        globals.ss_road_type[i] = segment.type;
+    }
+}
+
+void LoadCache::restore_ways() const {
+    m2_local_all_ways_info.clear();
+    m2_local_all_ways_info.reserve(ways_.size());
+    for (std::size_t i = 0; i < ways_.size(); ++i) {
+        const Way& cached = ways_[i];
+        way_info way;
+        way.is_closed = cached.is_closed != 0;
+        const auto points = run(way_points_, way_point_offsets_, i);
+        way.way_points2d.assign(points.begin(), points.end());
+        way.way_id = cached.way_id;
+        way.way_name = string(cached.way_name);
+        way.way_type = static_cast<FeatureType>(cached.way_type);
+        way.way_road_type = static_cast<RoadType>(cached.way_road_type);
+        way.way_use = static_cast<way_enums>(cached.way_use);
+        m2_local_all_ways_info.push_back(std::move(way));
+    }
+}
+
+void LoadCache::restore_features() const {
+    closed_features.clear();
+    open_features.clear();
+    for (std::size_t i = 0; i < features_.size(); ++i) {
+        const Feature& cached = features_[i];
+        feature_info feature;
+        const auto points = run(feature_points_, feature_point_offsets_, i);
+        feature.points.assign(points.begin(), points.end());
+        feature.type = static_cast<FeatureType>(cached.type);
+        feature.feature_name = string(cached.feature_name);
+        feature.id = TypedOSMID(static_cast<TypedOSMID::EntityType>(cached.id_type), cached.id);
+        feature.x_max = cached.x_max;
+        feature.x_min = cached.x_min;
+        feature.y_max = cached.y_max;
+        feature.y_min = cached.y_min;
+        feature.x_avg = cached.x_avg;
+        feature.y_avg = cached.y_avg;
+        feature.mycolour = cached.mycolour;
+        feature.dark_colour = cached.dark_colour;
+        feature.zoom_lod = cached.zoom_lod;
+        (cached.closed != 0 ? closed_features : open_features).push_back(std::move(feature));
+    }
+}
+
+void LoadCache::restore_pois() const {
+    POI_sorted& sorted = globals.poi_sorted;
+    sorted = POI_sorted();
+    init_poi_vec();
+    for (const Poi& cached : pois_) {
+        POI_info poi(ezgl::point2d(cached.poi_loc.x, cached.poi_loc.y),
+                     ezgl::point2d(cached.poi_text_loc.x, cached.poi_text_loc.y), string(cached.poi_name), cached.poi_idx,
+                     static_cast<POI_class>(cached.poi_class), static_cast<POI_category>(cached.poi_category));
+        poi.poi_customed_type = cached.poi_customed_type;
+        switch (cached.bucket) {
+            case PoiBucket::kBasic:
+                sorted.basic_poi.at(cached.bucket_index).push_back(std::move(poi));
+                break;
+            case PoiBucket::kEntertainment:
+                sorted.entertainment_poi.at(cached.bucket_index).push_back(std::move(poi));
+                break;
+            case PoiBucket::kSubordinate:
+                sorted.subordinate_poi.at(cached.bucket_index).push_back(std::move(poi));
+                break;
+            case PoiBucket::kNeglegible:
+                sorted.neglegible_poi.push_back(std::move(poi));
+                break;
+            case PoiBucket::kStations:
+                sorted.stations_poi.push_back(std::move(poi));
+                break;
+        }
+    }
+}
+
+void LoadCache::restore_subway_lines() const {
+    subway_lines.clear();
+    subway_lines.reserve(subway_lines_.size());
+    for (std::size_t i = 0; i < subway_lines_.size(); ++i) {
+        const SubwayLine& cached = subway_lines_[i];
+        subway_info line;
+        line.type = static_cast<TypedOSMID::EntityType>(cached.type);
+        line.name = string(cached.name);
+        line.colour = string(cached.colour);
+        line.draw_colour = cached.draw_colour;
+        for (std::uint32_t way = subway_way_offsets_[i]; way < subway_way_offsets_[i + 1]; ++way) {
+            const auto points = run(subway_points_, subway_point_offsets_, way);
+            line.subway_way.emplace_back(points.begin(), points.end());
+        }
+        subway_lines.push_back(std::move(line));
+    }
+}
+
+void LoadCache::restore_landmarks() const {
+    LandmarkTable& table = landmarkTable();
+    table.unit = landmark_unit_[0];
+    table.landmarks.assign(landmarks_.begin(), landmarks_.end());
+    table.times.assign(landmark_times_.begin(), landmark_times_.end());
+}
+
+bool LoadCache::write(const std::filesystem::path& path, const LoadCacheKey& key) {
+    StringTable strings;
+
+    std::vector<Segment> segments;
+    std::vector<std::uint32_t> line_offsets{0}, arrow_offsets{0}, zoom_offsets{0}, text_offsets{0};
+    std::vector<Line> lines, arrows;
+    std::vector<ZoomLevels> zoom_levels;
+    std::vector<Text> texts;
+    segments.reserve(globals.all_street_segments.size());
+    for (std::size_t i = 0; i < globals.all_street_segments.size(); ++i) {
+        const street_segment_info& segment = globals.all_street_segments[i];
+        const street_segment_label& label = globals.street_segment_labels[i];
+        segments.push_back(Segment{segment.road_colour, segment.dark_road_colour, segment.arrow_colour,
+                                   label.text_colour, label.dark_text_colour, segment.max_pos, segment.min_pos,
+                                   segment.x_avg, segment.y_avg, label.text_rotation, segment.num_curve_point,
+                                   static_cast<std::int32_t>(segment.type), segment.arrow_width,
+                                   segment.arrow_zoom_dep});
+        for (const auto& [from, to] : segment.lines_to_draw) {
+            lines.push_back(Line{from, to});
+        }
+        line_offsets.push_back(static_cast<std::uint32_t>(lines.size()));
+        for (const auto& [from, to] : segment.arrows_to_draw) {
+            arrows.push_back(Line{from, to});
+        }
+        arrow_offsets.push_back(static_cast<std::uint32_t>(arrows.size()));
+        for (const auto& [first, second] : segment.zoom_levels) {
+            zoom_levels.push_back(ZoomLevels{first, second});
+        }
+        zoom_offsets.push_back(static_cast<std::uint32_t>(zoom_levels.size()));
+        for (const text_prop& text : label.text_to_draw) {
+            texts.push_back(Text{text.loc, text.length_x, text.length_y, strings.add(text.label), 0});
+        }
+        text_offsets.push_back(static_cast<std::uint32_t>(texts.size()));
+    }
+
+    std::vector<Way> ways;
+    std::vector<std::uint64_t> way_point_offsets{0};
+    std::vector<Point2D> way_points;
+    for (const way_info& way : m2_local_all_ways_info) {
+        ways.push_back(Way{way.way_id, strings.add(way.way_name), static_cast<std::int32_t>(way.way_type),
+                           static_cast<std::int32_t>(way.way_road_type), static_cast<std::int32_t>(way.way_use),
+                           static_cast<std::uint8_t>(way.is_closed ? 1 : 0), {}});
+        append_run(way_points, way_point_offsets, way.way_points2d);
+    }
+
+    std::vector<Feature> features;
+    std::vector<std::uint64_t> feature_point_offsets{0};
+    std::vector<Point2D> feature_points;
+    for (const auto* list : {&closed_features, &open_features}) {
+        for (const feature_info& feature : *list) {
+            features.push_back(Feature{feature.mycolour, feature.dark_colour, feature.x_max, feature.x_min,
+                                       feature.y_max, feature.y_min, feature.x_avg, feature.y_avg, feature.id,
+                                       static_cast<std::int32_t>(feature.id.type()),
+                                       static_cast<std::int32_t>(feature.type), feature.zoom_lod,
+                                       strings.add(feature.feature_name),
+                                       static_cast<std::uint8_t>(list == &closed_features ? 1 : 0), {}});
+            append_run(feature_points, feature_point_offsets, feature.points);
+        }
+    }
+
+    std::vector<Poi> pois;
+    auto add_pois = [&](const std::vector<POI_info>& bucket, PoiBucket kind, std::size_t index) {
+        for (const POI_info& poi : bucket) {
+            pois.push_back(Poi{Point2D(poi.poi_loc.x, poi.poi_loc.y), Point2D(poi.poi_text_loc.x, poi.poi_text_loc.y),
+                               strings.add(poi.poi_name), poi.poi_idx,
+                               static_cast<std::int32_t>(poi.poi_class), poi.poi_customed_type,
+                               static_cast<std::int32_t>(poi.poi_category), static_cast<std::int32_t>(index),
+                               kind, {}});
+        }
+    };
+    const POI_sorted& sorted = globals.poi_sorted;
+    for (std::size_t i = 0; i < sorted.basic_poi.size(); ++i) {
+        add_pois(sorted.basic_poi[i], PoiBucket::kBasic, i);
+    }
+    for (std::size_t i = 0; i < sorted.entertainment_poi.size(); ++i) {
+        add_pois(sorted.entertainment_poi[i], PoiBucket::kEntertainment, i);
+    }
+    for (std::size_t i = 0; i < sorted.subordinate_poi.size(); ++i) {
+        add_pois(sorted.subordinate_poi[i], PoiBucket::kSubordinate, i);
+    }
+    add_pois(sorted.neglegible_poi, PoiBucket::kNeglegible, 0);
+    add_pois(sorted.stations_poi, PoiBucket::kStations, 0);
+
+    std::vector<SubwayLine> lines_out;
+    std::vector<std::uint32_t> subway_way_offsets{0};
+    std::vector<std::uint64_t> subway_point_offsets{0};
+    std::vector<Point2D> subway_points;
+    for (const subway_info& line : subway_lines) {
+        lines_out.push_back(SubwayLine{line.draw_colour, strings.add(line.name), strings.add(line.colour),
+                                       static_cast<std::int32_t>(line.type), 0});
+        for (const auto& way : line.subway_way) {
+            append_run(subway_points, subway_point_offsets, way);
+        }
+        subway_way_offsets.push_back(static_cast<std::uint32_t>(subway_point_offsets.size() - 1));
+    }
+
+    converter::SectionWriter writer;
+    writer.add(SectionId::kCacheKey, std::span<const LoadCacheKey>(&key, 1));
+    writer.add(SectionId::kCacheStringOffsets, strings.offsets());
+    writer.add(SectionId::kCacheStringData, strings.data());
+    writer.add(SectionId::kCacheSegments, segments);
+    writer.add(SectionId::kCacheSegmentLineOffsets, line_offsets);
+    writer.add(SectionId::kCacheSegmentLines, lines);
+    writer.add(SectionId::kCacheSegmentArrowOffsets, arrow_offsets);
+    writer.add(SectionId::kCacheSegmentArrows, arrows);
+    writer.add(SectionId::kCacheSegmentZoomOffsets, zoom_offsets);
+    writer.add(SectionId::kCacheSegmentZoomLevels, zoom_levels);
+    writer.add(SectionId::kCacheSegmentTextOffsets, text_offsets);
+    writer.add(SectionId::kCacheSegmentTexts, texts);
+    writer.add(SectionId::kCacheWays, ways);
+    writer.add(SectionId::kCacheWayPointOffsets, way_point_offsets);
+    writer.add(SectionId::kCacheWayPoints, way_points);
+    writer.add(SectionId::kCacheFeatures, features);
+    writer.add(SectionId::kCacheFeaturePointOffsets, feature_point_offsets);
+    writer.add(SectionId::kCacheFeaturePoints, feature_points);
+    writer.add(SectionId::kCachePois, pois);
+    writer.add(SectionId::kCacheSubwayLines, lines_out);
+    writer.add(SectionId::kCacheSubwayWayOffsets, subway_way_offsets);
+    writer.add(SectionId::kCacheSubwayPointOffsets, subway_point_offsets);
+    writer.add(SectionId::kCacheSubwayPoints, subway_points);
+    const LandmarkTable& landmarks = landmarkTable();
+    writer.add(SectionId::kCacheLandmarkUnit, std::span<const double>(&landmarks.unit, 1));
+    writer.add(SectionId::kCacheLandmarks, landmarks.landmarks);
+    writer.add(SectionId::kCacheLandmarkTimes, landmarks.times);
+
+    // Written aside and renamed so another process never maps a half written cache
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+    try {
+        writer.write(temporary, converter::kLoadCacheMagic, converter::kLoadCacheSchemaVersion);
+        std::filesystem::rename(temporary, path);
+    } catch (const std::exception& ex) {
+        std::cerr << "[load_cache] Failed to write " << path.string() << ": " << ex.what() << std::endl;
+        std::error_code error;
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+}  // namespace gisevo
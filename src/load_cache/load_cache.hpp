@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+
+#include "../gtk4_types.hpp"
+#include "../map_data/map_store.hpp"
+#include "../map_data/section_file.hpp"
+
+namespace gisevo {
+
+// Bump whenever a step whose output is cached (compute_streets_info, assign_type_to_way,
+// create_vector_of_ways, sort_features, sortPOI, initSubwayStations, sortSubwayLines,
+// computeLandmarks) changes what it produces, so caches written by older code are rebuilt
+// instead of read
+inline constexpr std::uint32_t kLoadCacheCodeVersion = 2;
+
+// Identifies the exact map files and code a cache was written for
+struct LoadCacheKey {
+    std::uint64_t streets_hash;
+    std::uint64_t osm_hash;
+    std::uint32_t code_version;
+    std::uint8_t reserved[44];
+};
+static_assert(sizeof(LoadCacheKey) == 64);
+
+// Takes the content hashes the converter recorded in the headers of the open map files, so
+// nothing but the headers is read; a closed (missing) osm.bin hashes as 0
+LoadCacheKey load_cache_key(const map_data::StreetsStore& streets, const map_data::OsmStore& osm);
+
+// "<map>.streets.bin" -> "<map>.cache.bin", next to the map
+std::filesystem::path load_cache_path(const std::filesystem::path& streets_path);
+
+/*
+ * Cache of the data loadMap derives from a map
+ * The street segment render data, way and feature polylines, POI buckets, subway lines and
+ * routing landmarks are written after a cold load as flat, offset-indexed sections (no
+ * pointers, so the file can be mapped anywhere). A warm load maps the file and copies the
+ * sections into the globals, which skips every derivation step; each restore_*() fills a
+ * separate group of globals so they can run in parallel.
+ */
+class LoadCache {
+public:
+    // Maps the cache if it was written for key; false (with nothing mapped) if the file is
+    // missing, stale or damaged
+    bool open(const std::filesystem::path& path, const LoadCacheKey& key);
+    void close();
+
+    void restore_street_segments() const;  // globals.all_street_segments, street_segment_labels, ss_road_type
+    void restore_ways() const;             // m2_local_all_ways_info
+    void restore_features() const;         // closed_features, open_features
+    void restore_pois() const;             // globals.poi_sorted
+    void restore_subway_lines() const;     // subway_lines
+    void restore_landmarks() const;        // landmarkTable()
+
+    // Writes the globals listed above; returns false, after logging why, if the file cannot be
+    // written (e.g. the map directory is read only)
+    static bool write(const std::filesystem::path& path, const LoadCacheKey& key);
+
+private:
+    // Flat records of the cache sections; enums are stored as int32 and strings as indices into
+    // the string table. Padding is spelled out so the files are byte for byte reproducible.
+    struct Segment {
+        GdkRGBA road_colour;
+        GdkRGBA dark_road_colour;
+        GdkRGBA arrow_colour;
+        GdkRGBA text_colour;
+        GdkRGBA dark_text_colour;
+        Point2D max_pos;
+        Point2D min_pos;
+        double x_avg;
+        double y_avg;
+        double text_rotation;
+        std::int32_t num_curve_point;
+        std::int32_t type;
+        std::int32_t arrow_width;
+        std::int32_t arrow_zoom_dep;
+    };
+    struct Line {
+        Point2D from;
+        Point2D to;
+    };
+    struct ZoomLevels {
+        std::int32_t first;
+        std::int32_t second;
+    };
+    struct Text {
+        Point2D loc;
+        double length_x;
+        double length_y;
+        std::uint32_t label;
+        std::uint32_t reserved;
+    };
+    struct Way {
+        std::int64_t way_id;
+        std::uint32_t way_name;
+        std::int32_t way_type;
+        std::int32_t way_road_type;
+        std::int32_t way_use;
+        std::uint8_t is_closed;
+        std::uint8_t reserved[7];
+    };
+    struct Feature {
+        GdkRGBA mycolour;
+        GdkRGBA dark_colour;
+        double x_max, x_min, y_max, y_min, x_avg, y_avg;
+        std::int64_t id;
+        std::int32_t id_type;
+        std::int32_t type;
+        std::int32_t zoom_lod;
+        std::uint32_t feature_name;
+        std::uint8_t closed;  // closed_features, otherwise open_features
+        std::uint8_t reserved[7];
+    };
+    enum class PoiBucket : std::uint8_t { kBasic, kEntertainment, kSubordinate, kNeglegible, kStations };
+    struct Poi {
+        Point2D poi_loc;
+        Point2D poi_text_loc;
+        std::uint32_t poi_name;
+        std::int32_t poi_idx;
+        std::int32_t poi_class;
+        std::int32_t poi_customed_type;
+        std::int32_t poi_category;
+        std::int32_t bucket_index;  // within basic_poi, entertainment_poi or subordinate_poi
+        PoiBucket bucket;
+        std::uint8_t reserved[7];
+    };
+    struct SubwayLine {
+        GdkRGBA draw_colour;
+        std::uint32_t name;
+        std::uint32_t colour;
+        std::int32_t type;
+        std::uint32_t reserved;
+    };
+
+    template <typename T, typename Offset>
+    static std::span<const T> run(std::span<const T> values, std::span<const Offset> offsets, std::size_t i) {
+        return values.subspan(offsets[i], offsets[i + 1] - offsets[i]);
+    }
+    std::string string(std::uint32_t index) const;
+    void map_sections();
+
+    map_data::SectionFile file_;
+    std::span<const std::uint64_t> string_offsets_;
+    std::span<const char> string_data_;
+
+    std::span<const Segment> segments_;
+    std::span<const std::uint32_t> segment_line_offsets_;
+    std::span<const Line> segment_lines_;
+    std::span<const std::uint32_t> segment_arrow_offsets_;
+    std::span<const Line> segment_arrows_;
+    std::span<const std::uint32_t> segment_zoom_offsets_;
+    std::span<const ZoomLevels> segment_zoom_levels_;
+    std::span<const std::uint32_t> segment_text_offsets_;
+    std::span<const Text> segment_texts_;
+
+    std::span<const Way> ways_;
+    std::span<const std::uint64_t> way_point_offsets_;
+    std::span<const Point2D> way_points_;
+
+    std::span<const Feature> features_;
+    std::span<const std::uint64_t> feature_point_offsets_;
+    std::span<const Point2D> feature_points_;
+
+    std::span<const Poi> pois_;
+
+    std::span<const SubwayLine> subway_lines_;
+    std::span<const std::uint32_t> subway_way_offsets_;
+    std::span<const std::uint64_t> subway_point_offsets_;
+    std::span<const Point2D> subway_points_;
+
+    std::span<const double> landmark_unit_;
+    std::span<const std::int32_t> landmarks_;
+    std::span<const std::uint16_t> landmark_times_;
+};
+
+}  // namespace gisevo
@@ -25,7 +25,7 @@
 #include <unordered_map>
 #include <string>
 #include <algorithm>
-#include <thread>
+#include <filesystem>
 #include "m1.h"
 #include "Coordinates_Converstions/coords_conversions.hpp"
 #include "StreetsDatabaseAPI.h"
@@ -39,9 +39,14 @@
 #include "intersection_setup.hpp"
 #include "streetsegment_info.hpp"
 #include "Intersections/intersection_setup.hpp"
-#include <chrono>
+#include "map_data/map_store.hpp"
+#include "task_graph/task_graph.hpp"
+#include "load_cache/load_cache.hpp"
+#include "m3_algo/landmarks.hpp"
 
 //#define NOT_TESTING
+// prints how long each loadMap preprocessing step took
+//#define LOAD_TIMINGS
 
 // global variables contained within this class/object
 Global_Var globals;
@@ -75,87 +80,87 @@ bool loadMap(std::string map_streets_database_filename) {
         // if the map was already loaded, no point to reload all data
         return true;
     }
-    globals.map_lat_avg = find_map_bounds();
-
-    globals.map_lat_avg = find_map_bounds();
-
-
-    //writes to intersection_street_segments, adjacent_intersections
-    std::thread t2(&preLoadIntersectionStreetSegment);
-
-    // writes to node_to_id
-    std::thread t3(&mapOSMIDToNode);
-
-    // writes to id_to_way
-    std::thread t4(&mapOSMIDToWay);
-
-    // writes to id_to_relation
-    std::thread t5(&mapOSMIDToRelation);
-
-    // writes to ordered_street_name, vec_streetinfo, initilizes street_length
-    std::thread t6(&loopAllStreets);
-
-    // writes to poi_sorted
-    std::thread t9(&sortPOI);
-
-    // writes to vecPng
-    std::thread t10(&load_image_files);
-    //preLoadAjacentIntersections();
-
-    t3.join();
-    // reads from node_to_id, writes to way_distance
-    //std::thread t7(&preLoadWayDistance);
-    t6.join();
-
-    // writes to vec_streetinfo
-    std::thread t8(&loopAllStreetSegments);
-
-    std::thread t11(&fill_intersection_info);
-
-    std::thread t7(&sort_features);
-
-    m2_local_id_to_feature = map_features_to_ways(m2_local_all_features_info);
-    assign_type_to_way();
-    auto start = std::chrono::high_resolution_clock::now();
-    t2.join();
-    t4.join();
-    t5.join();
-    m2_local_all_ways_info = create_vector_of_ways(m2_local_id_to_feature);
-    t8.join();
-    compute_streets_info();
-    t9.join();
-    t10.join();
-    t11.join();
-    t7.join();
-    auto end = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end-start);
-
-
-    //fill_intersection_info();
-    sort_features();
-    loadMapNames();
-    std::string city;
-    std::string country;
-    bool found = false;
-    int j = 0;
-    while (!found && j < globals.map_path_to_name.size()) {
-        if (globals.map_path_to_name[j].first == map_streets_database_filename) {
-            city = globals.map_path_to_name[j].second.city_name;
-            country = globals.map_path_to_name[j].second.country_name;
-            found = true;
-        }
-        ++j;
-    }
+
+    // the intersection graph, segment lengths/travel times and per-street lists are
+    // precomputed by osm_converter and read straight from the streets.bin mapping
+    globals.max_speed = gisevo::map_data::streets_store().summary().max_speed;
+
+    // Most of the preprocessing below depends on nothing but the map files, so after the first
+    // load its output is read back from a cache next to the map, unless the files or the code
+    // deriving it changed
+    const std::filesystem::path cache_path = gisevo::load_cache_path(map_streets_database_filename);
+    const gisevo::LoadCacheKey cache_key =
+        gisevo::load_cache_key(gisevo::map_data::streets_store(), gisevo::map_data::osm_store());
+    gisevo::LoadCache cache;
+    const bool cached = cache.open(cache_path, cache_key);
+
+    // The remaining preprocessing steps, with the data each one reads and writes; the graph
+    // runs independent steps in parallel and keeps the rest in the order they are listed here
+    gisevo::TaskGraph load_steps;
+    load_steps.add("find_map_bounds", [] { globals.map_lat_avg = find_map_bounds(); },
+                   {}, {"map_bounds"});
+    load_steps.add("load_image_files", &load_image_files, {}, {"vec_png"});
+    load_steps.add("fill_intersection_info", &fill_intersection_info, {"map_bounds"}, {"all_intersections"});
+    load_steps.add("map_features_to_ways",
+                   [] { m2_local_id_to_feature = map_features_to_ways(m2_local_all_features_info); },
+                   {"features_info"}, {"id_to_feature"});
+    load_steps.add("loadMapNames", &loadMapNames, {}, {"map_names"});
     // turned off for testing due to an api request rate limit, uncommenting the code will re-enable the api automatically
 #ifdef NOT_TESTING
-    get_foursquare_data("restaurants", city, country);
-    parse_foursquare_data("restaurants", city, country);
-    get_foursquare_data("shops", city, country);
-    parse_foursquare_data("shops", city, country);
+    load_steps.add("foursquare", [map_streets_database_filename] {
+        std::string city;
+        std::string country;
+        bool found = false;
+        int j = 0;
+        while (!found && j < globals.map_path_to_name.size()) {
+            if (globals.map_path_to_name[j].first == map_streets_database_filename) {
+                city = globals.map_path_to_name[j].second.city_name;
+                country = globals.map_path_to_name[j].second.country_name;
+                found = true;
+            }
+            ++j;
+        }
+        get_foursquare_data("restaurants", city, country);
+        parse_foursquare_data("restaurants", city, country);
+        get_foursquare_data("shops", city, country);
+        parse_foursquare_data("shops", city, country);
+    }, {"map_names"}, {"city_pois"});
 #endif
-    initSubwayStations();
-    sortSubwayLines();
-    //std::cout << duration.count() << std::endl;
+    if (cached) {
+        load_steps.add("cached street segments", [&cache] { cache.restore_street_segments(); },
+                       {}, {"ss_road_type", "street_segments"});
+        load_steps.add("cached ways", [&cache] { cache.restore_ways(); }, {}, {"ways_info"});
+        load_steps.add("cached features", [&cache] { cache.restore_features(); }, {}, {"features"});
+        load_steps.add("cached POIs", [&cache] { cache.restore_pois(); }, {}, {"poi_sorted"});
+        load_steps.add("cached subway lines", [&cache] { cache.restore_subway_lines(); }, {}, {"subway_lines"});
+        load_steps.add("cached landmarks", [&cache] { cache.restore_landmarks(); }, {}, {"landmarks"});
+    }
+    else {
+        load_steps.add("sortPOI", &sortPOI, {"map_bounds"}, {"poi_sorted"});
+        load_steps.add("sort_features", &sort_features, {"map_bounds"}, {"features"});
+        load_steps.add("assign_type_to_way", &assign_type_to_way, {}, {"ss_road_type"});
+        load_steps.add("create_vector_of_ways",
+                       [] { m2_local_all_ways_info = create_vector_of_ways(m2_local_id_to_feature); },
+                       {"map_bounds", "id_to_feature"}, {"ways_info"});
+        load_steps.add("compute_streets_info", &compute_streets_info,
+                       {"map_bounds", "ss_road_type"}, {"street_segments"});
+        load_steps.add("initSubwayStations", &initSubwayStations, {"map_bounds"}, {"poi_sorted"});
+        load_steps.add("sortSubwayLines", &sortSubwayLines, {"map_bounds"}, {"subway_lines"});
+        load_steps.add("computeLandmarks", &computeLandmarks, {}, {"landmarks"});
+        load_steps.add("write load cache", [cache_path, cache_key] { gisevo::LoadCache::write(cache_path, cache_key); },
+                       {"street_segments", "ss_road_type", "ways_info", "features", "poi_sorted", "subway_lines",
+                        "landmarks"}, {});
+    }
+    try {
+        load_steps.run();
+    } catch (const std::exception& ex) {
+        std::cerr << "[loadMap] Preprocessing failed: " << ex.what() << std::endl;
+        return false;
+    }
+#ifdef LOAD_TIMINGS
+    load_steps.print_report(std::cout);
+#endif
+
     for(int i = 0; i <= NUM_POI_basics; i++){
         bool state = true;
         globals.draw_which_poi.push_back(state);
@@ -170,18 +175,10 @@ void closeMap() {
     if (isMapOpen != globals.loadedMap.end() && isMapOpen->second) { // map in DB, and it's open
         globals.loadedMap.insert_or_assign(globals.current_map_open, false); // set the map to false so it's closed now
     }
-    globals.way_distance.clear();
-    globals.node_to_id.clear();
-    globals.ordered_street_name.clear();
-    globals.intersection_street_segments.clear();
     closeOSMDatabase();
     closeStreetDatabase();
-    globals.vec_streetinfo.clear();
-    globals.vec_segmentdis.clear();
-    globals.adjacent_intersections.clear();
+    landmarkTable() = LandmarkTable();
     globals.all_intersections.clear();
-    globals.id_to_way.clear();
-    globals.id_to_relation.clear();
     globals.poi_sorted.basic_poi.clear();
     globals.poi_sorted.entertainment_poi.clear();
     globals.poi_sorted.subordinate_poi.clear();
@@ -205,6 +202,7 @@ void closeMap() {
     globals.city_shops.clear();
     globals.ss_road_type.clear();
     globals.all_street_segments.clear();
+    globals.street_segment_labels.clear();
 
     subway_lines.clear();
     highlighted_intersections.clear();
@@ -246,7 +244,7 @@ double findStreetSegmentLength(StreetSegmentIdx street_segment_id) {
     if (street_segment_id >= getNumStreetSegments()){
         return 0;
     }
-    double length = globals.vec_segmentdis[street_segment_id].segment_length;
+    double length = gisevo::map_data::streets_store().segment_length(street_segment_id);
     return length;
 }
 
@@ -257,7 +255,7 @@ double findStreetSegmentTravelTime(StreetSegmentIdx street_segment_id) {
     if (street_segment_id >= getNumStreetSegments()){
         return 0;
     }
-    double travel_time = globals.vec_segmentdis[street_segment_id].travel_time;
+    double travel_time = gisevo::map_data::streets_store().segment_travel_time(street_segment_id);
     return travel_time;
 }
 
@@ -375,7 +373,7 @@ bool intersectionsAreDirectlyConnected(std::pair<IntersectionIdx, IntersectionId
     }
 
     // retrieve the adjacent intersections of the first given intersection
-    std::vector<IntersectionIdx> intersections = globals.adjacent_intersections[intersection_ids.first];
+    auto intersections = gisevo::map_data::streets_store().intersection_adjacent(intersection_ids.first);
 
     // return true if an adjacent intersection is the second given intersection
     for (auto intersection : intersections){
@@ -413,7 +411,8 @@ std::vector<StreetSegmentIdx> findStreetSegmentsOfIntersection(IntersectionIdx i
         std::vector<StreetSegmentIdx> empty;
         return empty;
     }
-    return globals.intersection_street_segments[intersection_id];
+    auto segments = gisevo::map_data::streets_store().intersection_segments(intersection_id);
+    return std::vector<StreetSegmentIdx>(segments.begin(), segments.end());
 }
 
 // Returns all intersections along the given street
@@ -423,16 +422,17 @@ std::vector<IntersectionIdx> findIntersectionsOfStreet(StreetIdx street_id) {
         std::vector<IntersectionIdx> empty;
         return empty;
     }
-    return globals.vec_streetinfo[street_id].intersections;
+    auto intersections = gisevo::map_data::streets_store().street_intersections(street_id);
+    return std::vector<IntersectionIdx>(intersections.begin(), intersections.end());
 }
 
 // Return all IntersectionIdx at which the two given streets intersect
 // could have more than one IntersectionIdx for curved streets
 std::vector<IntersectionIdx> findIntersectionsOfTwoStreets(std::pair<StreetIdx, StreetIdx> street_ids) {
 
-    // find the intersections on the two given streets
-    std::vector<IntersectionIdx> intersections1 = globals.vec_streetinfo[street_ids.first].intersections;
-    std::vector<IntersectionIdx> intersections2 = globals.vec_streetinfo[street_ids.second].intersections;
+    // find the intersections on the two given streets (both lists are sorted)
+    auto intersections1 = gisevo::map_data::streets_store().street_intersections(street_ids.first);
+    auto intersections2 = gisevo::map_data::streets_store().street_intersections(street_ids.second);
     std::vector<IntersectionIdx> common_intersections;
 
     // find the intersections common to both streets
@@ -446,24 +446,16 @@ std::vector<StreetIdx> findStreetIdsFromPartialStreetName(std::string street_pre
     // remove the spaces in the given prefix and convert prefix to all lower case
     street_prefix.erase(std::remove(street_prefix.begin(), street_prefix.end(), ' '),street_prefix.end());
     lowerCase(street_prefix);
-    int num_char = street_prefix.length();
-    // find potential streets by range
-    auto lower_bound = globals.ordered_street_name.lower_bound(street_prefix);
-    std::string upper_bound_prefix = street_prefix;
-    // increment last chacter to form upper bound
-    upper_bound_prefix.back()++;
-    auto upper_bound = globals.ordered_street_name.lower_bound(upper_bound_prefix);
-    
-    // if not found
-    if(lower_bound == globals.ordered_street_name.end()){
-        return found_streets;
-    }
-    // if found
-    for (auto it = lower_bound; it != upper_bound; it++){
-        std::string street_name = it->first;
-        street_name .resize(num_char);
-        if (street_name == street_prefix)
-        found_streets.push_back(it->second);
+    // street ids are stored ordered by the same lower case, space free key, so every
+    // match lies in one contiguous run starting at the prefix
+    const auto& store = gisevo::map_data::streets_store();
+    auto by_key = store.streets_by_key();
+    auto it = std::lower_bound(by_key.begin(), by_key.end(), street_prefix,
+                               [&store](StreetIdx street, const std::string& prefix) {
+                                   return store.street_key(street) < prefix;
+                               });
+    for (; it != by_key.end() && store.street_key(*it).starts_with(street_prefix); ++it) {
+        found_streets.push_back(*it);
     }
 
     return found_streets;
@@ -476,7 +468,7 @@ double findStreetLength(StreetIdx street_id) {
         return 0.0;
     }
     
-    double length = globals.vec_streetinfo[street_id].street_length;
+    double length = gisevo::map_data::streets_store().street_length(street_id);
     return length;
 }
 
@@ -508,16 +500,17 @@ double findFeatureArea(FeatureIdx feature_id) {
 
 // Returns the length of the OSMWay that has the given OSMID, in meters.
 double findWayLength(OSMID way_id) {
-    // access the data structure that has the distances of all nodes -> globals.way_distance -> unordered_map
-    auto search = globals.way_distance.find(way_id);
+    // way lengths are precomputed by osm_converter; the way is found by a search over the sorted way ids
+    const auto& store = gisevo::map_data::streets_store();
+    const std::size_t way = store.find_way(way_id);
 
     // check if the given way_id exists, return 0 if it doesn't
-    if (search == globals.way_distance.end()) {
+    if (way == gisevo::map_data::StreetsStore::kNotFound) {
         std::cout << "Not found" << std::endl;
         return (0.0);
     }
     else {
-        return (search->second);
+        return (store.way_length(way));
     }
 }
 
@@ -526,15 +519,14 @@ std::string getOSMNodeTagValue(OSMID osm_id, std::string key) {
     std::string node_string;
     const OSMNode* specified_node;
 
-    // use the unordered_map find -> O(1)
-    auto find_id = globals.node_to_id.find(osm_id);
+    // binary search over the sorted node ids -> O(log n)
+    specified_node = findNodeByOSMID(osm_id);
 
-    // if find_id is at the end of the map, return the empty string
-    if (find_id == globals.node_to_id.end()) {
+    // if there is no such node, return the empty string
+    if (specified_node == nullptr) {
         return node_string;
     }
     else {
-        specified_node = find_id->second;
 
         // go through all tag pairs for the given node, and see which one has the correct key, then get the pair
         for (int tag_index = 0; tag_index < getTagCount(specified_node); ++tag_index) {
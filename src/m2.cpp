@@ -177,7 +177,7 @@ std::vector<std::pair<IntersectionIdx, std::string>> getSearchedIntersections(Gt
     // if second street name is not typed in
     if (street_string_2.size() == 0){
         for (int i = 0; i < streets_vec_1.size(); i++){
-            std::vector<IntersectionIdx> more_intersections = globals.vec_streetinfo[streets_vec_1[i]].intersections;
+            std::vector<IntersectionIdx> more_intersections = findIntersectionsOfStreet(streets_vec_1[i]);
 
             for (int j = 0; j < more_intersections.size(); j++){
                 std::string sug_intersection_name = getIntersectionName(more_intersections[j]);
@@ -464,22 +464,23 @@ void outputRoad(GtkApplication* application) {
     GtkWidget* travel_label = gtk_label_new(travel_char);
     gtk_box_pack_start(GTK_BOX(box),travel_label,TRUE, TRUE, 0);;
 
-    std::string start = globals.all_street_segments[highlighted_route[0]].inter_from;
-    start = "Starting at: "+start +"on "+globals.all_street_segments[highlighted_route[0]].street_name;
+    StreetSegmentInfo first_segment = getStreetSegmentInfo(highlighted_route[0]);
+    std::string start = getIntersectionName(first_segment.from);
+    start = "Starting at: "+start +"on "+getStreetName(first_segment.streetID);
     const gchar *start_name = start.c_str();
     GtkWidget *start_segment = gtk_label_new(start_name);
     gtk_box_pack_start(GTK_BOX(box),start_segment,TRUE, TRUE, 0);
 
     // display the directions via text
     std::vector<std::string> directions = findDirections(highlighted_route);
-    StreetIdx current_strt = globals.all_street_segments[highlighted_route[0]].street;
+    StreetIdx current_strt = first_segment.streetID;
     for (int i = 1; i <highlighted_route.size(); i++) {
         StreetSegmentIdx segment = highlighted_route[i];
-        std::string street = globals.all_street_segments[segment].street_name;
-        StreetIdx streetIdx =  globals.all_street_segments[segment].street;
+        StreetSegmentInfo segment_info = getStreetSegmentInfo(segment);
+        StreetIdx streetIdx = segment_info.streetID;
         if (streetIdx != current_strt) {
             current_strt =streetIdx;
-            street = directions[i-1] + globals.all_street_segments[segment].inter_to + " || towards: " + street;
+            std::string street = directions[i-1] + getIntersectionName(segment_info.to) + " || towards: " + getStreetName(streetIdx);
             const gchar *street_name = street.c_str();
             GtkWidget *strt_segment = gtk_label_new(street_name);
             gtk_box_pack_start(GTK_BOX(box),strt_segment,FALSE, FALSE, 0);
@@ -1106,7 +1107,9 @@ void drawStreets(cairo_t* cr) {
 
     bool draw = true;
 
-    for (auto i: globals.all_street_segments) {
+    for (std::size_t segment = 0; segment < globals.all_street_segments.size(); ++segment) {
+        const street_segment_info& i = globals.all_street_segments[segment];
+        const street_segment_label& label = globals.street_segment_labels[segment];
         int line_width = -1;
         // check the LOD for the current street segment
         for (uint j = 0; j < i.zoom_levels.size(); ++j) {
@@ -1146,16 +1149,16 @@ void drawStreets(cairo_t* cr) {
             }
 
             // drawing texts
-            g->set_text_rotation(i.text_rotation);
+            g->set_text_rotation(label.text_rotation);
             g->format_font("", ezgl::font_slant::normal, ezgl::font_weight::bold, 12);
             if (!globals.dark_mode){
-                g->set_color(i.text_colour);
+                g->set_color(label.text_colour);
             }
             else{
-                g->set_color(i.dark_text_colour);
+                g->set_color(label.dark_text_colour);
             }
-            for (uint j = 0; j < i.text_to_draw.size(); ++j) {
-                g->draw_text(i.text_to_draw[j].loc, i.text_to_draw[j].label, i.text_to_draw[j].length_x, i.text_to_draw[j].length_y);
+            for (uint j = 0; j < label.text_to_draw.size(); ++j) {
+                g->draw_text(label.text_to_draw[j].loc, label.text_to_draw[j].label, label.text_to_draw[j].length_x, label.text_to_draw[j].length_y);
             }
         }
     }
@@ -5,6 +5,12 @@
 #include "m1.h"
 #include "globals.h"
 #include "astaralgo.hpp"
+#include "m3_algo/batch_routing.hpp"
+#include "m3_algo/ch_query.hpp"
+#include "m3_algo/departure_time.hpp"
+#include "m3_algo/edge_search.hpp"
+#include "m3_algo/landmarks.hpp"
+#include "map_data/map_store.hpp"
 #include <chrono>
 #include <iostream>
 
@@ -23,18 +29,39 @@ double computePathTravelTime(const double turn_penalty, const std::vector<Street
     if(path.empty()) {
         return INFINITY;
     }
-    StreetIdx current_strt = globals.all_street_segments[path[0]].street;
+    const auto& store = gisevo::map_data::streets_store();
+    StreetIdx current_strt = store.segment_street(path[0]);
     for(int segment : path) {
-        total_time += findStreetSegmentTravelTime(segment);
-        if(globals.all_street_segments[segment].street !=current_strt ) {
+        total_time += store.segment_travel_time(segment);
+        if(store.segment_street(segment) !=current_strt ) {
             total_time += turn_penalty;
             //also update current street name since changed to a new street
-            current_strt = globals.all_street_segments[segment].street;
+            current_strt = store.segment_street(segment);
         }
     }
     return total_time;
 }
 
+double computePathTravelTime(const double turn_penalty, const std::vector<StreetSegmentIdx>& path,
+                             const double departure_time) {
+    const auto& profiles = gisevo::map_data::speed_profiles();
+    if (!profiles.is_open() || path.empty()) {
+        return computePathTravelTime(turn_penalty, path);
+    }
+    const auto& store = gisevo::map_data::streets_store();
+    double total_time = 0;
+    StreetIdx current_strt = store.segment_street(path[0]);
+    for (int segment : path) {
+        // the turn is made before entering the segment, so it delays the entry time
+        if (store.segment_street(segment) != current_strt) {
+            total_time += turn_penalty;
+            current_strt = store.segment_street(segment);
+        }
+        total_time += profiles.travel_time(segment, store.segment_travel_time(segment), departure_time + total_time);
+    }
+    return total_time;
+}
+
 // Returns a path (route) between the start intersection (intersect_id.first)
 // and the destination intersection (intersect_id.second), if one exists.
 // This routine should return the shortest path
@@ -46,7 +73,37 @@ double computePathTravelTime(const double turn_penalty, const std::vector<Street
 // order, would take one from the start to the destination intersection.
 std::vector<StreetSegmentIdx> findPathBetweenIntersections(const double turn_penalty, const std::pair<IntersectionIdx, IntersectionIdx> intersect_ids) {
 
-    // calls algorithm function
-    std::vector<StreetSegmentIdx> path = aStarAlgorithm(intersect_ids.first, intersect_ids.second, turn_penalty);
-    return path;
+    // the contraction hierarchy is built from plain travel times, so it can only answer queries
+    // without a turn penalty, as can the bidirectional landmark search that stands in for it on
+    // maps converted without one; the edge-based search, where turns are part of the state,
+    // handles the rest
+    if (turn_penalty == 0) {
+        if (gisevo::map_data::streets_store().has_contraction_hierarchy()) {
+            return contractionHierarchyQuery(intersect_ids.first, intersect_ids.second);
+        }
+        if (!landmarkTable().empty()) {
+            return landmarkPath(intersect_ids.first, intersect_ids.second);
+        }
+    }
+    return edgeBasedPath(intersect_ids.first, intersect_ids.second, turn_penalty);
+}
+
+std::vector<std::vector<StreetSegmentIdx>> findPathsBatch(
+    const std::vector<std::pair<IntersectionIdx, IntersectionIdx>>& intersect_ids, const double turn_penalty) {
+    std::vector<std::vector<StreetSegmentIdx>> paths(intersect_ids.size());
+    #pragma omp parallel for schedule(dynamic)
+    for (std::size_t i = 0; i < intersect_ids.size(); ++i) {
+        paths[i] = findPathBetweenIntersections(turn_penalty, intersect_ids[i]);
+    }
+    return paths;
+}
+
+std::vector<StreetSegmentIdx> findPathBetweenIntersections(const double turn_penalty,
+                                                           const std::pair<IntersectionIdx, IntersectionIdx> intersect_ids,
+                                                           const double departure_time) {
+    // the hierarchy and the bidirectional search both assume fixed travel times
+    if (!gisevo::map_data::speed_profiles().is_open()) {
+        return findPathBetweenIntersections(turn_penalty, intersect_ids);
+    }
+    return edgeBasedPathAt(intersect_ids.first, intersect_ids.second, turn_penalty, departure_time);
 }
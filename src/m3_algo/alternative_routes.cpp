@@ -0,0 +1,161 @@
+#include "alternative_routes.hpp"
+#include "edge_search.hpp"
+#include "m3.h"
+#include "map_data/map_store.hpp"
+#include <algorithm>
+
+namespace {
+
+using gisevo::map_data::StreetsStore;
+
+// Segment factors of the penalized searches, all 1 between queries, so the array is only
+// allocated by the first query on a map
+std::vector<double>& segment_factors(std::size_t segment_count) {
+    thread_local std::vector<double> factors;
+    if (factors.size() != segment_count) {
+        factors.assign(segment_count, 1.0);
+    }
+    return factors;
+}
+
+// The intersection each segment of the path is entered from, then the one it ends at
+std::vector<IntersectionIdx> path_intersections(const StreetsStore& store, IntersectionIdx start_id,
+                                                const std::vector<StreetSegmentIdx>& path) {
+    std::vector<IntersectionIdx> intersections{start_id};
+    intersections.reserve(path.size() + 1);
+    for (const StreetSegmentIdx segment : path) {
+        const IntersectionIdx from = intersections.back();
+        intersections.push_back(store.segment_from(segment) == from ? store.segment_to(segment)
+                                                                    : store.segment_from(segment));
+    }
+    return intersections;
+}
+
+std::vector<StreetSegmentIdx> sorted(std::vector<StreetSegmentIdx> path) {
+    std::sort(path.begin(), path.end());
+    return path;
+}
+
+// Fraction of the path's segment travel time on segments of `other` (sorted)
+double shared_fraction(const StreetsStore& store, const std::vector<StreetSegmentIdx>& path,
+                       const std::vector<StreetSegmentIdx>& other) {
+    double shared = 0;
+    double total = 0;
+    for (const StreetSegmentIdx segment : path) {
+        const double time = store.segment_travel_time(segment);
+        total += time;
+        if (std::binary_search(other.begin(), other.end(), segment)) {
+            shared += time;
+        }
+    }
+    return total > 0 ? shared / total : 1.0;
+}
+
+// Whether every maximal run of the path's segments off the fastest route takes at most
+// (1 + slack) times as long as the part of the fastest route it replaces. Such a run leaves the
+// fastest route and rejoins it; fastest_segments holds the fastest route's segments sorted. The
+// part replaced is itself a fastest route between the two ends, so no search is needed unless
+// the run rejoins the fastest route before the point where it left it.
+bool locally_optimal(double turn_penalty, const std::vector<IntersectionIdx>& intersections,
+                     const std::vector<StreetSegmentIdx>& path, const std::vector<StreetSegmentIdx>& fastest,
+                     const std::vector<StreetSegmentIdx>& fastest_segments,
+                     const std::vector<IntersectionIdx>& fastest_intersections, double slack) {
+    auto on_fastest = [&](StreetSegmentIdx segment) {
+        return std::binary_search(fastest_segments.begin(), fastest_segments.end(), segment);
+    };
+    auto position = [&](IntersectionIdx intersection) {
+        return std::find(fastest_intersections.begin(), fastest_intersections.end(), intersection) -
+               fastest_intersections.begin();
+    };
+
+    std::size_t begin = 0;
+    while (begin < path.size()) {
+        if (on_fastest(path[begin])) {
+            ++begin;
+            continue;
+        }
+        std::size_t end = begin + 1;
+        while (end < path.size() && !on_fastest(path[end])) {
+            ++end;
+        }
+        const auto leave = position(intersections[begin]);
+        const auto rejoin = position(intersections[end]);
+        std::vector<StreetSegmentIdx> replaced;
+        if (leave < rejoin) {
+            replaced.assign(fastest.begin() + leave, fastest.begin() + rejoin);
+        } else if (intersections[begin] != intersections[end]) {
+            replaced = edgeBasedPath(intersections[begin], intersections[end], turn_penalty);
+        }
+        const std::vector<StreetSegmentIdx> detour(path.begin() + begin, path.begin() + end);
+        if (replaced.empty() ||
+            computePathTravelTime(turn_penalty, detour) > (1 + slack) * computePathTravelTime(turn_penalty, replaced)) {
+            return false;
+        }
+        begin = end;
+    }
+    return true;
+}
+
+} // namespace
+
+std::vector<AlternativeRoute> findAlternativeRoutes(double turn_penalty,
+                                                    std::pair<IntersectionIdx, IntersectionIdx> intersect_ids,
+                                                    const AlternativeRouteOptions& options) {
+    const auto [start_id, end_id] = intersect_ids;
+    std::vector<AlternativeRoute> routes;
+    if (options.max_routes == 0) {
+        return routes;
+    }
+    std::vector<StreetSegmentIdx> fastest = edgeBasedPath(start_id, end_id, turn_penalty);
+    if (fastest.empty()) {
+        return routes;
+    }
+    const double fastest_time = computePathTravelTime(turn_penalty, fastest);
+    routes.push_back(AlternativeRoute{std::move(fastest), fastest_time});
+    if (options.max_routes == 1) {
+        return routes;
+    }
+
+    const StreetsStore& store = gisevo::map_data::streets_store();
+    std::vector<double>& factors = segment_factors(store.segment_count());
+    std::vector<StreetSegmentIdx> raised;
+    auto penalize = [&](const std::vector<StreetSegmentIdx>& path) {
+        for (const StreetSegmentIdx segment : path) {
+            if (factors[segment] == 1.0) {
+                raised.push_back(segment);
+            }
+            factors[segment] *= options.penalty_factor;
+        }
+    };
+
+    const std::vector<IntersectionIdx> fastest_intersections =
+        path_intersections(store, start_id, routes.front().path);
+    std::vector<std::vector<StreetSegmentIdx>> taken{sorted(routes.front().path)};
+    penalize(routes.front().path);
+    const std::size_t searches = options.max_routes - 1 + options.spare_searches;
+    for (std::size_t search = 0; search < searches && routes.size() < options.max_routes; ++search) {
+        std::vector<StreetSegmentIdx> candidate = edgeBasedPathPenalized(start_id, end_id, turn_penalty, factors);
+        penalize(candidate);
+        const double time = computePathTravelTime(turn_penalty, candidate);
+        if (time > (1 + options.max_stretch) * fastest_time) {
+            continue;
+        }
+        const bool distinct = std::all_of(taken.begin(), taken.end(), [&](const std::vector<StreetSegmentIdx>& other) {
+            return shared_fraction(store, candidate, other) <= options.max_sharing;
+        });
+        if (!distinct || !locally_optimal(turn_penalty, path_intersections(store, start_id, candidate), candidate,
+                                          routes.front().path, taken.front(), fastest_intersections,
+                                          options.local_slack)) {
+            continue;
+        }
+        taken.push_back(sorted(candidate));
+        routes.push_back(AlternativeRoute{std::move(candidate), time});
+    }
+
+    for (const StreetSegmentIdx segment : raised) {
+        factors[segment] = 1.0;
+    }
+    std::sort(routes.begin() + 1, routes.end(),
+              [](const AlternativeRoute& a, const AlternativeRoute& b) { return a.travel_time < b.travel_time; });
+    return routes;
+}
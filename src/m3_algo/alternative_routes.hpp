@@ -0,0 +1,48 @@
+#pragma once
+
+#include "StreetsDatabaseAPI.h"
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+struct AlternativeRoute {
+    std::vector<StreetSegmentIdx> path;
+    // computePathTravelTime of the path
+    double travel_time;
+};
+
+// What makes a route worth offering besides the fastest one
+struct AlternativeRouteOptions {
+    // routes returned at most, the fastest included
+    std::size_t max_routes = 3;
+    // an alternative takes at most (1 + max_stretch) times as long as the fastest route
+    double max_stretch = 0.3;
+    // at most this fraction of an alternative's segment travel time is on any route taken before it
+    double max_sharing = 0.6;
+    // each detour of an alternative off the fastest route takes at most (1 + local_slack) times as
+    // long as the part of the fastest route it replaces
+    double local_slack = 0.1;
+    // every search multiplies the travel times of the segments of the route it found by this
+    double penalty_factor = 2.0;
+    // penalized searches allowed beyond one per alternative asked for, which bounds the cost of a
+    // query that has few alternatives
+    std::size_t spare_searches = 1;
+};
+
+/*
+ * The fastest route between two intersections followed by up to max_routes - 1 meaningfully
+ * different alternatives, by the penalty method
+ * Each search is the edge-based A* of edgeBasedPath (so turn penalties are exact) on travel times
+ * scaled by per-segment factors, and every route found has its segments made penalty_factor times
+ * slower for the searches after it. A route found that way is kept if it is within the stretch
+ * bound, shares little with the routes kept so far, and is locally optimal: every stretch of it
+ * off the fastest route is close to the part of the fastest route between its ends, which rules
+ * out the pointless loops a penalized search takes around a penalized segment.
+ *
+ * The searches share the thread's search workspace and one array of factors, which is put back
+ * to all ones afterwards. Routes are returned fastest first; empty if the intersections are
+ * identical or not connected.
+ */
+std::vector<AlternativeRoute> findAlternativeRoutes(double turn_penalty,
+                                                    std::pair<IntersectionIdx, IntersectionIdx> intersect_ids,
+                                                    const AlternativeRouteOptions& options = {});
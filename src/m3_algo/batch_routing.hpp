@@ -0,0 +1,17 @@
+#pragma once
+
+#include "StreetsDatabaseAPI.h"
+#include <utility>
+#include <vector>
+
+/*
+ * findPathBetweenIntersections for many pairs at once: result[i] is the route for
+ * intersect_ids[i], exactly as the single query returns it
+ * The pairs are spread over the OpenMP thread pool, whose threads persist between batches. The
+ * routing searches only read the streets.bin mapping and the landmark table, which do not change
+ * once a map is loaded, and each thread keeps its own search workspaces (the thread_local ones of
+ * the searches), so the threads share nothing they write but their own results. A thread's
+ * workspaces are allocated by its first query on a map.
+ */
+std::vector<std::vector<StreetSegmentIdx>> findPathsBatch(
+    const std::vector<std::pair<IntersectionIdx, IntersectionIdx>>& intersect_ids, double turn_penalty);
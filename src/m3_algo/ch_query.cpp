@@ -0,0 +1,152 @@
+#include "ch_query.hpp"
+#include "search_queues.hpp"
+#include "map_data/map_store.hpp"
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+namespace {
+
+constexpr double kUnreached = std::numeric_limits<double>::infinity();
+constexpr std::uint32_t kNoEdge = std::numeric_limits<std::uint32_t>::max();
+
+using gisevo::map_data::StreetsStore;
+using gisevo::converter::ChEdge;
+using gisevo::converter::kChShortcut;
+
+// One search direction. Only the distances are stamped: the parents, the up edge (forward) or
+// down edge (backward) used and the intersection it was relaxed from, are written together with
+// the distance and only read back for intersections reached in the current search.
+struct Direction {
+    StampedLabels<double> distance{kUnreached};
+    std::vector<std::uint32_t> parent_edge;
+    std::vector<IntersectionIdx> parent;
+    IndexedDaryHeap<4> heap;
+
+    void reset(std::size_t intersection_count) {
+        distance.reset(intersection_count);
+        parent_edge.resize(intersection_count);
+        parent.resize(intersection_count);
+        heap.reset(intersection_count);
+    }
+
+    void reach(IntersectionIdx node, double time, std::uint32_t edge, IntersectionIdx from) {
+        distance.write(node) = time;
+        parent_edge[node] = edge;
+        parent[node] = from;
+        heap.push(node, time);
+    }
+
+    // The closest unsettled intersection, or infinity once the search has run out
+    double next_time() const {
+        return heap.empty() ? kUnreached : heap.top_key();
+    }
+};
+
+struct Workspace {
+    Direction forward;
+    Direction backward;
+    std::vector<const ChEdge*> unpack;
+};
+
+// Settles the closest intersection of one direction and updates the best meeting point
+void settle(const StreetsStore& store, bool forward, Direction& self, const Direction& other, double& best,
+            IntersectionIdx& meeting) {
+    const auto [time, node] = self.heap.pop();
+    if (time + other.distance[node] < best) {
+        best = time + other.distance[node];
+        meeting = node;
+    }
+
+    // Stall on demand: if a higher ranked intersection this search already reached leads here
+    // faster, this intersection is not on a shortest route, so nothing is relaxed from it
+    const std::uint32_t stall_begin = forward ? store.ch_down_begin(node) : store.ch_up_begin(node);
+    const std::uint32_t stall_end = forward ? store.ch_down_end(node) : store.ch_up_end(node);
+    for (std::uint32_t k = stall_begin; k < stall_end; ++k) {
+        const ChEdge& edge = forward ? store.ch_down_edge(k) : store.ch_up_edge(k);
+        if (self.distance[edge.to] + edge.travel_time < time) {
+            return;
+        }
+    }
+
+    const std::uint32_t begin = forward ? store.ch_up_begin(node) : store.ch_down_begin(node);
+    const std::uint32_t end = forward ? store.ch_up_end(node) : store.ch_down_end(node);
+    for (std::uint32_t k = begin; k < end; ++k) {
+        const ChEdge& edge = forward ? store.ch_up_edge(k) : store.ch_down_edge(k);
+        const double next_time = time + edge.travel_time;
+        if (next_time < self.distance[edge.to]) {
+            self.reach(edge.to, next_time, k, node);
+        }
+    }
+}
+
+// Appends the street segments an edge stands for, in travel order
+void unpack(const StreetsStore& store, const ChEdge& edge, std::vector<const ChEdge*>& stack,
+            std::vector<StreetSegmentIdx>& route) {
+    stack.clear();
+    stack.push_back(&edge);
+    while (!stack.empty()) {
+        const ChEdge* current = stack.back();
+        stack.pop_back();
+        if (current->segment != kChShortcut) {
+            route.push_back(current->segment);
+        } else {
+            stack.push_back(&store.ch_up_edge(current->second));
+            stack.push_back(&store.ch_down_edge(current->first));
+        }
+    }
+}
+
+} // namespace
+
+std::vector<StreetSegmentIdx> contractionHierarchyQuery(IntersectionIdx start_id, IntersectionIdx end_id) {
+    std::vector<StreetSegmentIdx> route;
+    if (start_id == end_id) {
+        return route;
+    }
+
+    const StreetsStore& store = gisevo::map_data::streets_store();
+    thread_local Workspace workspace;
+    Direction& forward = workspace.forward;
+    Direction& backward = workspace.backward;
+    forward.reset(store.intersection_count());
+    backward.reset(store.intersection_count());
+    forward.reach(start_id, 0, kNoEdge, -1);
+    backward.reach(end_id, 0, kNoEdge, -1);
+
+    // A direction is done once its closest unsettled intersection is no closer than the best
+    // route found, as every route through it would be slower
+    double best = kUnreached;
+    IntersectionIdx meeting = -1;
+    for (;;) {
+        const double forward_time = forward.next_time();
+        const double backward_time = backward.next_time();
+        if (forward_time >= best && backward_time >= best) {
+            break;
+        }
+        if (forward_time <= backward_time) {
+            settle(store, true, forward, backward, best, meeting);
+        } else {
+            settle(store, false, backward, forward, best, meeting);
+        }
+    }
+    if (meeting == -1) {
+        return route;
+    }
+
+    // start -> meeting along the forward parents, which are collected backwards
+    std::vector<std::uint32_t> up_edges;
+    for (IntersectionIdx node = meeting; forward.parent_edge[node] != kNoEdge;) {
+        up_edges.push_back(forward.parent_edge[node]);
+        node = forward.parent[node];
+    }
+    for (auto edge = up_edges.rbegin(); edge != up_edges.rend(); ++edge) {
+        unpack(store, store.ch_up_edge(*edge), workspace.unpack, route);
+    }
+    // meeting -> destination along the backward parents
+    for (IntersectionIdx node = meeting; backward.parent_edge[node] != kNoEdge;) {
+        unpack(store, store.ch_down_edge(backward.parent_edge[node]), workspace.unpack, route);
+        node = backward.parent[node];
+    }
+    return route;
+}
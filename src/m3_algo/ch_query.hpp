@@ -0,0 +1,15 @@
+#pragma once
+
+#include "StreetsDatabaseAPI.h"
+#include <vector>
+
+/*
+ * Fastest route between two intersections over the contraction hierarchy stored in streets.bin
+ * A forward search from the start only follows edges up in rank and a backward search from the
+ * destination only follows edges down in rank (in reverse); the best intersection where they
+ * meet gives the route, whose shortcuts are then expanded back into street segments. The
+ * hierarchy is built from plain travel times, so no turn penalty is applied.
+ *
+ * Returns an empty vector if the intersections are identical or not connected
+ */
+std::vector<StreetSegmentIdx> contractionHierarchyQuery(IntersectionIdx start_id, IntersectionIdx end_id);
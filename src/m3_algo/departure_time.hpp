@@ -0,0 +1,18 @@
+#pragma once
+
+#include "StreetsDatabaseAPI.h"
+#include <utility>
+#include <vector>
+
+/*
+ * findPathBetweenIntersections and computePathTravelTime for a departure at a given time of the
+ * week, `departure_time` seconds after Monday 00:00 (taken modulo a week)
+ * Each segment is driven at the speed its profile in the map's speeds.bin gives for the moment the
+ * route enters it (see map_data::SpeedProfiles); the turn penalty is paid before entering. On a map
+ * without speed profiles these are the same as the overloads without a departure time.
+ */
+std::vector<StreetSegmentIdx> findPathBetweenIntersections(double turn_penalty,
+                                                           std::pair<IntersectionIdx, IntersectionIdx> intersect_ids,
+                                                           double departure_time);
+
+double computePathTravelTime(double turn_penalty, const std::vector<StreetSegmentIdx>& path, double departure_time);
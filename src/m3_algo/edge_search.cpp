@@ -0,0 +1,290 @@
+#include "edge_search.hpp"
+#include "landmarks.hpp"
+#include "search_queues.hpp"
+#include "m1.h"
+#include "map_data/map_store.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+namespace {
+
+constexpr double kUnreached = std::numeric_limits<double>::infinity();
+constexpr std::uint32_t kNoEdge = std::numeric_limits<std::uint32_t>::max();
+constexpr std::int32_t kNoStreet = -1;
+
+using gisevo::map_data::StreetsStore;
+using gisevo::converter::RoutingEdge;
+
+// Per routing edge: best time to its far end, and the routing edge taken before it
+struct EdgeLabel {
+    double time = kUnreached;
+    std::uint32_t parent = kNoEdge;
+};
+
+// Per intersection: the fastest arrival so far and its street, final once `arrived` is set
+struct ArrivalLabel {
+    double time = kUnreached;
+    std::int32_t street = kNoStreet;
+    bool arrived = false;
+};
+
+// Labels and wave fronts of the edge-based searches, reused by every search on the thread. A*
+// pops keys that can drop below the last one popped by rounding, so it needs a heap; Dijkstra's
+// keys never do, so it can use the radix heap.
+struct EdgeSearchWorkspace {
+    StampedLabels<EdgeLabel> edges;
+    StampedLabels<ArrivalLabel> arrivals;
+    IndexedDaryHeap<4> heap;
+    RadixHeap radix_heap;
+
+    void reset(const StreetsStore& store) {
+        edges.reset(store.routing_edge_count());
+        arrivals.reset(store.intersection_count());
+    }
+
+    // An arrival is not worth expanding if the fastest arrival at the same intersection is along
+    // the same street, or at least turn_penalty sooner: that one continues at least as cheaply
+    // along every edge
+    bool dominated(IntersectionIdx intersection, std::int32_t street, double at, double turn_penalty) const {
+        const ArrivalLabel& fastest = arrivals[intersection];
+        return at >= fastest.time + turn_penalty || (street == fastest.street && at >= fastest.time);
+    }
+};
+
+EdgeSearchWorkspace& workspace() {
+    thread_local EdgeSearchWorkspace workspace;
+    return workspace;
+}
+
+// Travel times at the speed limits
+struct FreeFlow {
+    double operator()(const RoutingEdge& edge, double) const { return edge.travel_time; }
+};
+
+// Settles routing edges in order of time plus heuristic(far end) from start_id, popped from
+// wave_front (one of the queues of search_queues.hpp), calling
+// on_arrival(intersection, edge) for the first arrival at each intersection (edge is kNoEdge
+// for start_id) until it returns true. edge_time(edge, at) is the cost of an edge entered `at`
+// after the start. The heuristic must not overestimate the remaining cost, and must not drop by
+// more than an edge's cost along that edge; the travel time bounds hold as long as no edge costs
+// less than its travel time at the speed limit.
+template <typename Queue, typename Heuristic, typename EdgeTime, typename OnArrival>
+void search(const StreetsStore& store, EdgeSearchWorkspace& labels, Queue& wave_front, IntersectionIdx start_id,
+            double turn_penalty, Heuristic heuristic, EdgeTime edge_time, OnArrival on_arrival) {
+    labels.reset(store);
+    wave_front.reset(store.routing_edge_count());
+
+    // Leaving the start costs no turn penalty, so nothing is gained by coming back to it
+    ArrivalLabel& start = labels.arrivals.write(start_id);
+    start.time = 0;
+    start.arrived = true;
+    if (on_arrival(start_id, kNoEdge)) {
+        return;
+    }
+
+    auto relax = [&](std::uint32_t k, double at, std::uint32_t from) {
+        const RoutingEdge& next = store.routing_edge(k);
+        if (next.to == start_id || at >= labels.edges[k].time ||
+            labels.dominated(next.to, next.street, at, turn_penalty)) {
+            return;
+        }
+        EdgeLabel& label = labels.edges.write(k);
+        label.time = at;
+        label.parent = from;
+        ArrivalLabel& arrival = labels.arrivals.write(next.to);
+        if (at < arrival.time) {
+            arrival.time = at;
+            arrival.street = next.street;
+        }
+        wave_front.push(k, at + heuristic(next.to));
+    };
+
+    for (std::uint32_t k = store.routing_edge_begin(start_id); k < store.routing_edge_end(start_id); ++k) {
+        relax(k, edge_time(store.routing_edge(k), 0.0), kNoEdge);
+    }
+
+    while (!wave_front.empty()) {
+        const std::uint32_t current = wave_front.pop().second;
+        const RoutingEdge& edge = store.routing_edge(current);
+        const IntersectionIdx intersection = edge.to;
+        const double time = labels.edges[current].time;
+
+        // the first edge settled into an intersection is its fastest arrival; any other is only
+        // expanded if a turn it avoids could make up for arriving later
+        ArrivalLabel& arrival = labels.arrivals.write(intersection);
+        if (!arrival.arrived) {
+            arrival.arrived = true;
+            if (on_arrival(intersection, current)) {
+                return;
+            }
+        } else if (time > arrival.time && labels.dominated(intersection, edge.street, time, turn_penalty)) {
+            continue;
+        }
+
+        for (std::uint32_t k = store.routing_edge_begin(intersection); k < store.routing_edge_end(intersection); ++k) {
+            const RoutingEdge& next = store.routing_edge(k);
+            double entry_time = time;
+            if (next.street != edge.street) {
+                entry_time += turn_penalty;
+            }
+            relax(k, entry_time + edge_time(next, entry_time), current);
+        }
+    }
+}
+
+// The street segments of the route ending with routing edge `last`
+std::vector<StreetSegmentIdx> route_to(const StreetsStore& store, const EdgeSearchWorkspace& labels,
+                                       std::uint32_t last) {
+    std::vector<StreetSegmentIdx> route;
+    for (std::uint32_t edge = last; edge != kNoEdge; edge = labels.edges[edge].parent) {
+        route.push_back(store.routing_edge(edge).segment);
+    }
+    std::reverse(route.begin(), route.end());
+    return route;
+}
+
+// A* from start_id to end_id on the landmark bounds once loadMap has computed them; until then on
+// the straight line distance, which is in m while max_speed is in m/s, so it never overestimates
+// the remaining time
+template <typename EdgeTime>
+std::vector<StreetSegmentIdx> fastest_path(IntersectionIdx start_id, IntersectionIdx end_id, double turn_penalty,
+                                           EdgeTime edge_time) {
+    if (start_id == end_id) {
+        return {};
+    }
+
+    const StreetsStore& store = gisevo::map_data::streets_store();
+    EdgeSearchWorkspace& labels = workspace();
+
+    std::uint32_t last = kNoEdge;
+    auto run = [&](auto time_to_end) {
+        search(store, labels, labels.heap, start_id, turn_penalty, time_to_end, edge_time,
+               [&](IntersectionIdx intersection, std::uint32_t edge) {
+                   if (intersection != end_id) {
+                       return false;
+                   }
+                   last = edge;
+                   return true;
+               });
+    };
+
+    const LandmarkTable& landmarks = landmarkTable();
+    if (!landmarks.empty()) {
+        run(LandmarkBound(landmarks, end_id, true));
+    } else {
+        const LatLon end_pos = getIntersectionPosition(end_id);
+        const double max_speed = store.summary().max_speed;
+        run([&](IntersectionIdx intersection) {
+            if (!(max_speed > 0)) {
+                return 0.0;
+            }
+            return findDistanceBetweenTwoPoints(getIntersectionPosition(intersection), end_pos) / max_speed;
+        });
+    }
+    if (last == kNoEdge) {
+        return {};
+    }
+    return route_to(store, labels, last);
+}
+
+} // namespace
+
+std::vector<StreetSegmentIdx> edgeBasedPath(IntersectionIdx start_id, IntersectionIdx end_id, double turn_penalty) {
+    return fastest_path(start_id, end_id, turn_penalty, FreeFlow());
+}
+
+std::vector<StreetSegmentIdx> edgeBasedPathAt(IntersectionIdx start_id, IntersectionIdx end_id, double turn_penalty,
+                                              double departure_time) {
+    const gisevo::map_data::SpeedProfiles& profiles = gisevo::map_data::speed_profiles();
+    if (!profiles.is_open()) {
+        return edgeBasedPath(start_id, end_id, turn_penalty);
+    }
+    return fastest_path(start_id, end_id, turn_penalty, [&](const RoutingEdge& edge, double at) {
+        return profiles.travel_time(edge.segment, edge.travel_time, departure_time + at);
+    });
+}
+
+std::vector<StreetSegmentIdx> edgeBasedPathPenalized(IntersectionIdx start_id, IntersectionIdx end_id,
+                                                     double turn_penalty, std::span<const double> segment_factors) {
+    return fastest_path(start_id, end_id, turn_penalty, [&](const RoutingEdge& edge, double) {
+        return edge.travel_time * segment_factors[edge.segment];
+    });
+}
+
+std::vector<StreetSegmentIdx> edgeBasedPathWeighted(IntersectionIdx start_id, IntersectionIdx end_id,
+                                                    std::span<const double> segment_weights) {
+    if (start_id == end_id) {
+        return {};
+    }
+
+    const StreetsStore& store = gisevo::map_data::streets_store();
+    EdgeSearchWorkspace& labels = workspace();
+
+    std::uint32_t last = kNoEdge;
+    search(store, labels, labels.radix_heap, start_id, 0.0, [](IntersectionIdx) { return 0.0; },
+           [&](const RoutingEdge& edge, double) { return segment_weights[edge.segment]; },
+           [&](IntersectionIdx intersection, std::uint32_t edge) {
+               if (intersection != end_id) {
+                   return false;
+               }
+               last = edge;
+               return true;
+           });
+    if (last == kNoEdge) {
+        return {};
+    }
+    return route_to(store, labels, last);
+}
+
+SearchTargets::SearchTargets(const std::vector<IntersectionIdx>& targets, std::size_t intersection_count)
+    : marked_(intersection_count, false) {
+    positions_.reserve(targets.size());
+    for (std::size_t i = 0; i < targets.size(); ++i) {
+        positions_.emplace_back(targets[i], static_cast<std::uint32_t>(i));
+        if (!marked_[targets[i]]) {
+            marked_[targets[i]] = true;
+            ++distinct_;
+        }
+    }
+    std::sort(positions_.begin(), positions_.end());
+}
+
+void edgeBasedTimesFrom(IntersectionIdx start_id, const SearchTargets& targets, double turn_penalty,
+                        std::span<double> times) {
+    const StreetsStore& store = gisevo::map_data::streets_store();
+    EdgeSearchWorkspace& labels = workspace();
+
+    std::fill(times.begin(), times.end(), kUnreached);
+    std::size_t remaining = targets.distinct();
+    if (remaining == 0) {
+        return;
+    }
+    search(store, labels, labels.radix_heap, start_id, turn_penalty, [](IntersectionIdx) { return 0.0; }, FreeFlow(),
+           [&](IntersectionIdx intersection, std::uint32_t) {
+               if (!targets.contains(intersection)) {
+                   return false;
+               }
+               const double time = labels.arrivals[intersection].time;
+               targets.for_each_position(intersection, [&](std::uint32_t i) { times[i] = time; });
+               return --remaining == 0;
+           });
+}
+
+void edgeBasedTimesWithin(IntersectionIdx start_id, double limit, double turn_penalty,
+                          std::vector<std::pair<IntersectionIdx, double>>& reached) {
+    const StreetsStore& store = gisevo::map_data::streets_store();
+    EdgeSearchWorkspace& labels = workspace();
+
+    reached.clear();
+    search(store, labels, labels.radix_heap, start_id, turn_penalty, [](IntersectionIdx) { return 0.0; }, FreeFlow(),
+           [&](IntersectionIdx intersection, std::uint32_t) {
+               const double time = labels.arrivals[intersection].time;
+               if (time > limit) {
+                   return true;
+               }
+               reached.emplace_back(intersection, time);
+               return false;
+           });
+}
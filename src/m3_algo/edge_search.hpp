@@ -0,0 +1,86 @@
+#pragma once
+
+#include "StreetsDatabaseAPI.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+/*
+ * Routing over the edge-based (line) graph of the routing edge table
+ * A search state is a routing edge rather than an intersection, so the street a route arrived
+ * on is part of the state and the turn penalty is an ordinary transition cost: following edge a
+ * with edge b (one of the edges leaving a's far end) costs b's travel time, plus turn_penalty if
+ * b is on another street. Those edges are one contiguous run of the routing edge table, so the
+ * line graph needs no adjacency of its own.
+ *
+ * There are about twice as many states as intersections, but few of them are expanded: once a
+ * route has arrived at an intersection, a later arrival along the same street, or one arriving
+ * turn_penalty or more later, cannot lead anywhere faster. With no turn penalty only the first
+ * arrival is expanded, which is the search over intersections.
+ */
+
+// Fastest route from start_id to end_id by A* on the landmark bounds (landmarks.hpp), or the
+// straight line distance at the map's top speed while there are no landmarks.
+// Empty if the intersections are identical or not connected.
+std::vector<StreetSegmentIdx> edgeBasedPath(IntersectionIdx start_id, IntersectionIdx end_id, double turn_penalty);
+
+// edgeBasedPath leaving `departure_time` seconds after Monday 00:00, with each segment driven at
+// the speed its profile (map_data::SpeedProfiles) gives for the moment the route enters it. The
+// searches assume that entering a segment later never gets out of it sooner, which holds unless a
+// profile speeds up faster than its segments can be driven. Same as edgeBasedPath without profiles.
+std::vector<StreetSegmentIdx> edgeBasedPathAt(IntersectionIdx start_id, IntersectionIdx end_id, double turn_penalty,
+                                              double departure_time);
+
+// edgeBasedPath with the travel time of each segment multiplied by its entry of segment_factors,
+// which must all be at least 1 so the A* bounds still hold
+std::vector<StreetSegmentIdx> edgeBasedPathPenalized(IntersectionIdx start_id, IntersectionIdx end_id,
+                                                     double turn_penalty, std::span<const double> segment_factors);
+
+// Cheapest route from start_id to end_id by Dijkstra on one weight per street segment instead of
+// travel times (infinity closes a segment), without turn penalties
+std::vector<StreetSegmentIdx> edgeBasedPathWeighted(IntersectionIdx start_id, IntersectionIdx end_id,
+                                                    std::span<const double> segment_weights);
+
+/*
+ * The intersections a one-to-many search is looking for, given as a list that may repeat an
+ * intersection. Membership is one bit per intersection, so a search can test every intersection
+ * it settles; the list positions of a member are then found by binary search.
+ */
+class SearchTargets {
+public:
+    SearchTargets(const std::vector<IntersectionIdx>& targets, std::size_t intersection_count);
+
+    std::size_t size() const { return positions_.size(); }
+    std::size_t distinct() const { return distinct_; }
+    bool contains(IntersectionIdx intersection) const { return marked_[intersection]; }
+
+    // Calls visit(i) for every i with targets[i] == intersection
+    template <typename Visit>
+    void for_each_position(IntersectionIdx intersection, Visit visit) const {
+        const std::pair<IntersectionIdx, std::uint32_t> first{intersection, 0};
+        auto it = std::lower_bound(positions_.begin(), positions_.end(), first);
+        for (; it != positions_.end() && it->first == intersection; ++it) {
+            visit(it->second);
+        }
+    }
+
+private:
+    std::vector<bool> marked_;
+    // (intersection, position in the list), sorted
+    std::vector<std::pair<IntersectionIdx, std::uint32_t>> positions_;
+    std::size_t distinct_ = 0;
+};
+
+// Travel time from start_id to each of targets by Dijkstra, which stops once all of them are
+// reached. times[i] is infinity if target i cannot be reached, and 0 if it is start_id.
+void edgeBasedTimesFrom(IntersectionIdx start_id, const SearchTargets& targets, double turn_penalty,
+                        std::span<double> times);
+
+// Every intersection start_id reaches within `limit` seconds, turn penalties included, with its
+// time, in order of time (start_id first). Settles nothing past the limit but the first
+// intersection beyond it.
+void edgeBasedTimesWithin(IntersectionIdx start_id, double limit, double turn_penalty,
+                          std::vector<std::pair<IntersectionIdx, double>>& reached);
@@ -0,0 +1,221 @@
+#include "isochrone.hpp"
+#include "edge_search.hpp"
+#include "map_data/map_store.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+namespace {
+
+using gisevo::map_data::WorldPoint;
+
+constexpr std::size_t kNotOnHull = std::numeric_limits<std::size_t>::max();
+
+double cross(const WorldPoint& origin, const WorldPoint& a, const WorldPoint& b) {
+    return (a.x - origin.x) * (b.y - origin.y) - (a.y - origin.y) * (b.x - origin.x);
+}
+
+double distance(const WorldPoint& a, const WorldPoint& b) {
+    return std::hypot(a.x - b.x, a.y - b.y);
+}
+
+double distance_to_edge(const WorldPoint& point, const WorldPoint& a, const WorldPoint& b) {
+    const double dx = b.x - a.x;
+    const double dy = b.y - a.y;
+    const double length_squared = dx * dx + dy * dy;
+    const double along = length_squared > 0
+                             ? std::clamp(((point.x - a.x) * dx + (point.y - a.y) * dy) / length_squared, 0.0, 1.0)
+                             : 0.0;
+    return std::hypot(point.x - (a.x + along * dx), point.y - (a.y + along * dy));
+}
+
+// Whether segments ab and cd cross at a point inside both
+bool crosses(const WorldPoint& a, const WorldPoint& b, const WorldPoint& c, const WorldPoint& d) {
+    const double c_side = cross(a, b, c);
+    const double d_side = cross(a, b, d);
+    const double a_side = cross(c, d, a);
+    const double b_side = cross(c, d, b);
+    return ((c_side > 0 && d_side < 0) || (c_side < 0 && d_side > 0)) &&
+           ((a_side > 0 && b_side < 0) || (a_side < 0 && b_side > 0));
+}
+
+// One point per cell of a kHullGridSize x kHullGridSize grid over the bounding box (points must
+// not be empty)
+std::vector<WorldPoint> thin(const std::vector<WorldPoint>& points) {
+    WorldPoint low = points.front();
+    WorldPoint high = points.front();
+    for (const WorldPoint& point : points) {
+        low = {std::min(low.x, point.x), std::min(low.y, point.y)};
+        high = {std::max(high.x, point.x), std::max(high.y, point.y)};
+    }
+    const double cell = std::max(high.x - low.x, high.y - low.y) / Isochrone::kHullGridSize;
+    if (!(cell > 0)) {
+        return {points.front()};
+    }
+
+    auto index = [&](double offset) {
+        return std::min(static_cast<std::uint32_t>(offset / cell), std::uint32_t{Isochrone::kHullGridSize - 1});
+    };
+    std::vector<std::pair<std::uint32_t, std::size_t>> cells;
+    cells.reserve(points.size());
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        cells.emplace_back(index(points[i].x - low.x) * Isochrone::kHullGridSize + index(points[i].y - low.y), i);
+    }
+    std::sort(cells.begin(), cells.end());
+    std::vector<WorldPoint> kept;
+    for (std::size_t k = 0; k < cells.size(); ++k) {
+        if (k == 0 || cells[k].first != cells[k - 1].first) {
+            kept.push_back(points[cells[k].second]);
+        }
+    }
+    return kept;
+}
+
+// Andrew's monotone chain: indices of the hull corners, counter-clockwise
+std::vector<std::size_t> convex_hull(const std::vector<WorldPoint>& points) {
+    std::vector<std::size_t> order(points.size());
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return points[a].x < points[b].x || (points[a].x == points[b].x && points[a].y < points[b].y);
+    });
+
+    std::vector<std::size_t> hull(2 * order.size());
+    std::size_t size = 0;
+    auto add = [&](std::size_t i, std::size_t floor) {
+        while (size >= floor && cross(points[hull[size - 2]], points[hull[size - 1]], points[i]) <= 0) {
+            --size;
+        }
+        hull[size++] = i;
+    };
+    for (const std::size_t i : order) {
+        add(i, 2);
+    }
+    const std::size_t lower = size + 1;
+    for (auto i = order.rbegin() + 1; i != order.rend(); ++i) {
+        add(*i, lower);
+    }
+    hull.resize(size - 1);
+    return hull;
+}
+
+std::vector<WorldPoint> concave_hull(const std::vector<WorldPoint>& reached) {
+    if (reached.size() < 3) {
+        return {};
+    }
+    const std::vector<WorldPoint> points = thin(reached);
+    if (points.size() < 3) {
+        return {};
+    }
+    const std::vector<std::size_t> corners = convex_hull(points);
+    if (corners.size() < 3) {
+        return {};
+    }
+
+    // The outline is a ring through next/prev; kNotOnHull marks the inner points
+    std::vector<std::size_t> next(points.size(), kNotOnHull);
+    std::vector<std::size_t> prev(points.size(), kNotOnHull);
+    for (std::size_t k = 0; k < corners.size(); ++k) {
+        next[corners[k]] = corners[(k + 1) % corners.size()];
+        prev[corners[(k + 1) % corners.size()]] = corners[k];
+    }
+
+    // Edges still to dig, by their first point
+    std::vector<std::size_t> pending(corners.begin(), corners.end());
+    while (!pending.empty()) {
+        const std::size_t a = pending.back();
+        pending.pop_back();
+        const std::size_t b = next[a];
+
+        // The nearest inner point on the inner side that is not nearer to the edges either side,
+        // so digging to it does not fold the outline over them
+        std::size_t nearest = kNotOnHull;
+        double nearest_distance = std::numeric_limits<double>::infinity();
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            if (next[i] != kNotOnHull || cross(points[a], points[b], points[i]) <= 0) {
+                continue;
+            }
+            const double to_edge = distance_to_edge(points[i], points[a], points[b]);
+            if (to_edge >= nearest_distance ||
+                distance_to_edge(points[i], points[prev[a]], points[a]) < to_edge ||
+                distance_to_edge(points[i], points[b], points[next[b]]) < to_edge) {
+                continue;
+            }
+            nearest = i;
+            nearest_distance = to_edge;
+        }
+        if (nearest == kNotOnHull ||
+            distance(points[a], points[b]) <=
+                Isochrone::kHullDigRatio * std::min(distance(points[nearest], points[a]),
+                                                    distance(points[nearest], points[b]))) {
+            continue;
+        }
+        // Leave the edge if the dig would cut through the rest of the outline
+        bool blocked = false;
+        for (std::size_t u = b; u != a && !blocked; u = next[u]) {
+            const std::size_t v = next[u];
+            blocked = crosses(points[a], points[nearest], points[u], points[v]) ||
+                      crosses(points[nearest], points[b], points[u], points[v]);
+        }
+        if (blocked) {
+            continue;
+        }
+        next[a] = nearest;
+        prev[nearest] = a;
+        next[nearest] = b;
+        prev[b] = nearest;
+        pending.push_back(a);
+        pending.push_back(nearest);
+    }
+
+    std::vector<WorldPoint> outline;
+    std::size_t i = corners.front();
+    do {
+        outline.push_back(points[i]);
+        i = next[i];
+    } while (i != corners.front());
+    return outline;
+}
+
+} // namespace
+
+Isochrone computeIsochrone(IntersectionIdx src, double seconds, double turn_penalty, bool with_hull) {
+    Isochrone isochrone;
+    isochrone.source = src;
+    isochrone.seconds = seconds;
+    if (!(seconds >= 0)) {
+        return isochrone;
+    }
+
+    std::vector<std::pair<IntersectionIdx, double>> reached;
+    edgeBasedTimesWithin(src, seconds, turn_penalty, reached);
+    isochrone.reached.reserve(reached.size());
+    for (const auto& [intersection, time] : reached) {
+        isochrone.reached.push_back(ReachedIntersection{intersection, time});
+    }
+
+    if (with_hull) {
+        const auto& store = gisevo::map_data::streets_store();
+        const gisevo::map_data::WorldProjection project(store.summary());
+        std::vector<WorldPoint> points;
+        points.reserve(reached.size());
+        for (const auto& [intersection, time] : reached) {
+            points.push_back(project(store.node_position(store.intersection_node(intersection))));
+        }
+        isochrone.hull = concave_hull(points);
+    }
+    return isochrone;
+}
+
+std::vector<Isochrone> computeIsochrones(const std::vector<IntersectionIdx>& sources, double seconds,
+                                         double turn_penalty, bool with_hull) {
+    std::vector<Isochrone> isochrones(sources.size());
+    #pragma omp parallel for schedule(dynamic)
+    for (std::size_t s = 0; s < sources.size(); ++s) {
+        isochrones[s] = computeIsochrone(sources[s], seconds, turn_penalty, with_hull);
+    }
+    return isochrones;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "StreetsDatabaseAPI.h"
+#include "map_data/world_projection.hpp"
+#include <vector>
+
+struct ReachedIntersection {
+    IntersectionIdx intersection;
+    double time;
+};
+
+/*
+ * The part of the map a source reaches within a time budget
+ * `reached` comes from one Dijkstra over the edge-based graph (so turn penalties are exact) that
+ * stops at the first intersection past the budget, instead of a route search per intersection.
+ *
+ * The hull is a concave outline of the reached intersections for drawing, in the world
+ * coordinates of latlonTopoint(). The intersections are thinned to one per cell of a
+ * kHullGridSize x kHullGridSize grid over their bounding box. The outline starts as their convex
+ * hull, and each edge of the outline is then dug in to the inner point nearest to it while the
+ * edge is more than kHullDigRatio times as long as that point is far from its nearer end, and the
+ * two new edges do not cross the rest of the outline.
+ */
+struct Isochrone {
+    static constexpr int kHullGridSize = 64;
+    static constexpr double kHullDigRatio = 2.0;
+
+    IntersectionIdx source = -1;
+    double seconds = 0;
+    // by ascending time, source first
+    std::vector<ReachedIntersection> reached;
+    // counter-clockwise; empty unless asked for, or if the reached intersections span no area
+    std::vector<gisevo::map_data::WorldPoint> hull;
+};
+
+// A negative or NaN budget reaches nothing, not even the source
+Isochrone computeIsochrone(IntersectionIdx src, double seconds, double turn_penalty, bool with_hull = false);
+
+// The isochrone of each source (result[i] is for sources[i]), with the sources spread over threads
+std::vector<Isochrone> computeIsochrones(const std::vector<IntersectionIdx>& sources, double seconds,
+                                         double turn_penalty, bool with_hull = false);
@@ -0,0 +1,256 @@
+#include "landmarks.hpp"
+#include "search_queues.hpp"
+#include "map_data/map_store.hpp"
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace {
+
+constexpr double kUnreached = std::numeric_limits<double>::infinity();
+constexpr std::uint32_t kFar = std::numeric_limits<std::uint32_t>::max();
+// Time step of the first searches, which only measure how far apart the map's ends are
+constexpr double kFineUnit = 1e-3;
+
+using gisevo::map_data::StreetsStore;
+
+// Calls visit(from, segment, travel_time) for every segment a route can arrive at `to` along
+template <typename Visit>
+void for_each_incoming(const StreetsStore& store, IntersectionIdx to, Visit visit) {
+    const auto segments = store.intersection_segments(to);
+    const auto adjacent = store.intersection_adjacent(to);
+    for (std::size_t i = 0; i < segments.size(); ++i) {
+        const StreetSegmentIdx segment = segments[i];
+        if (adjacent[i] == to || (store.segment_one_way(segment) && store.segment_to(segment) != to)) {
+            continue;
+        }
+        visit(adjacent[i], segment, store.segment_travel_time(segment));
+    }
+}
+
+// Times in whole units from source to every intersection (forward) or from every intersection to
+// source, over travel times rounded down to whole units; kFar where not connected
+void unit_times(const StreetsStore& store, IntersectionIdx source, bool forward, double unit,
+                std::vector<std::uint32_t>& times, RadixHeap& heap) {
+    times.assign(store.intersection_count(), kFar);
+    heap.reset(store.intersection_count());
+    times[source] = 0;
+    heap.push(source, 0);
+
+    auto relax = [&](IntersectionIdx next, std::uint32_t at, double travel_time) {
+        at += static_cast<std::uint32_t>(travel_time / unit);
+        if (at < times[next]) {
+            times[next] = at;
+            heap.push(next, at);
+        }
+    };
+    while (!heap.empty()) {
+        const IntersectionIdx current = heap.pop().second;
+        const std::uint32_t at = times[current];
+        if (forward) {
+            for (const auto& edge : store.outgoing_edges(current)) {
+                relax(edge.to, at, edge.travel_time);
+            }
+        } else {
+            for_each_incoming(store, current, [&](IntersectionIdx from, StreetSegmentIdx, double travel_time) {
+                relax(from, at, travel_time);
+            });
+        }
+    }
+}
+
+// The connected intersection with the longest time, and that time
+std::pair<IntersectionIdx, std::uint32_t> farthest(const std::vector<std::uint32_t>& times) {
+    std::pair<IntersectionIdx, std::uint32_t> best{-1, 0};
+    for (std::size_t i = 0; i < times.size(); ++i) {
+        if (times[i] != kFar && (best.first == -1 || times[i] > best.second)) {
+            best = {static_cast<IntersectionIdx>(i), times[i]};
+        }
+    }
+    return best;
+}
+
+std::size_t connected(const std::vector<std::uint32_t>& times) {
+    return times.size() - static_cast<std::size_t>(std::count(times.begin(), times.end(), kFar));
+}
+
+// One direction of landmarkPath(): times from the start (forward) or to the end (backward), and
+// the segment and intersection each time was reached through
+struct Direction {
+    StampedLabels<double> time{kUnreached};
+    std::vector<StreetSegmentIdx> parent_segment;
+    std::vector<IntersectionIdx> parent;
+    IndexedDaryHeap<4> heap;
+
+    void reset(std::size_t intersection_count) {
+        time.reset(intersection_count);
+        parent_segment.resize(intersection_count);
+        parent.resize(intersection_count);
+        heap.reset(intersection_count);
+    }
+
+    void reach(IntersectionIdx node, double at, double key, StreetSegmentIdx segment, IntersectionIdx from) {
+        time.write(node) = at;
+        parent_segment[node] = segment;
+        parent[node] = from;
+        heap.push(node, key);
+    }
+};
+
+struct Workspace {
+    Direction forward;
+    Direction backward;
+};
+
+} // namespace
+
+LandmarkTable& landmarkTable() {
+    static LandmarkTable table;
+    return table;
+}
+
+void computeLandmarks() {
+    const StreetsStore& store = gisevo::map_data::streets_store();
+    LandmarkTable& table = landmarkTable();
+    table = LandmarkTable();
+    const std::size_t intersection_count = store.intersection_count();
+    if (intersection_count == 0) {
+        return;
+    }
+
+    RadixHeap heap;
+    std::vector<std::uint32_t> to(intersection_count);
+    std::vector<std::uint32_t> from(intersection_count);
+
+    // The first landmark is the intersection farthest from a seed that reaches most of the map
+    // (a few are tried, as a seed may sit on a stray piece of road). Every time between
+    // intersections it connects is at most the longest time to it plus the longest time from it,
+    // which sets the unit (with a margin for the rounding of the fine times) so none saturates.
+    IntersectionIdx seed = 0;
+    for (std::size_t attempt = 1; attempt <= 8; ++attempt) {
+        unit_times(store, seed, true, kFineUnit, from, heap);
+        if (2 * connected(from) >= intersection_count) {
+            break;
+        }
+        seed = static_cast<IntersectionIdx>(attempt * intersection_count / 8 % intersection_count);
+    }
+    IntersectionIdx next = farthest(from).first;
+    unit_times(store, next, true, kFineUnit, from, heap);
+    unit_times(store, next, false, kFineUnit, to, heap);
+    const double span = (static_cast<double>(farthest(to).second) + farthest(from).second) * kFineUnit;
+    if (!(span > 0)) {
+        return;
+    }
+    table.unit = span * 1.01 / LandmarkTable::kMaxTime;
+
+    // Each further landmark is the intersection farthest (there and back) from its closest
+    // landmark so far
+    std::vector<std::uint32_t> closest(intersection_count, kFar);
+    std::vector<std::vector<std::uint16_t>> columns;
+    columns.reserve(2 * LandmarkTable::kMaxLandmarks);
+    while (table.landmarks.size() < LandmarkTable::kMaxLandmarks) {
+        unit_times(store, next, false, table.unit, to, heap);
+        unit_times(store, next, true, table.unit, from, heap);
+        table.landmarks.push_back(next);
+        std::vector<std::uint16_t>& to_column = columns.emplace_back(intersection_count);
+        std::vector<std::uint16_t>& from_column = columns.emplace_back(intersection_count);
+        for (std::size_t i = 0; i < intersection_count; ++i) {
+            to_column[i] = to[i] <= LandmarkTable::kMaxTime ? to[i] : LandmarkTable::kNoTime;
+            from_column[i] = from[i] <= LandmarkTable::kMaxTime ? from[i] : LandmarkTable::kNoTime;
+            if (to[i] != kFar && from[i] != kFar) {
+                closest[i] = std::min(closest[i], to[i] + from[i]);
+            }
+        }
+
+        const auto [candidate, distance] = farthest(closest);
+        if (candidate == -1 || distance == 0) {
+            break;
+        }
+        next = candidate;
+    }
+
+    const std::size_t count = table.landmarks.size();
+    table.times.resize(2 * count * intersection_count);
+    for (std::size_t i = 0; i < intersection_count; ++i) {
+        std::uint16_t* row = table.times.data() + 2 * count * i;
+        for (std::size_t l = 0; l < count; ++l) {
+            row[l] = columns[2 * l][i];
+            row[count + l] = columns[2 * l + 1][i];
+        }
+    }
+}
+
+std::vector<StreetSegmentIdx> landmarkPath(IntersectionIdx start_id, IntersectionIdx end_id) {
+    std::vector<StreetSegmentIdx> route;
+    const LandmarkTable& table = landmarkTable();
+    if (start_id == end_id || table.empty()) {
+        return route;
+    }
+
+    const StreetsStore& store = gisevo::map_data::streets_store();
+    thread_local Workspace workspace;
+    Direction& forward = workspace.forward;
+    Direction& backward = workspace.backward;
+    forward.reset(store.intersection_count());
+    backward.reset(store.intersection_count());
+
+    // Both directions search on the average of the two bounds, with opposite signs, so an edge
+    // costs the same in either; then the searches can stop as soon as their closest keys add up
+    // to the best route found, just like bidirectional Dijkstra
+    const LandmarkBound to_end(table, end_id, true);
+    const LandmarkBound from_start(table, start_id, false);
+    auto potential = [&](IntersectionIdx intersection) {
+        return (to_end(intersection) - from_start(intersection)) / 2;
+    };
+
+    forward.reach(start_id, 0, potential(start_id), -1, -1);
+    backward.reach(end_id, 0, -potential(end_id), -1, -1);
+    double best = kUnreached;
+    IntersectionIdx meeting = -1;
+    while (!forward.heap.empty() && !backward.heap.empty()) {
+        if (forward.heap.top_key() + backward.heap.top_key() >= best) {
+            break;
+        }
+        if (forward.heap.top_key() <= backward.heap.top_key()) {
+            const IntersectionIdx current = forward.heap.pop().second;
+            const double at = forward.time[current];
+            for (const auto& edge : store.outgoing_edges(current)) {
+                const double next_time = at + edge.travel_time;
+                if (next_time < forward.time[edge.to]) {
+                    forward.reach(edge.to, next_time, next_time + potential(edge.to), edge.segment, current);
+                    if (next_time + backward.time[edge.to] < best) {
+                        best = next_time + backward.time[edge.to];
+                        meeting = edge.to;
+                    }
+                }
+            }
+        } else {
+            const IntersectionIdx current = backward.heap.pop().second;
+            const double at = backward.time[current];
+            for_each_incoming(store, current, [&](IntersectionIdx from, StreetSegmentIdx segment, double travel_time) {
+                const double next_time = at + travel_time;
+                if (next_time < backward.time[from]) {
+                    backward.reach(from, next_time, next_time - potential(from), segment, current);
+                    if (next_time + forward.time[from] < best) {
+                        best = next_time + forward.time[from];
+                        meeting = from;
+                    }
+                }
+            });
+        }
+    }
+    if (meeting == -1) {
+        return route;
+    }
+
+    // start -> meeting along the forward parents, which are collected backwards
+    for (IntersectionIdx node = meeting; node != start_id; node = forward.parent[node]) {
+        route.push_back(forward.parent_segment[node]);
+    }
+    std::reverse(route.begin(), route.end());
+    // meeting -> destination along the backward parents
+    for (IntersectionIdx node = meeting; node != end_id; node = backward.parent[node]) {
+        route.push_back(backward.parent_segment[node]);
+    }
+    return route;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "StreetsDatabaseAPI.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * ALT (A*, landmarks and the triangle inequality) lower bounds on travel time
+ * For any landmark L, the travel time from v to t is at least d(v, L) - d(t, L) and at least
+ * d(L, t) - d(L, v). Unlike the straight line distance at the map's top speed, these bounds do
+ * not collapse when a single motorway sets the top speed. The landmarks are spread over the map
+ * by farthest point selection, and the times to and from each of them are stored for every
+ * intersection.
+ *
+ * Times are stored as uint16 multiples of `unit` seconds, computed over travel times rounded
+ * down to whole units. That way they are exact shortest times of a graph no slower than the map,
+ * so the bounds never overestimate and never drop by more than an edge's travel time along it,
+ * which the searches rely on.
+ */
+struct LandmarkTable {
+    static constexpr std::size_t kMaxLandmarks = 16;
+    static constexpr std::uint32_t kMaxTime = 0xFFFE;
+    // Not reachable, or too far for 16 bits; either way no bound is taken from it
+    static constexpr std::uint16_t kNoTime = 0xFFFF;
+
+    double unit = 0;
+    std::vector<IntersectionIdx> landmarks;
+    // Per intersection, its times to each landmark then its times from each landmark, so one
+    // bound reads one cache line
+    std::vector<std::uint16_t> times;
+
+    bool empty() const { return landmarks.empty(); }
+    const std::uint16_t* to_landmarks(IntersectionIdx intersection) const {
+        return times.data() + 2 * landmarks.size() * static_cast<std::size_t>(intersection);
+    }
+    const std::uint16_t* from_landmarks(IntersectionIdx intersection) const {
+        return to_landmarks(intersection) + landmarks.size();
+    }
+};
+
+// The table of the loaded map: empty until computeLandmarks() or the load cache fills it
+LandmarkTable& landmarkTable();
+
+// Selects up to LandmarkTable::kMaxLandmarks landmarks on the loaded map and fills landmarkTable()
+void computeLandmarks();
+
+/*
+ * Lower bound on the travel time from any intersection to `endpoint` (to_endpoint) or from
+ * `endpoint` to any intersection (!to_endpoint), ignoring turn penalties
+ */
+class LandmarkBound {
+public:
+    LandmarkBound(const LandmarkTable& table, IntersectionIdx endpoint, bool to_endpoint)
+        : table_(table), count_(table.landmarks.size()), sign_(to_endpoint ? 1 : -1) {
+        std::copy_n(table.to_landmarks(endpoint), count_, to_endpoint_.begin());
+        std::copy_n(table.from_landmarks(endpoint), count_, from_endpoint_.begin());
+    }
+
+    double operator()(IntersectionIdx intersection) const {
+        const std::uint16_t* to = table_.to_landmarks(intersection);
+        const std::uint16_t* from = table_.from_landmarks(intersection);
+        std::int32_t best = 0;
+        for (std::size_t l = 0; l < count_; ++l) {
+            if (to[l] != LandmarkTable::kNoTime && to_endpoint_[l] != LandmarkTable::kNoTime) {
+                best = std::max(best, sign_ * (to[l] - to_endpoint_[l]));
+            }
+            if (from[l] != LandmarkTable::kNoTime && from_endpoint_[l] != LandmarkTable::kNoTime) {
+                best = std::max(best, sign_ * (from_endpoint_[l] - from[l]));
+            }
+        }
+        return best * table_.unit;
+    }
+
+private:
+    const LandmarkTable& table_;
+    std::size_t count_;
+    std::int32_t sign_;
+    std::array<std::int32_t, LandmarkTable::kMaxLandmarks> to_endpoint_{};
+    std::array<std::int32_t, LandmarkTable::kMaxLandmarks> from_endpoint_{};
+};
+
+// Fastest route from start_id to end_id without turn penalties, by bidirectional A* on the
+// landmark bounds. Empty if the intersections are identical or not connected, or if the
+// landmarks have not been computed.
+std::vector<StreetSegmentIdx> landmarkPath(IntersectionIdx start_id, IntersectionIdx end_id);
@@ -0,0 +1,275 @@
+#include "route_metrics.hpp"
+#include "edge_search.hpp"
+#include "search_workspace.hpp"
+#include "map_data/map_store.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+
+constexpr double kUnreached = std::numeric_limits<double>::infinity();
+constexpr std::uint32_t kNoArc = gisevo::converter::kNoCchArc;
+
+using gisevo::map_data::HighwayCategory;
+using gisevo::map_data::StreetsStore;
+using gisevo::converter::RoutingEdge;
+using gisevo::converter::kChShortcut;
+
+// Cheapest route found from (forward) or to (backward) one end of a query, with the arc it
+// followed and the intersection at the other end of that arc
+struct ChainLabel {
+    double cost = kUnreached;
+    std::uint32_t arc = kNoArc;
+    IntersectionIdx from = -1;
+};
+
+struct ChainWorkspace {
+    StampedLabels<ChainLabel> forward;
+    StampedLabels<ChainLabel> backward;
+};
+
+ChainWorkspace& workspace() {
+    thread_local ChainWorkspace workspace;
+    return workspace;
+}
+
+// The lowest ranked higher neighbour, or -1 at a root of the elimination tree
+IntersectionIdx parent(const StreetsStore& store, IntersectionIdx intersection) {
+    const std::uint32_t begin = store.cch_arc_begin(intersection);
+    return begin < store.cch_arc_end(intersection) ? store.cch_arc(begin) : -1;
+}
+
+double truck_factor(HighwayCategory category) {
+    switch (category) {
+    case HighwayCategory::kTrack:
+    case HighwayCategory::kFootway:
+    case HighwayCategory::kPath:
+    case HighwayCategory::kCycleway:
+        return kUnreached;
+    case HighwayCategory::kResidential:
+    case HighwayCategory::kService:
+        return kTruckMinorRoadFactor;
+    default:
+        return 1.0;
+    }
+}
+
+double cycling_factor(HighwayCategory category) {
+    switch (category) {
+    case HighwayCategory::kMotorway:
+    case HighwayCategory::kTrunk:
+        return kUnreached;
+    case HighwayCategory::kPrimary:
+        return 2.0;
+    case HighwayCategory::kSecondary:
+        return 1.5;
+    case HighwayCategory::kTertiary:
+        return 1.2;
+    case HighwayCategory::kFootway:
+        // pushed rather than ridden
+        return 2.5;
+    case HighwayCategory::kTrack:
+    case HighwayCategory::kPath:
+        return 0.9;
+    case HighwayCategory::kCycleway:
+        return 0.7;
+    default:
+        return 1.0;
+    }
+}
+
+// A factor of infinity closes the segment, even one of length 0
+double scaled(double time, double factor) {
+    return factor == kUnreached ? kUnreached : time * factor;
+}
+
+} // namespace
+
+std::vector<double> routeMetricWeights(RouteMetric metric) {
+    const StreetsStore& store = gisevo::map_data::streets_store();
+    std::vector<double> weights(store.segment_count());
+    for (std::size_t segment = 0; segment < weights.size(); ++segment) {
+        const double length = store.segment_length(segment);
+        const double speed = store.segment_speed(segment);
+        const HighwayCategory category = store.segment_category(segment);
+        switch (metric) {
+        case RouteMetric::kTravelTime:
+            weights[segment] = store.segment_travel_time(segment);
+            break;
+        case RouteMetric::kDistance:
+            weights[segment] = length;
+            break;
+        case RouteMetric::kAvoidMotorways:
+            weights[segment] = store.segment_travel_time(segment) *
+                               (category == HighwayCategory::kMotorway ? kAvoidMotorwayFactor : 1.0);
+            break;
+        case RouteMetric::kTruck:
+            weights[segment] = scaled(length / std::min(speed, kTruckSpeed), truck_factor(category));
+            break;
+        case RouteMetric::kCycling:
+            weights[segment] = scaled(length / std::min(speed, kCyclingSpeed), cycling_factor(category));
+            break;
+        }
+    }
+    return weights;
+}
+
+CustomizedMetric::CustomizedMetric(RouteMetric metric) : CustomizedMetric(routeMetricWeights(metric)) {}
+
+CustomizedMetric::CustomizedMetric(std::vector<double> segment_weights)
+    : segment_weights_(std::move(segment_weights)) {
+    const StreetsStore& store = gisevo::map_data::streets_store();
+    if (segment_weights_.size() != store.segment_count()) {
+        throw std::invalid_argument("CustomizedMetric: " + std::to_string(segment_weights_.size()) +
+                                    " weights for " + std::to_string(store.segment_count()) + " street segments");
+    }
+    if (!store.has_customizable_hierarchy()) {
+        return;
+    }
+
+    const Arc none{kUnreached, kChShortcut, 0, 0};
+    up_.assign(store.cch_arc_count(), none);
+    down_.assign(store.cch_arc_count(), none);
+    std::vector<IntersectionIdx> order(store.intersection_count());
+    for (IntersectionIdx i = 0; i < static_cast<IntersectionIdx>(order.size()); ++i) {
+        order[store.cch_rank(i)] = i;
+        for (std::uint32_t k = store.routing_edge_begin(i); k < store.routing_edge_end(i); ++k) {
+            const std::uint32_t arc = store.cch_edge_arc(k);
+            if (arc == kNoArc) {
+                continue;
+            }
+            const RoutingEdge& edge = store.routing_edge(k);
+            Arc& direction = store.cch_rank(i) < store.cch_rank(edge.to) ? up_[arc] : down_[arc];
+            if (segment_weights_[edge.segment] < direction.weight) {
+                direction = Arc{segment_weights_[edge.segment], edge.segment, 0, 0};
+            }
+        }
+    }
+
+    // The arcs out of u only get lower through intersections ranked below u, which are all done
+    // by the time u is reached
+    for (const IntersectionIdx u : order) {
+        const std::uint32_t end = store.cch_arc_end(u);
+        for (std::uint32_t to_x = store.cch_arc_begin(u); to_x < end; ++to_x) {
+            const IntersectionIdx x = store.cch_arc(to_x);
+            // the neighbours of u above x are all neighbours of x, met in the same rank order
+            std::uint32_t x_to_y = store.cch_arc_begin(x);
+            for (std::uint32_t to_y = to_x + 1; to_y < end; ++to_y) {
+                const IntersectionIdx y = store.cch_arc(to_y);
+                while (store.cch_arc(x_to_y) != y) {
+                    ++x_to_y;
+                }
+                const double up = down_[to_x].weight + up_[to_y].weight;
+                if (up < up_[x_to_y].weight) {
+                    up_[x_to_y] = Arc{up, kChShortcut, to_x, to_y};
+                }
+                const double down = down_[to_y].weight + up_[to_x].weight;
+                if (down < down_[x_to_y].weight) {
+                    down_[x_to_y] = Arc{down, kChShortcut, to_y, to_x};
+                }
+            }
+        }
+    }
+}
+
+IntersectionIdx CustomizedMetric::meet(IntersectionIdx start_id, IntersectionIdx end_id, double& cost) const {
+    const StreetsStore& store = gisevo::map_data::streets_store();
+    ChainWorkspace& chains = workspace();
+    chains.forward.reset(store.intersection_count());
+    chains.backward.reset(store.intersection_count());
+    chains.forward.write(start_id).cost = 0;
+    chains.backward.write(end_id).cost = 0;
+
+    // Every higher ranked neighbour is an ancestor, so an intersection's cost is final by the
+    // time the walk up the chain gets to it
+    auto climb = [&](StampedLabels<ChainLabel>& labels, IntersectionIdx from, const std::vector<Arc>& arcs) {
+        for (IntersectionIdx node = from; node != -1; node = parent(store, node)) {
+            const double at = labels[node].cost;
+            if (at == kUnreached) {
+                continue;
+            }
+            for (std::uint32_t k = store.cch_arc_begin(node); k < store.cch_arc_end(node); ++k) {
+                const double next = at + arcs[k].weight;
+                const IntersectionIdx to = store.cch_arc(k);
+                if (next < labels[to].cost) {
+                    labels.write(to) = ChainLabel{next, k, node};
+                }
+            }
+        }
+    };
+    climb(chains.forward, start_id, up_);
+    climb(chains.backward, end_id, down_);
+
+    cost = kUnreached;
+    IntersectionIdx meeting = -1;
+    for (IntersectionIdx node = end_id; node != -1; node = parent(store, node)) {
+        const double through = chains.forward[node].cost + chains.backward[node].cost;
+        if (through < cost) {
+            cost = through;
+            meeting = node;
+        }
+    }
+    return meeting;
+}
+
+std::vector<StreetSegmentIdx> CustomizedMetric::path(IntersectionIdx start_id, IntersectionIdx end_id) const {
+    if (start_id == end_id) {
+        return {};
+    }
+    if (!gisevo::map_data::streets_store().has_customizable_hierarchy()) {
+        return edgeBasedPathWeighted(start_id, end_id, segment_weights_);
+    }
+    double total = 0;
+    const IntersectionIdx meeting = meet(start_id, end_id, total);
+    if (meeting == -1) {
+        return {};
+    }
+
+    // Arcs still to expand, with whether they are taken up; the next part of the route on top
+    const ChainWorkspace& chains = workspace();
+    std::vector<std::pair<std::uint32_t, bool>> pending;
+    std::vector<std::uint32_t> descent;
+    for (IntersectionIdx node = meeting; chains.backward[node].arc != kNoArc; node = chains.backward[node].from) {
+        descent.push_back(chains.backward[node].arc);
+    }
+    for (auto arc = descent.rbegin(); arc != descent.rend(); ++arc) {
+        pending.emplace_back(*arc, false);
+    }
+    for (IntersectionIdx node = meeting; chains.forward[node].arc != kNoArc; node = chains.forward[node].from) {
+        pending.emplace_back(chains.forward[node].arc, true);
+    }
+
+    std::vector<StreetSegmentIdx> route;
+    while (!pending.empty()) {
+        const auto [index, up] = pending.back();
+        pending.pop_back();
+        const Arc& arc = up ? up_[index] : down_[index];
+        if (arc.segment != kChShortcut) {
+            route.push_back(arc.segment);
+        } else {
+            pending.emplace_back(arc.second, true);
+            pending.emplace_back(arc.first, false);
+        }
+    }
+    return route;
+}
+
+double CustomizedMetric::cost(IntersectionIdx start_id, IntersectionIdx end_id) const {
+    if (start_id == end_id) {
+        return 0;
+    }
+    if (!gisevo::map_data::streets_store().has_customizable_hierarchy()) {
+        const std::vector<StreetSegmentIdx> route = edgeBasedPathWeighted(start_id, end_id, segment_weights_);
+        double total = route.empty() ? kUnreached : 0;
+        for (const StreetSegmentIdx segment : route) {
+            total += segment_weights_[segment];
+        }
+        return total;
+    }
+    double total = 0;
+    meet(start_id, end_id, total);
+    return total;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "StreetsDatabaseAPI.h"
+#include <cstdint>
+#include <vector>
+
+// Weightings of the street segments that routeMetricWeights provides
+enum class RouteMetric {
+    kTravelTime,      // seconds at the speed limit
+    kDistance,        // metres
+    kAvoidMotorways,  // seconds, with motorway segments counted kAvoidMotorwayFactor times
+    kTruck,           // seconds at no more than kTruckSpeed, off tracks and paths, residential and
+                      // service roads counted kTruckMinorRoadFactor times
+    kCycling,         // seconds at no more than kCyclingSpeed, scaled by how comfortable the road
+                      // is to ride, off motorways and trunk roads
+};
+
+inline constexpr double kAvoidMotorwayFactor = 10.0;
+inline constexpr double kTruckSpeed = 80.0 / 3.6;  // m/s
+inline constexpr double kTruckMinorRoadFactor = 3.0;
+inline constexpr double kCyclingSpeed = 18.0 / 3.6;  // m/s
+
+// The weight of every street segment of the loaded map under `metric`; infinity closes a segment
+std::vector<double> routeMetricWeights(RouteMetric metric);
+
+/*
+ * Routing on any weighting of the street segments over the customizable hierarchy in streets.bin
+ * Constructing one is the customization: each arc of the hierarchy starts at the lowest weight of
+ * the segments along it in each direction, then, going up the ranks, each intersection u lowers
+ * every arc {x, y} between two of its higher ranked neighbours to the route x -> u -> y where that
+ * is cheaper. The arcs then describe a contraction hierarchy of the weights. The higher ranked
+ * neighbours of an intersection are all its ancestors in the elimination tree (whose parent links
+ * go to the lowest ranked higher neighbour), so a query relaxes the arcs up the chain of ancestors
+ * of each end, with no priority queue, and meets at their best common ancestor.
+ *
+ * The ordering is computed once by the converter and does not depend on the weights, so a new
+ * weighting (per request type or per tenant) costs one pass over the lower triangles of the
+ * arcs rather than a new hierarchy. There are no turn penalties. On maps converted without the
+ * hierarchy (--no-contraction) queries fall back to Dijkstra on the weights.
+ *
+ * Customized metrics are read only, so any number of threads can query one.
+ */
+class CustomizedMetric {
+public:
+    explicit CustomizedMetric(RouteMetric metric);
+    // One non-negative weight per street segment of the loaded map, infinity to close a segment.
+    // Throws std::invalid_argument if the count does not match the map.
+    explicit CustomizedMetric(std::vector<double> segment_weights);
+
+    double segment_weight(StreetSegmentIdx segment) const { return segment_weights_[segment]; }
+
+    // Cheapest route from start_id to end_id as street segments. Empty if the intersections are
+    // identical or not connected.
+    std::vector<StreetSegmentIdx> path(IntersectionIdx start_id, IntersectionIdx end_id) const;
+
+    // The weight of that route: 0 if the intersections are identical, infinity if not connected
+    double cost(IntersectionIdx start_id, IntersectionIdx end_id) const;
+
+private:
+    // An arc of the hierarchy in one direction, standing either for a street segment or for the
+    // down arc `first` into a lower ranked intersection followed by the up arc `second` out of it
+    struct Arc {
+        double weight;
+        std::int32_t segment;
+        std::uint32_t first;
+        std::uint32_t second;
+    };
+
+    // Runs both chains and returns the meeting intersection, or -1 if there is none
+    IntersectionIdx meet(IntersectionIdx start_id, IntersectionIdx end_id, double& cost) const;
+
+    std::vector<double> segment_weights_;
+    // per hierarchy arc, from its lower ranked end to its higher ranked end and back
+    std::vector<Arc> up_;
+    std::vector<Arc> down_;
+};
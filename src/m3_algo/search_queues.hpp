@@ -0,0 +1,215 @@
+#pragma once
+
+#include "search_workspace.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/*
+ * Priority queues of the routing searches, keyed by a state id (intersection or routing edge)
+ * Each id is queued at most once: pushing a queued id again lowers its key if the new one is
+ * smaller, so a search never pops a stale entry. The position of every queued id is kept in
+ * stamped labels, so reset() is O(1) like the search labels themselves.
+ *
+ * The searches take the queue as a template parameter; both queues provide
+ * reset(ids) / empty() / push(id, key) / pop() -> {key, id}.
+ */
+
+// Implicit heap with Arity children per entry. Entries are just key and id (16 bytes), and a
+// wider node halves the depth of a binary heap, so sifting down touches fewer cache lines.
+template <unsigned Arity = 4>
+class IndexedDaryHeap {
+public:
+    void reset(std::size_t ids) {
+        positions_.reset(ids);
+        entries_.clear();
+    }
+
+    bool empty() const { return entries_.empty(); }
+    double top_key() const { return entries_.front().key; }
+
+    // Queues id with key, or lowers its key if it is already queued with a larger one
+    void push(std::uint32_t id, double key) {
+        std::uint32_t position = positions_[id];
+        if (position == kNotQueued) {
+            position = static_cast<std::uint32_t>(entries_.size());
+            entries_.push_back({key, id});
+        } else if (key < entries_[position].key) {
+            entries_[position].key = key;
+        } else {
+            return;
+        }
+        sift_up(position);
+    }
+
+    std::pair<double, std::uint32_t> pop() {
+        const Entry top = entries_.front();
+        positions_.write(top.id) = kNotQueued;
+        const Entry last = entries_.back();
+        entries_.pop_back();
+        if (!entries_.empty()) {
+            place(0, last);
+            sift_down(0);
+        }
+        return {top.key, top.id};
+    }
+
+private:
+    struct Entry {
+        double key;
+        std::uint32_t id;
+    };
+
+    static constexpr std::uint32_t kNotQueued = std::numeric_limits<std::uint32_t>::max();
+
+    void place(std::uint32_t position, const Entry& entry) {
+        entries_[position] = entry;
+        positions_.write(entry.id) = position;
+    }
+
+    void sift_up(std::uint32_t position) {
+        const Entry entry = entries_[position];
+        while (position > 0) {
+            const std::uint32_t parent = (position - 1) / Arity;
+            if (entries_[parent].key <= entry.key) {
+                break;
+            }
+            place(position, entries_[parent]);
+            position = parent;
+        }
+        place(position, entry);
+    }
+
+    void sift_down(std::uint32_t position) {
+        const Entry entry = entries_[position];
+        const std::size_t size = entries_.size();
+        for (;;) {
+            const std::size_t first = static_cast<std::size_t>(position) * Arity + 1;
+            if (first >= size) {
+                break;
+            }
+            std::size_t smallest = first;
+            const std::size_t end = std::min(first + Arity, size);
+            for (std::size_t child = first + 1; child < end; ++child) {
+                if (entries_[child].key < entries_[smallest].key) {
+                    smallest = child;
+                }
+            }
+            if (entries_[smallest].key >= entry.key) {
+                break;
+            }
+            place(position, entries_[smallest]);
+            position = static_cast<std::uint32_t>(smallest);
+        }
+        place(position, entry);
+    }
+
+    StampedLabels<std::uint32_t> positions_{kNotQueued};
+    std::vector<Entry> entries_;
+};
+
+// Radix heap over the bit patterns of the keys, which order like the keys for non-negative
+// doubles. Keys are bucketed by the highest bit in which they differ from the last key popped,
+// so every entry moves to a lower bucket at most 64 times in total rather than sifting through
+// a heap on each operation. Only for Dijkstra-like searches: a key pushed must not be smaller
+// than the last key popped.
+class RadixHeap {
+public:
+    void reset(std::size_t ids) {
+        positions_.reset(ids);
+        for (std::vector<Entry>& bucket : buckets_) {
+            bucket.clear();
+        }
+        size_ = 0;
+        last_ = 0;
+    }
+
+    bool empty() const { return size_ == 0; }
+
+    // Queues id with key, or lowers its key if it is already queued with a larger one
+    void push(std::uint32_t id, double key) {
+        const std::uint64_t bits = std::bit_cast<std::uint64_t>(key);
+        const Position position = positions_[id];
+        if (position.bucket == kNotQueued) {
+            ++size_;
+        } else if (bits < buckets_[position.bucket][position.index].bits) {
+            remove(position);
+        } else {
+            return;
+        }
+        insert({bits, id});
+    }
+
+    std::pair<double, std::uint32_t> pop() {
+        if (buckets_[0].empty()) {
+            refill();
+        }
+        const Entry entry = buckets_[0].back();
+        buckets_[0].pop_back();
+        positions_.write(entry.id) = kUnqueued;
+        --size_;
+        return {std::bit_cast<double>(entry.bits), entry.id};
+    }
+
+private:
+    struct Entry {
+        std::uint64_t bits;
+        std::uint32_t id;
+    };
+
+    struct Position {
+        std::uint32_t bucket;
+        std::uint32_t index;
+    };
+
+    static constexpr std::uint32_t kNotQueued = std::numeric_limits<std::uint32_t>::max();
+    static constexpr Position kUnqueued{kNotQueued, 0};
+
+    // bucket 0 holds keys equal to the last key popped, bucket b keys that first differ in bit b - 1
+    std::uint32_t bucket_of(std::uint64_t bits) const {
+        return bits == last_ ? 0 : 64 - std::countl_zero(bits ^ last_);
+    }
+
+    void insert(const Entry& entry) {
+        const std::uint32_t index = bucket_of(entry.bits);
+        std::vector<Entry>& bucket = buckets_[index];
+        positions_.write(entry.id) = {index, static_cast<std::uint32_t>(bucket.size())};
+        bucket.push_back(entry);
+    }
+
+    void remove(const Position& position) {
+        std::vector<Entry>& bucket = buckets_[position.bucket];
+        const Entry moved = bucket.back();
+        bucket[position.index] = moved;
+        positions_.write(moved.id).index = position.index;
+        bucket.pop_back();
+    }
+
+    // Makes the smallest key in the first non-empty bucket the last key popped; relative to it
+    // every other key of that bucket differs in a lower bit, so they all move to lower buckets
+    void refill() {
+        std::size_t first = 1;
+        while (buckets_[first].empty()) {
+            ++first;
+        }
+        std::uint64_t smallest = std::numeric_limits<std::uint64_t>::max();
+        for (const Entry& entry : buckets_[first]) {
+            smallest = std::min(smallest, entry.bits);
+        }
+        last_ = smallest;
+        for (const Entry& entry : buckets_[first]) {
+            insert(entry);
+        }
+        buckets_[first].clear();
+    }
+
+    StampedLabels<Position> positions_{kUnqueued};
+    std::array<std::vector<Entry>, 65> buckets_;
+    std::size_t size_ = 0;
+    std::uint64_t last_ = 0;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Label array of a graph search that is cleared in O(1)
+ * Every slot records the generation it was last written in, and a slot from an earlier
+ * generation reads as the `unset` label given on construction. Starting a search only bumps the
+ * generation, so a search costs time in the number of slots it touches rather than in the size
+ * of the map.
+ * Kept per thread (see the thread_local workspaces of the searches), the array is only
+ * allocated by the first search on a map.
+ */
+template <typename Label>
+class StampedLabels {
+public:
+    explicit StampedLabels(Label unset = Label{}) : unset_(unset) {}
+
+    void reset(std::size_t size) {
+        if (slots_.size() != size) {
+            slots_.assign(size, Slot{});
+            generation_ = 1;
+        } else if (++generation_ == 0) {
+            // after 2^32 searches the stamps wrap around and have to be cleared once
+            for (Slot& slot : slots_) {
+                slot.generation = 0;
+            }
+            generation_ = 1;
+        }
+    }
+
+    const Label& operator[](std::size_t i) const {
+        const Slot& slot = slots_[i];
+        return slot.generation == generation_ ? slot.label : unset_;
+    }
+
+    // The slot to update, starting from the unset label if it was not written in this search yet
+    Label& write(std::size_t i) {
+        Slot& slot = slots_[i];
+        if (slot.generation != generation_) {
+            slot.generation = generation_;
+            slot.label = unset_;
+        }
+        return slot.label;
+    }
+
+private:
+    // the stamp sits next to the label so reading a label touches one cache line
+    struct Slot {
+        Label label{};
+        std::uint32_t generation = 0;
+    };
+
+    Label unset_;
+    std::vector<Slot> slots_;
+    std::uint32_t generation_ = 0;
+};
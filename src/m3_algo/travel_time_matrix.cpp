@@ -0,0 +1,149 @@
+#include "travel_time_matrix.hpp"
+#include "edge_search.hpp"
+#include "search_queues.hpp"
+#include "m3.h"
+#include "map_data/map_store.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+
+namespace {
+
+constexpr double kUnreached = std::numeric_limits<double>::infinity();
+
+using gisevo::map_data::StreetsStore;
+using gisevo::converter::ChEdge;
+
+// A target's time from an intersection its upward search settled
+struct BucketEntry {
+    std::uint32_t target;
+    double time;
+};
+
+struct UpwardSearch {
+    StampedLabels<double> distance{kUnreached};
+    IndexedDaryHeap<4> heap;
+};
+
+// Settles everything an upward search from start_id reaches, following up edges (forward) or
+// down edges in reverse (backward), and calls settled(intersection, time) for each intersection
+// that is not stalled. A stalled intersection is reached faster through a higher ranked one, so
+// it is not the top of any fastest route from or to start_id.
+template <typename Settled>
+void search_upward(const StreetsStore& store, bool forward, IntersectionIdx start_id, Settled settled) {
+    thread_local UpwardSearch search;
+    search.distance.reset(store.intersection_count());
+    search.heap.reset(store.intersection_count());
+    search.distance.write(start_id) = 0;
+    search.heap.push(start_id, 0);
+
+    while (!search.heap.empty()) {
+        const auto [time, node] = search.heap.pop();
+        const std::uint32_t stall_begin = forward ? store.ch_down_begin(node) : store.ch_up_begin(node);
+        const std::uint32_t stall_end = forward ? store.ch_down_end(node) : store.ch_up_end(node);
+        bool stalled = false;
+        for (std::uint32_t k = stall_begin; k < stall_end && !stalled; ++k) {
+            const ChEdge& edge = forward ? store.ch_down_edge(k) : store.ch_up_edge(k);
+            stalled = search.distance[edge.to] + edge.travel_time < time;
+        }
+        if (stalled) {
+            continue;
+        }
+        settled(static_cast<IntersectionIdx>(node), time);
+
+        const std::uint32_t begin = forward ? store.ch_up_begin(node) : store.ch_down_begin(node);
+        const std::uint32_t end = forward ? store.ch_up_end(node) : store.ch_down_end(node);
+        for (std::uint32_t k = begin; k < end; ++k) {
+            const ChEdge& edge = forward ? store.ch_up_edge(k) : store.ch_down_edge(k);
+            const double next_time = time + edge.travel_time;
+            if (next_time < search.distance[edge.to]) {
+                search.distance.write(edge.to) = next_time;
+                search.heap.push(edge.to, next_time);
+            }
+        }
+    }
+}
+
+// Bucket many-to-many over the contraction hierarchy; times is source major
+void bucket_times(const StreetsStore& store, const std::vector<IntersectionIdx>& sources,
+                  const std::vector<IntersectionIdx>& targets, std::vector<double>& times) {
+    const std::size_t target_count = targets.size();
+
+    // Backward searches, collected per target so they can run in parallel
+    std::vector<std::vector<std::pair<IntersectionIdx, double>>> reached(target_count);
+    #pragma omp parallel for schedule(dynamic)
+    for (std::size_t t = 0; t < target_count; ++t) {
+        search_upward(store, false, targets[t], [&](IntersectionIdx intersection, double time) {
+            reached[t].emplace_back(intersection, time);
+        });
+    }
+
+    // then sorted into one bucket per intersection, stored contiguously
+    std::vector<std::uint32_t> bucket_begin(store.intersection_count() + 1, 0);
+    for (const auto& settled : reached) {
+        for (const auto& [intersection, time] : settled) {
+            ++bucket_begin[intersection + 1];
+        }
+    }
+    for (std::size_t i = 1; i < bucket_begin.size(); ++i) {
+        bucket_begin[i] += bucket_begin[i - 1];
+    }
+    std::vector<BucketEntry> buckets(bucket_begin.back());
+    std::vector<std::uint32_t> next(bucket_begin.begin(), bucket_begin.end() - 1);
+    for (std::size_t t = 0; t < target_count; ++t) {
+        for (const auto& [intersection, time] : reached[t]) {
+            buckets[next[intersection]++] = {static_cast<std::uint32_t>(t), time};
+        }
+    }
+    reached = {};
+
+    // Forward searches, each filling its own row
+    #pragma omp parallel for schedule(dynamic)
+    for (std::size_t s = 0; s < sources.size(); ++s) {
+        double* row = times.data() + s * target_count;
+        search_upward(store, true, sources[s], [&](IntersectionIdx intersection, double time) {
+            for (std::uint32_t k = bucket_begin[intersection]; k < bucket_begin[intersection + 1]; ++k) {
+                row[buckets[k].target] = std::min(row[buckets[k].target], time + buckets[k].time);
+            }
+        });
+    }
+}
+
+} // namespace
+
+TravelTimeMatrix::TravelTimeMatrix(std::vector<IntersectionIdx> sources, std::vector<IntersectionIdx> targets,
+                                   double turn_penalty)
+    : sources_(std::move(sources)), targets_(std::move(targets)), turn_penalty_(turn_penalty),
+      times_(sources_.size() * targets_.size(), kUnreached) {
+    const StreetsStore& store = gisevo::map_data::streets_store();
+    if (times_.empty()) {
+        return;
+    }
+
+    // the hierarchy is built from plain travel times, so it only answers queries without a turn
+    // penalty (see findPathBetweenIntersections)
+    if (turn_penalty_ == 0 && store.has_contraction_hierarchy()) {
+        bucket_times(store, sources_, targets_, times_);
+        return;
+    }
+
+    const SearchTargets members(targets_, store.intersection_count());
+    const std::size_t target_count = targets_.size();
+    #pragma omp parallel for schedule(dynamic)
+    for (std::size_t s = 0; s < sources_.size(); ++s) {
+        edgeBasedTimesFrom(sources_[s], members, turn_penalty_,
+                           std::span<double>(times_).subspan(s * target_count, target_count));
+    }
+}
+
+std::vector<StreetSegmentIdx> TravelTimeMatrix::route(std::size_t source, std::size_t target) const {
+    return findPathBetweenIntersections(turn_penalty_, {sources_[source], targets_[target]});
+}
+
+TravelTimeMatrix computeTravelTimeMatrix(const std::vector<IntersectionIdx>& sources,
+                                         const std::vector<IntersectionIdx>& targets,
+                                         double turn_penalty) {
+    return TravelTimeMatrix(sources, targets, turn_penalty);
+}
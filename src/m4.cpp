@@ -3,6 +3,7 @@
 //
 #include "m4.h"
 #include "StreetsDatabaseAPI.h"
+#include "courier_solve.hpp"
 #include "globals.h"
 #include "ms4helpers.hpp"
 #include "struct.h"
@@ -61,23 +62,21 @@
 // return an empty (size == 0) vector.
 
 std::vector<CourierSubPath> travelingCourier(const float turn_penalty, const std::vector<DeliveryInf>& deliveries, const std::vector<IntersectionIdx>& depots) {
+    return travelingCourier(turn_penalty, deliveries, depots, CourierSolveOptions{});
+}
 
-    auto start = std::chrono::high_resolution_clock::now();
+std::vector<CourierSubPath> travelingCourier(const float turn_penalty, const std::vector<DeliveryInf>& deliveries,
+                                             const std::vector<IntersectionIdx>& depots,
+                                             const CourierSolveOptions& options) {
+
+    const auto start = std::chrono::steady_clock::now();
+    const unsigned threads = options.threads != 0 ? options.threads : std::max(1U, std::thread::hardware_concurrency() / 2);
 
     std::vector<IntersectionIdx> pick_ups;
     std::vector<IntersectionIdx> drop_offs;
     std::vector<IntersectionIdx> key_intersections;
     loadDeliveryDetails(deliveries, depots, pick_ups, drop_offs, key_intersections);
     std::vector<CourierSubPath> best_delivery_route;
-    std::vector<std::vector<OneRoute>> routes_matrix;
-
-
-    // resize the routes matrix
-    routes_matrix.resize(key_intersections.size());
-    routes_matrix.resize(getNumIntersections());
-    for (auto &i: routes_matrix) {
-        i.resize(key_intersections.size());
-    }
 
     const std::vector<IntersectionIdx> no_dup_deliveries = find_unique_intersections(deliveries, depots);
     // create an unordered map that contains a relation between the intersection index, and it's apparent position inside the key_intersections array
@@ -86,9 +85,9 @@ std::vector<CourierSubPath> travelingCourier(const float turn_penalty, const std
     // call the function to form the unordered map
     preloadKeys(key_intersections, intersection_to_index);
 
-    // call the multi-dijkstra algorithm to find the routes between all deliveries and depots
-
-    compute_all_travel_times(key_intersections, intersection_to_index, routes_matrix, turn_penalty);
+    // find the travel times between all deliveries and depots; the routes of the final path are
+    // only searched for in indexToSubPath
+    const RouteMatrix routes_matrix(key_intersections, turn_penalty);
 
 
     // Output the result
@@ -121,7 +120,7 @@ std::vector<CourierSubPath> travelingCourier(const float turn_penalty, const std
         depot_travel_time.resize(depots.size());
         closest_depots = depots;
     }
-    #pragma omp parallel for
+    #pragma omp parallel for num_threads(threads)
     for(int i = 0; i < closest_depots.size(); i++){
         vec_path[i]= greedyAlgo(pick_ups,routes_matrix,closest_depots[i],intersection_to_index);
         depot_travel_time[i] = pathCost(vec_path[i],routes_matrix,intersection_to_index);
@@ -137,11 +136,12 @@ std::vector<CourierSubPath> travelingCourier(const float turn_penalty, const std
         }
     }
     std::vector<IntersectionIdx> path = vec_path[depot_index];
+    CourierIncumbent incumbent(options, start,
+                               courierLowerBound(key_intersections, depots, routes_matrix, intersection_to_index));
+    incumbent.offer(path, fastest_time);
 
     // now call our algorithm that tests different routes
-    if(deliveries.size()>20) {
-        const double initial_path_cost = pathCost(path, routes_matrix, intersection_to_index);
-        std::cout << initial_path_cost << std::endl;
+    if(deliveries.size()>20 && !incumbent.finished()) {
         int temperature = 150;
         const double alpha = 0.99;
         const std::unordered_map<IntersectionIdx, Delivery_details> delivery_details = globals.delivery_info;
@@ -149,53 +149,25 @@ std::vector<CourierSubPath> travelingCourier(const float turn_penalty, const std
         unsigned int seed = time(nullptr) ^ omp_get_thread_num();
         struct drand48_data buffer;
         srand48_r(seed, &buffer);
-        std::vector<IntersectionIdx> best_path = path;
         std::vector<std::future<std::vector<IntersectionIdx>>> futures;
-        uint num_parts = std::thread::hardware_concurrency() / 2;
-        double curr_cost = initial_path_cost;
-
-        int midpoint = (int)(path.size() / 2); // Index at midpoint
-        int firstHalfPerThread = midpoint / 2;
-        int secondHalfPerThread = (path.size() - midpoint) / 6;
-
-        std::vector<int> parts(num_parts, 0);
-        parts[0] = firstHalfPerThread;
-        parts[1]= midpoint -firstHalfPerThread;
-        for (int i = 2; i < num_parts; ++i) {
-            parts[i] = secondHalfPerThread;
-            if (i == num_parts - 1) {
-                parts[i] = path.size() - midpoint - 5 * secondHalfPerThread; // Ensure all tasks in the second half are covered
-            }
-        }
 
-        // Dispatch tasks
-        int current_start = 0;
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::seconds>(end - start);
-        const long time_to_here = duration.count();
-        for (int i = 0; i < num_parts; ++i) {
-            if (parts[i] > 0) {
-                futures.push_back(std::async(std::launch::async, annealingTwoOpt, temperature, alpha, buffer,std::cref(path),initial_path_cost,
-                                             std::ref(routes_matrix), time_to_here, std::ref(intersection_to_index),
-                                             delivery_details, current_start + parts[i] + 1, current_start + 1));
+        // each thread starts its 2-opt moves from its own share of the stops between the depots
+        const int stops = static_cast<int>(path.size()) - 2;
+        for (unsigned part = 0; part < threads; ++part) {
+            const int min_bound = 1 + static_cast<int>(part * stops / threads);
+            const int max_bound = 1 + static_cast<int>((part + 1) * stops / threads);
+            if (max_bound > min_bound) {
+                futures.push_back(std::async(std::launch::async, annealingTwoOpt, temperature, alpha, buffer,std::cref(path),
+                                             std::cref(routes_matrix), std::ref(incumbent), std::cref(intersection_to_index),
+                                             delivery_details, max_bound, min_bound));
             }
-            current_start += parts[i];
         }
+        // the threads hand every improvement to the incumbent as they find it
         for (auto &future: futures) {
-            std::vector<IntersectionIdx> final_path = future.get();
-            double final_cost = pathCost(final_path, routes_matrix, intersection_to_index);
-            if (final_cost < curr_cost) {
-                curr_cost = final_cost;
-                best_path = final_path;
-            }
+            future.get();
         }
-
-        best_delivery_route = indexToSubPath(best_path, routes_matrix, intersection_to_index);
-
-    }
-    else{
-        best_delivery_route = indexToSubPath(path, routes_matrix, intersection_to_index);
     }
+    best_delivery_route = indexToSubPath(incumbent.best(), routes_matrix, intersection_to_index);
 
     globals.delivery_info.clear();
     return best_delivery_route;
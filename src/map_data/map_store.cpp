@@ -0,0 +1,310 @@
+#include "map_store.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace gisevo::map_data {
+namespace {
+
+void check_header(ByteCursor& cursor, const char (&expected_magic)[8], std::uint32_t expected_version,
+                  const std::filesystem::path& path) {
+    char magic[sizeof(expected_magic)];
+    for (char& c : magic) {
+        c = cursor.read<char>();
+    }
+    if (!std::equal(std::begin(magic), std::end(magic), std::begin(expected_magic))) {
+        throw std::runtime_error(path.string() + " is not an osm_converter output file");
+    }
+    const auto version = cursor.read<std::uint32_t>();
+    if (version != expected_version) {
+        throw std::runtime_error(path.string() + " has schema version " + std::to_string(version) +
+                                 ", expected " + std::to_string(expected_version) +
+                                 "; rerun osm_converter with --force");
+    }
+}
+
+void require_count(std::size_t actual, std::size_t expected, const char* what) {
+    if (actual != expected) {
+        throw std::runtime_error(std::string(what) + " has " + std::to_string(actual) + " entries, expected " +
+                                 std::to_string(expected));
+    }
+}
+
+// Offsets must hold count + 1 entries running from 0 to the size of the array they index
+template <typename Offset>
+void require_offsets(std::span<const Offset> offsets, std::size_t count, std::size_t target_size, const char* what) {
+    require_count(offsets.size(), count + 1, what);
+    if (offsets.front() != 0 || offsets.back() != target_size) {
+        throw std::runtime_error(std::string(what) + " do not cover their array");
+    }
+}
+
+}  // namespace
+
+void StreetsStore::open(const std::filesystem::path& path) {
+    close();
+    file_.open(path, converter::kStreetsMagic, converter::kStreetsSchemaVersion);
+    map_sections(path);
+}
+
+void StreetsStore::close() {
+    file_.close();
+    *this = StreetsStore();
+}
+
+void StreetsStore::map_sections(const std::filesystem::path& path) {
+    summary_ = file_.section<converter::NetworkSummary>(SectionId::kSummary);
+
+    node_ids_ = file_.section<std::int64_t>(SectionId::kNodeIds);
+    node_lat_ = file_.section<double>(SectionId::kNodeLat);
+    node_lon_ = file_.section<double>(SectionId::kNodeLon);
+
+    way_ids_ = file_.section<std::int64_t>(SectionId::kWayIds);
+    way_categories_ = file_.section<std::uint8_t>(SectionId::kWayCategories);
+    way_flags_ = file_.section<std::uint8_t>(SectionId::kWayFlags);
+    way_speeds_ = file_.section<float>(SectionId::kWaySpeeds);
+    way_names_ = file_.section<std::uint32_t>(SectionId::kWayNames);
+    way_node_offsets_ = file_.section<std::uint64_t>(SectionId::kWayNodeOffsets);
+    way_nodes_ = file_.section<std::uint32_t>(SectionId::kWayNodes);
+    way_lengths_ = file_.section<double>(SectionId::kWayLengths);
+
+    string_offsets_ = file_.section<std::uint64_t>(SectionId::kStringOffsets);
+    string_data_ = file_.section<char>(SectionId::kStringData);
+
+    intersection_nodes_ = file_.section<std::uint32_t>(SectionId::kIntersectionNodes);
+    intersection_segment_offsets_ = file_.section<std::uint32_t>(SectionId::kIntersectionSegmentOffsets);
+    intersection_segments_ = file_.section<std::int32_t>(SectionId::kIntersectionSegments);
+    intersection_adjacent_ = file_.section<std::int32_t>(SectionId::kIntersectionAdjacent);
+    routing_edge_offsets_ = file_.section<std::uint32_t>(SectionId::kRoutingEdgeOffsets);
+    routing_edges_ = file_.section<converter::RoutingEdge>(SectionId::kRoutingEdges);
+    ch_ranks_ = file_.section<std::uint32_t>(SectionId::kChRanks);
+    ch_up_edge_offsets_ = file_.section<std::uint32_t>(SectionId::kChUpEdgeOffsets);
+    ch_up_edges_ = file_.section<converter::ChEdge>(SectionId::kChUpEdges);
+    ch_down_edge_offsets_ = file_.section<std::uint32_t>(SectionId::kChDownEdgeOffsets);
+    ch_down_edges_ = file_.section<converter::ChEdge>(SectionId::kChDownEdges);
+    cch_ranks_ = file_.section<std::uint32_t>(SectionId::kCchRanks);
+    cch_arc_offsets_ = file_.section<std::uint32_t>(SectionId::kCchArcOffsets);
+    cch_arcs_ = file_.section<std::int32_t>(SectionId::kCchArcs);
+    cch_edge_arcs_ = file_.section<std::uint32_t>(SectionId::kCchEdgeArcs);
+
+    segment_ways_ = file_.section<std::uint32_t>(SectionId::kSegmentWays);
+    segment_from_ = file_.section<std::int32_t>(SectionId::kSegmentFrom);
+    segment_to_ = file_.section<std::int32_t>(SectionId::kSegmentTo);
+    segment_streets_ = file_.section<std::int32_t>(SectionId::kSegmentStreets);
+    segment_flags_ = file_.section<std::uint8_t>(SectionId::kSegmentFlags);
+    segment_speeds_ = file_.section<float>(SectionId::kSegmentSpeeds);
+    segment_lengths_ = file_.section<double>(SectionId::kSegmentLengths);
+    segment_travel_times_ = file_.section<double>(SectionId::kSegmentTravelTimes);
+    segment_curve_offsets_ = file_.section<std::uint64_t>(SectionId::kSegmentCurveOffsets);
+    curve_nodes_ = file_.section<std::uint32_t>(SectionId::kCurveNodes);
+
+    street_names_ = file_.section<std::uint32_t>(SectionId::kStreetNames);
+    street_keys_ = file_.section<std::uint32_t>(SectionId::kStreetKeys);
+    streets_by_key_ = file_.section<std::int32_t>(SectionId::kStreetsByKey);
+    street_lengths_ = file_.section<double>(SectionId::kStreetLengths);
+    street_segment_offsets_ = file_.section<std::uint32_t>(SectionId::kStreetSegmentOffsets);
+    street_segments_ = file_.section<std::int32_t>(SectionId::kStreetSegments);
+    street_intersection_offsets_ = file_.section<std::uint32_t>(SectionId::kStreetIntersectionOffsets);
+    street_intersections_ = file_.section<std::int32_t>(SectionId::kStreetIntersections);
+
+    // Only the shape of the tables is checked here, which is O(1); the index values inside them
+    // are trusted to be what osm_converter wrote, as the header and file size already matched
+    if (node_ids_.size() > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max())) {
+        throw std::runtime_error(path.string() + " has too many nodes");
+    }
+    require_count(summary_.size(), 1, "summary");
+    require_count(node_lat_.size(), node_count(), "node latitudes");
+    require_count(node_lon_.size(), node_count(), "node longitudes");
+
+    require_count(way_categories_.size(), way_count(), "way categories");
+    require_count(way_flags_.size(), way_count(), "way flags");
+    require_count(way_speeds_.size(), way_count(), "way speeds");
+    require_count(way_names_.size(), way_count(), "way names");
+    require_offsets(way_node_offsets_, way_count(), way_nodes_.size(), "way node offsets");
+    require_count(way_lengths_.size(), way_count(), "way lengths");
+    if (string_offsets_.empty()) {
+        throw std::runtime_error(path.string() + " has no string table");
+    }
+    require_offsets(string_offsets_, string_offsets_.size() - 1, string_data_.size(), "string offsets");
+
+    require_offsets(intersection_segment_offsets_, intersection_count(), intersection_segments_.size(),
+                    "intersection segment offsets");
+    require_count(intersection_adjacent_.size(), intersection_segments_.size(), "intersection adjacency");
+    require_offsets(routing_edge_offsets_, intersection_count(), routing_edges_.size(), "routing edge offsets");
+    // the hierarchy is optional (osm_converter --no-contraction writes its sections empty)
+    if (has_contraction_hierarchy()) {
+        require_count(ch_ranks_.size(), intersection_count(), "contraction ranks");
+        require_offsets(ch_up_edge_offsets_, intersection_count(), ch_up_edges_.size(),
+                        "contraction up edge offsets");
+        require_offsets(ch_down_edge_offsets_, intersection_count(), ch_down_edges_.size(),
+                        "contraction down edge offsets");
+    }
+    if (has_customizable_hierarchy()) {
+        require_count(cch_ranks_.size(), intersection_count(), "customizable ranks");
+        require_offsets(cch_arc_offsets_, intersection_count(), cch_arcs_.size(), "customizable arc offsets");
+        require_count(cch_edge_arcs_.size(), routing_edge_count(), "customizable edge arcs");
+    }
+
+    require_count(segment_ways_.size(), segment_count(), "segment ways");
+    require_count(segment_to_.size(), segment_count(), "segment ends");
+    require_count(segment_streets_.size(), segment_count(), "segment streets");
+    require_count(segment_flags_.size(), segment_count(), "segment flags");
+    require_count(segment_speeds_.size(), segment_count(), "segment speeds");
+    require_count(segment_lengths_.size(), segment_count(), "segment lengths");
+    require_count(segment_travel_times_.size(), segment_count(), "segment travel times");
+    require_offsets(segment_curve_offsets_, segment_count(), curve_nodes_.size(), "segment curve offsets");
+
+    require_count(street_keys_.size(), street_count(), "street keys");
+    require_count(streets_by_key_.size(), street_count(), "street key order");
+    require_count(street_lengths_.size(), street_count(), "street lengths");
+    require_offsets(street_segment_offsets_, street_count(), street_segments_.size(), "street segment offsets");
+    require_offsets(street_intersection_offsets_, street_count(), street_intersections_.size(),
+                    "street intersection offsets");
+}
+
+// Lower bound without a data-dependent branch: the loop runs log2(n) times whatever the id, and
+// the compiler turns the halving step into a conditional move
+std::size_t StreetsStore::find_id(std::span<const std::int64_t> ids, std::int64_t id) {
+    if (ids.empty()) {
+        return kNotFound;
+    }
+    const std::int64_t* base = ids.data();
+    std::size_t length = ids.size();
+    while (length > 1) {
+        const std::size_t half = length / 2;
+        base = base[half] <= id ? base + half : base;
+        length -= half;
+    }
+    return *base == id ? static_cast<std::size_t>(base - ids.data()) : kNotFound;
+}
+
+void OsmStore::open(const std::filesystem::path& path) {
+    close();
+    file_ = MappedFile(path);
+
+    ByteCursor cursor(file_.data(), file_.size());
+    check_header(cursor, converter::kOsmMagic, converter::kOsmSchemaVersion, path);
+    content_hash_ = cursor.read<std::uint64_t>();
+    const auto poi_count = cursor.read<std::uint64_t>();
+
+    poi_offsets_.reserve(poi_count);
+    for (std::uint64_t i = 0; i < poi_count; ++i) {
+        poi_offsets_.push_back(cursor.position());
+        cursor.skip(sizeof(std::int64_t) + 2 * sizeof(double));
+        cursor.read_string();
+        cursor.read_string();
+    }
+}
+
+void OsmStore::close() {
+    file_.close();
+    content_hash_ = 0;
+    poi_offsets_ = {};
+}
+
+PoiRecord OsmStore::poi(std::size_t poi) const {
+    ByteCursor cursor(file_.data() + poi_offsets_[poi], file_.size() - poi_offsets_[poi]);
+    PoiRecord record;
+    record.id = cursor.read<std::int64_t>();
+    const auto lat = cursor.read<double>();
+    const auto lon = cursor.read<double>();
+    record.position = LatLon(lat, lon);
+    record.category = cursor.read_string();
+    record.name = cursor.read_string();
+    return record;
+}
+
+void SpeedProfiles::open(const std::filesystem::path& path, const StreetsStore& streets) {
+    close();
+    file_.open(path, converter::kSpeedProfilesMagic, converter::kSpeedProfilesSchemaVersion);
+    const auto streets_hash = file_.section<std::uint64_t>(SectionId::kProfileStreetsHash);
+    if (streets_hash.size() != 1 || streets_hash[0] != streets.content_hash()) {
+        throw std::runtime_error(path.string() + " was written for another version of the streets.bin");
+    }
+    breakpoint_offsets_ = file_.section<std::uint32_t>(SectionId::kProfileBreakpointOffsets);
+    breakpoints_ = file_.section<converter::SpeedBreakpoint>(SectionId::kProfileBreakpoints);
+    segment_profiles_ = file_.section<std::uint16_t>(SectionId::kSegmentProfiles);
+
+    require_count(segment_profiles_.size(), streets.segment_count(), "segment profiles");
+    if (breakpoint_offsets_.empty()) {
+        throw std::runtime_error("profile breakpoint offsets are empty");
+    }
+    const std::size_t profile_count = breakpoint_offsets_.size() - 1;
+    require_offsets(breakpoint_offsets_, profile_count, breakpoints_.size(), "profile breakpoint offsets");
+    for (const std::uint16_t profile : segment_profiles_) {
+        if (profile >= profile_count || (profile != converter::kFreeFlowProfile &&
+                                         breakpoint_offsets_[profile] == breakpoint_offsets_[profile + 1])) {
+            throw std::runtime_error("segment profile " + std::to_string(profile) + " does not exist");
+        }
+    }
+    for (const converter::SpeedBreakpoint& corner : breakpoints_) {
+        if (corner.minute >= converter::kMinutesPerWeek || corner.speed_permille == 0 ||
+            corner.speed_permille > 1000) {
+            throw std::runtime_error("profile breakpoint out of range");
+        }
+    }
+}
+
+void SpeedProfiles::close() {
+    file_.close();
+    *this = SpeedProfiles();
+}
+
+double SpeedProfiles::speed_factor(std::size_t segment, double time) const {
+    const std::uint16_t profile = segment_profiles_[segment];
+    const converter::SpeedBreakpoint* first = breakpoints_.data() + breakpoint_offsets_[profile];
+    const converter::SpeedBreakpoint* last = breakpoints_.data() + breakpoint_offsets_[profile + 1];
+    if (first == last) {
+        return 1.0;
+    }
+
+    double minute = std::fmod(time, kSecondsPerWeek) / 60;
+    if (minute < 0) {
+        minute += converter::kMinutesPerWeek;
+    }
+    // the corners around `minute`, wrapping from the last of the week to the first
+    const converter::SpeedBreakpoint* next = std::upper_bound(
+        first, last, minute, [](double at, const converter::SpeedBreakpoint& corner) { return at < corner.minute; });
+    const converter::SpeedBreakpoint& after = next == last ? *first : *next;
+    const converter::SpeedBreakpoint& before = next == first ? *(last - 1) : *(next - 1);
+    double span = static_cast<double>(after.minute) - before.minute;
+    double into = minute - before.minute;
+    if (span <= 0) {
+        span += converter::kMinutesPerWeek;
+    }
+    if (into < 0) {
+        into += converter::kMinutesPerWeek;
+    }
+    const double permille = before.speed_permille + (after.speed_permille - before.speed_permille) * (into / span);
+    return permille / 1000;
+}
+
+std::filesystem::path speed_profiles_path(const std::filesystem::path& streets_path) {
+    std::string name = streets_path.filename().string();
+    constexpr std::string_view kSuffix = ".streets.bin";
+    if (name.size() > kSuffix.size() && name.compare(name.size() - kSuffix.size(), kSuffix.size(), kSuffix) == 0) {
+        name.resize(name.size() - kSuffix.size());
+    }
+    return streets_path.parent_path() / (name + ".speeds.bin");
+}
+
+StreetsStore& streets_store() {
+    static StreetsStore store;
+    return store;
+}
+
+OsmStore& osm_store() {
+    static OsmStore store;
+    return store;
+}
+
+SpeedProfiles& speed_profiles() {
+    static SpeedProfiles profiles;
+    return profiles;
+}
+
+}  // namespace gisevo::map_data
@@ -0,0 +1,282 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "converter/schema.hpp"
+#include "../LatLon.h"
+#include "../OSMID.h"
+#include "mapped_file.hpp"
+#include "section_file.hpp"
+
+namespace gisevo::map_data {
+
+using converter::HighwayCategory;
+
+/*
+ * The streets.bin mapping
+ * Every table, including the intersection graph and the per-street lists, is precomputed by
+ * osm_converter and read in place as a typed span, so opening a map does no per-element work.
+ */
+class StreetsStore {
+public:
+    static constexpr std::size_t kNotFound = static_cast<std::size_t>(-1);
+
+    // Throws std::runtime_error on a missing, truncated or mismatched file
+    void open(const std::filesystem::path& path);
+    void close();
+    bool is_open() const { return file_.is_open(); }
+    // Hash of the sections, written by the converter
+    std::uint64_t content_hash() const { return file_.content_hash(); }
+
+    const converter::NetworkSummary& summary() const { return summary_[0]; }
+
+    std::size_t node_count() const { return node_ids_.size(); }
+    OSMID node_id(std::size_t node) const { return node_ids_[node]; }
+    LatLon node_position(std::size_t node) const { return LatLon(node_lat_[node], node_lon_[node]); }
+    // OSMNode views point at their id inside the mapping
+    const std::int64_t* node_anchor(std::size_t node) const { return &node_ids_[node]; }
+    std::size_t node_index(const std::int64_t* anchor) const {
+        return static_cast<std::size_t>(anchor - node_ids_.data());
+    }
+    // Index of the node with the given OSM id, or kNotFound
+    std::size_t find_node(OSMID id) const { return find_id(node_ids_, id); }
+
+    std::size_t way_count() const { return way_ids_.size(); }
+    OSMID way_id(std::size_t way) const { return way_ids_[way]; }
+    HighwayCategory way_category(std::size_t way) const { return static_cast<HighwayCategory>(way_categories_[way]); }
+    bool way_one_way(std::size_t way) const { return (way_flags_[way] & converter::kWayFlagOneWay) != 0; }
+    float way_speed_kph(std::size_t way) const { return way_speeds_[way]; }
+    std::string_view way_name(std::size_t way) const { return string(way_names_[way]); }
+    std::span<const std::uint32_t> way_nodes(std::size_t way) const {
+        return way_nodes_.subspan(way_node_offsets_[way], way_node_offsets_[way + 1] - way_node_offsets_[way]);
+    }
+    // OSMWay views point at their id inside the mapping
+    const std::int64_t* way_anchor(std::size_t way) const { return &way_ids_[way]; }
+    std::size_t way_index(const std::int64_t* anchor) const {
+        return static_cast<std::size_t>(anchor - way_ids_.data());
+    }
+    // Index of the way with the given OSM id, or kNotFound
+    std::size_t find_way(OSMID id) const { return find_id(way_ids_, id); }
+    double way_length(std::size_t way) const { return way_lengths_[way]; }
+
+    std::size_t intersection_count() const { return intersection_nodes_.size(); }
+    std::uint32_t intersection_node(std::size_t intersection) const { return intersection_nodes_[intersection]; }
+    std::span<const std::int32_t> intersection_segments(std::size_t intersection) const {
+        return run(intersection_segments_, intersection_segment_offsets_, intersection);
+    }
+    // The intersection across each entry of intersection_segments()
+    std::span<const std::int32_t> intersection_adjacent(std::size_t intersection) const {
+        return run(intersection_adjacent_, intersection_segment_offsets_, intersection);
+    }
+    // The edges a search can leave the intersection along, with everything needed to relax them
+    std::span<const converter::RoutingEdge> outgoing_edges(std::size_t intersection) const {
+        return run(routing_edges_, routing_edge_offsets_, intersection);
+    }
+    // The same edges addressed by their index in the routing edge table, which edge-based searches
+    // use as their state: the edges that can follow edge k are those leaving routing_edge(k).to
+    std::size_t routing_edge_count() const { return routing_edges_.size(); }
+    std::uint32_t routing_edge_begin(std::size_t intersection) const { return routing_edge_offsets_[intersection]; }
+    std::uint32_t routing_edge_end(std::size_t intersection) const { return routing_edge_offsets_[intersection + 1]; }
+    const converter::RoutingEdge& routing_edge(std::size_t edge) const { return routing_edges_[edge]; }
+
+    // Contraction hierarchy (see converter/contraction.hpp). Edges are addressed by their index
+    // so a search can record them as parents and unpack shortcuts afterwards. Maps converted
+    // with --no-contraction have none.
+    bool has_contraction_hierarchy() const { return !ch_ranks_.empty(); }
+    std::uint32_t ch_rank(std::size_t intersection) const { return ch_ranks_[intersection]; }
+    std::uint32_t ch_up_begin(std::size_t intersection) const { return ch_up_edge_offsets_[intersection]; }
+    std::uint32_t ch_up_end(std::size_t intersection) const { return ch_up_edge_offsets_[intersection + 1]; }
+    const converter::ChEdge& ch_up_edge(std::size_t edge) const { return ch_up_edges_[edge]; }
+    std::uint32_t ch_down_begin(std::size_t intersection) const { return ch_down_edge_offsets_[intersection]; }
+    std::uint32_t ch_down_end(std::size_t intersection) const { return ch_down_edge_offsets_[intersection + 1]; }
+    const converter::ChEdge& ch_down_edge(std::size_t edge) const { return ch_down_edges_[edge]; }
+
+    // Customizable hierarchy (see converter/customizable.hpp). Each arc joins two intersections
+    // and is stored at its lower ranked end, ordered by the rank of the other end; every routing
+    // edge lies along one arc. Maps converted with --no-contraction have none.
+    bool has_customizable_hierarchy() const { return !cch_ranks_.empty(); }
+    std::uint32_t cch_rank(std::size_t intersection) const { return cch_ranks_[intersection]; }
+    std::size_t cch_arc_count() const { return cch_arcs_.size(); }
+    std::uint32_t cch_arc_begin(std::size_t intersection) const { return cch_arc_offsets_[intersection]; }
+    std::uint32_t cch_arc_end(std::size_t intersection) const { return cch_arc_offsets_[intersection + 1]; }
+    std::int32_t cch_arc(std::size_t arc) const { return cch_arcs_[arc]; }
+    std::uint32_t cch_edge_arc(std::size_t edge) const { return cch_edge_arcs_[edge]; }
+
+    std::size_t segment_count() const { return segment_from_.size(); }
+    OSMID segment_way_id(std::size_t segment) const { return way_ids_[segment_ways_[segment]]; }
+    HighwayCategory segment_category(std::size_t segment) const { return way_category(segment_ways_[segment]); }
+    std::int32_t segment_from(std::size_t segment) const { return segment_from_[segment]; }
+    std::int32_t segment_to(std::size_t segment) const { return segment_to_[segment]; }
+    std::int32_t segment_street(std::size_t segment) const { return segment_streets_[segment]; }
+    bool segment_one_way(std::size_t segment) const {
+        return (segment_flags_[segment] & converter::kWayFlagOneWay) != 0;
+    }
+    float segment_speed(std::size_t segment) const { return segment_speeds_[segment]; }
+    double segment_length(std::size_t segment) const { return segment_lengths_[segment]; }
+    double segment_travel_time(std::size_t segment) const { return segment_travel_times_[segment]; }
+    std::span<const std::uint32_t> segment_curve_nodes(std::size_t segment) const {
+        return curve_nodes_.subspan(segment_curve_offsets_[segment],
+                                    segment_curve_offsets_[segment + 1] - segment_curve_offsets_[segment]);
+    }
+
+    std::size_t street_count() const { return street_names_.size(); }
+    std::string_view street_name(std::size_t street) const { return string(street_names_[street]); }
+    std::string_view street_key(std::size_t street) const { return string(street_keys_[street]); }
+    std::span<const std::int32_t> streets_by_key() const { return streets_by_key_; }
+    double street_length(std::size_t street) const { return street_lengths_[street]; }
+    std::span<const std::int32_t> street_segments(std::size_t street) const {
+        return run(street_segments_, street_segment_offsets_, street);
+    }
+    std::span<const std::int32_t> street_intersections(std::size_t street) const {
+        return run(street_intersections_, street_intersection_offsets_, street);
+    }
+
+private:
+    // The id sections are sorted, so lookups are a search over the mapped array; no per-map
+    // hash table has to be built at load
+    static std::size_t find_id(std::span<const std::int64_t> ids, std::int64_t id);
+    template <typename T, typename Offset>
+    static std::span<const T> run(std::span<const T> values, std::span<const Offset> offsets, std::size_t i) {
+        return values.subspan(offsets[i], offsets[i + 1] - offsets[i]);
+    }
+    std::string_view string(std::uint32_t index) const {
+        return {string_data_.data() + string_offsets_[index], string_offsets_[index + 1] - string_offsets_[index]};
+    }
+    void map_sections(const std::filesystem::path& path);
+
+    SectionFile file_;
+    std::span<const converter::NetworkSummary> summary_;
+
+    std::span<const std::int64_t> node_ids_;
+    std::span<const double> node_lat_;
+    std::span<const double> node_lon_;
+
+    std::span<const std::int64_t> way_ids_;
+    std::span<const std::uint8_t> way_categories_;
+    std::span<const std::uint8_t> way_flags_;
+    std::span<const float> way_speeds_;
+    std::span<const std::uint32_t> way_names_;
+    std::span<const std::uint64_t> way_node_offsets_;
+    std::span<const std::uint32_t> way_nodes_;
+    std::span<const double> way_lengths_;
+
+    std::span<const std::uint64_t> string_offsets_;
+    std::span<const char> string_data_;
+
+    std::span<const std::uint32_t> intersection_nodes_;
+    std::span<const std::uint32_t> intersection_segment_offsets_;
+    std::span<const std::int32_t> intersection_segments_;
+    std::span<const std::int32_t> intersection_adjacent_;
+    std::span<const std::uint32_t> routing_edge_offsets_;
+    std::span<const converter::RoutingEdge> routing_edges_;
+
+    std::span<const std::uint32_t> ch_ranks_;
+    std::span<const std::uint32_t> ch_up_edge_offsets_;
+    std::span<const converter::ChEdge> ch_up_edges_;
+    std::span<const std::uint32_t> ch_down_edge_offsets_;
+    std::span<const converter::ChEdge> ch_down_edges_;
+
+    std::span<const std::uint32_t> cch_ranks_;
+    std::span<const std::uint32_t> cch_arc_offsets_;
+    std::span<const std::int32_t> cch_arcs_;
+    std::span<const std::uint32_t> cch_edge_arcs_;
+
+    std::span<const std::uint32_t> segment_ways_;
+    std::span<const std::int32_t> segment_from_;
+    std::span<const std::int32_t> segment_to_;
+    std::span<const std::int32_t> segment_streets_;
+    std::span<const std::uint8_t> segment_flags_;
+    std::span<const float> segment_speeds_;
+    std::span<const double> segment_lengths_;
+    std::span<const double> segment_travel_times_;
+    std::span<const std::uint64_t> segment_curve_offsets_;
+    std::span<const std::uint32_t> curve_nodes_;
+
+    std::span<const std::uint32_t> street_names_;
+    std::span<const std::uint32_t> street_keys_;
+    std::span<const std::int32_t> streets_by_key_;
+    std::span<const double> street_lengths_;
+    std::span<const std::uint32_t> street_segment_offsets_;
+    std::span<const std::int32_t> street_segments_;
+    std::span<const std::uint32_t> street_intersection_offsets_;
+    std::span<const std::int32_t> street_intersections_;
+};
+
+// Decoded POI record; strings point into the mapping
+struct PoiRecord {
+    OSMID id;
+    LatLon position;
+    std::string_view category;  // "<key>:<value>", e.g. "amenity:cafe"
+    std::string_view name;
+};
+
+/*
+ * The osm.bin mapping, which holds the points of interest
+ */
+class OsmStore {
+public:
+    // Throws std::runtime_error on a missing, truncated or mismatched file
+    void open(const std::filesystem::path& path);
+    void close();
+    bool is_open() const { return file_.is_open(); }
+    // Hash of the records, written by the converter; 0 while closed
+    std::uint64_t content_hash() const { return content_hash_; }
+
+    std::size_t poi_count() const { return poi_offsets_.size(); }
+    PoiRecord poi(std::size_t poi) const;
+
+private:
+    MappedFile file_;
+    std::uint64_t content_hash_ = 0;
+    std::vector<std::uint64_t> poi_offsets_;
+};
+
+/*
+ * The optional <map>.speeds.bin mapping (osm_converter --speed-profiles)
+ * Street segments share a few weekly profiles, each a handful of 4-byte corners, so the file is
+ * two bytes per segment plus the profiles. Speeds never exceed the speed limit, so a travel time
+ * is never below the one in streets.bin, which keeps the routing bounds valid.
+ */
+class SpeedProfiles {
+public:
+    static constexpr double kSecondsPerWeek = converter::kMinutesPerWeek * 60.0;
+
+    // Throws std::runtime_error on a missing, truncated or mismatched file, or one written for
+    // another streets.bin (told by its content hash) than the open `streets`
+    void open(const std::filesystem::path& path, const StreetsStore& streets);
+    void close();
+    bool is_open() const { return file_.is_open(); }
+
+    // Fraction of its speed limit the segment is driven at, `time` seconds after Monday 00:00
+    // (taken modulo a week)
+    double speed_factor(std::size_t segment, double time) const;
+
+    // Seconds to drive the segment when entering it at `time`, given its time at the speed limit
+    double travel_time(std::size_t segment, double free_flow_time, double time) const {
+        return segment_profiles_[segment] == converter::kFreeFlowProfile
+                   ? free_flow_time
+                   : free_flow_time / speed_factor(segment, time);
+    }
+
+private:
+    SectionFile file_;
+    std::span<const std::uint32_t> breakpoint_offsets_;
+    std::span<const converter::SpeedBreakpoint> breakpoints_;
+    std::span<const std::uint16_t> segment_profiles_;
+};
+
+// "<map>.streets.bin" -> "<map>.speeds.bin", next to the map
+std::filesystem::path speed_profiles_path(const std::filesystem::path& streets_path);
+
+// The map currently opened through the StreetsDatabaseAPI/OSMDatabaseAPI functions
+StreetsStore& streets_store();
+OsmStore& osm_store();
+// Open only while the map has a speeds.bin
+SpeedProfiles& speed_profiles();
+
+}  // namespace gisevo::map_data
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace gisevo::map_data {
+
+/*
+ * Read-only, shared memory mapping of a whole file
+ * Pages are only read from disk when first touched and are shared with every other
+ * process mapping the same file. Throws std::runtime_error if the file cannot be mapped.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    const std::byte* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    bool is_open() const { return data_ != nullptr; }
+
+    void close();
+
+private:
+    const std::byte* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+// Reads a trivially copyable value from a possibly unaligned address inside a mapping
+template <typename T>
+T load_pod(const std::byte* address) {
+    T value;
+    std::memcpy(&value, address, sizeof(T));
+    return value;
+}
+
+/*
+ * Bounds-checked forward reader over a mapped file, used to walk the record headers
+ * Throws std::runtime_error if a read would run past the end of the file
+ */
+class ByteCursor {
+public:
+    ByteCursor(const std::byte* begin, std::size_t size) : begin_(begin), size_(size) {}
+
+    std::size_t position() const { return position_; }
+    const std::byte* current() const { return begin_ + position_; }
+
+    template <typename T>
+    T read() {
+        require(sizeof(T));
+        T value = load_pod<T>(current());
+        position_ += sizeof(T);
+        return value;
+    }
+
+    // Reads a u32 length followed by that many bytes, as written by write_string()
+    std::string_view read_string() {
+        const auto length = read<std::uint32_t>();
+        require(length);
+        std::string_view value(reinterpret_cast<const char*>(current()), length);
+        position_ += length;
+        return value;
+    }
+
+    void skip(std::size_t bytes) {
+        require(bytes);
+        position_ += bytes;
+    }
+
+private:
+    void require(std::size_t bytes) const {
+        if (bytes > size_ - position_) {
+            throw std::runtime_error("unexpected end of file at byte " + std::to_string(position_));
+        }
+    }
+
+    const std::byte* begin_;
+    std::size_t size_;
+    std::size_t position_ = 0;
+};
+
+}  // namespace gisevo::map_data
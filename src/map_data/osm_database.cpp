@@ -0,0 +1,164 @@
+#include "../OSMDatabaseAPI.h"
+#include "map_store.hpp"
+
+#include <exception>
+#include <iostream>
+#include <string>
+
+using gisevo::map_data::osm_store;
+using gisevo::map_data::streets_store;
+
+namespace {
+
+// Entity views are anchored at their id inside the mapped id section
+const std::int64_t* anchor_of(const OSMEntity* entity) {
+    return reinterpret_cast<const std::int64_t*>(entity);
+}
+
+std::size_t node_index(const OSMNode* node) {
+    return streets_store().node_index(anchor_of(node));
+}
+
+std::size_t way_index(const OSMWay* way) {
+    return streets_store().way_index(anchor_of(way));
+}
+
+std::string format_speed(float speed_kph) {
+    std::string value = std::to_string(speed_kph);
+    value.erase(value.find_last_not_of('0') + 1);
+    if (value.back() == '.') {
+        value.pop_back();
+    }
+    return value;
+}
+
+}  // namespace
+
+OSMID OSMNode::id() const {
+    return *anchor_of(this);
+}
+
+LatLon OSMNode::coords() const {
+    return streets_store().node_position(node_index(this));
+}
+
+OSMID OSMWay::id() const {
+    return *anchor_of(this);
+}
+
+bool OSMWay::isClosed() const {
+    const auto nodes = streets_store().way_nodes(way_index(this));
+    return nodes.size() > 2 && nodes.front() == nodes.back();
+}
+
+OSMID OSMRelation::id() const {
+    return *anchor_of(this);
+}
+
+bool loadOSMDatabaseBIN(const std::string& map_osm_database_filename) {
+    try {
+        osm_store().open(map_osm_database_filename);
+    } catch (const std::exception& ex) {
+        std::cerr << "[map_data] Failed to load OSM database: " << ex.what() << std::endl;
+        osm_store().close();
+        return false;
+    }
+    return true;
+}
+
+void closeOSMDatabase() {
+    osm_store().close();
+}
+
+int getNumberOfNodes() {
+    return static_cast<int>(streets_store().node_count());
+}
+
+int getNumberOfWays() {
+    return static_cast<int>(streets_store().way_count());
+}
+
+// The converter does not emit relations yet
+int getNumberOfRelations() {
+    return 0;
+}
+
+const OSMNode* getNodeByIndex(int idx) {
+    return reinterpret_cast<const OSMNode*>(streets_store().node_anchor(idx));
+}
+
+const OSMWay* getWayByIndex(int idx) {
+    return reinterpret_cast<const OSMWay*>(streets_store().way_anchor(idx));
+}
+
+const OSMRelation* getRelationByIndex(int /*idx*/) {
+    return nullptr;
+}
+
+int getTagCount(const OSMNode* /*node*/) {
+    return 0;
+}
+
+// Ways always carry highway=*, followed by name=*, maxspeed=* and oneway=yes when the converter recorded them
+int getTagCount(const OSMWay* way) {
+    const auto& store = streets_store();
+    const std::size_t w = way_index(way);
+    return 1 + (store.way_name(w).empty() ? 0 : 1) + (store.way_speed_kph(w) > 0.0F ? 1 : 0) +
+           (store.way_one_way(w) ? 1 : 0);
+}
+
+int getTagCount(const OSMRelation* /*relation*/) {
+    return 0;
+}
+
+std::pair<std::string, std::string> getTagPair(const OSMNode* /*node*/, int /*tagIdx*/) {
+    return {};
+}
+
+std::pair<std::string, std::string> getTagPair(const OSMWay* way, int tagIdx) {
+    const auto& store = streets_store();
+    const std::size_t w = way_index(way);
+    if (tagIdx-- == 0) {
+        return {"highway", gisevo::converter::highway_category_name(store.way_category(w))};
+    }
+    if (!store.way_name(w).empty() && tagIdx-- == 0) {
+        return {"name", std::string(store.way_name(w))};
+    }
+    if (store.way_speed_kph(w) > 0.0F && tagIdx-- == 0) {
+        return {"maxspeed", format_speed(store.way_speed_kph(w))};
+    }
+    if (store.way_one_way(w) && tagIdx == 0) {
+        return {"oneway", "yes"};
+    }
+    return {};
+}
+
+std::pair<std::string, std::string> getTagPair(const OSMRelation* /*relation*/, int /*tagIdx*/) {
+    return {};
+}
+
+LatLon getNodeCoords(const OSMNode* node) {
+    return node->coords();
+}
+
+std::vector<OSMID> getWayMembers(const OSMWay* way) {
+    const auto& store = streets_store();
+    const auto nodes = store.way_nodes(way_index(way));
+    std::vector<OSMID> members(nodes.size());
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        members[i] = store.node_id(nodes[i]);
+    }
+    return members;
+}
+
+bool isClosedWay(const OSMWay* way) {
+    return way->isClosed();
+}
+
+std::vector<TypedOSMID> getRelationMembers(const OSMRelation* /*relation*/) {
+    return {};
+}
+
+std::vector<std::string> getRelationMemberRoles(const OSMRelation* /*relation*/) {
+    return {};
+}
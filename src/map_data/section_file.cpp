@@ -0,0 +1,60 @@
+#include "section_file.hpp"
+
+#include <algorithm>
+
+namespace gisevo::map_data {
+
+void SectionFile::open(const std::filesystem::path& path, const char (&magic)[8], std::uint32_t version) {
+    close();
+    file_ = MappedFile(path);
+
+    ByteCursor cursor(file_.data(), file_.size());
+    const auto header = cursor.read<converter::FileHeader>();
+    if (!std::equal(std::begin(magic), std::end(magic), std::begin(header.magic))) {
+        throw std::runtime_error(path.string() + " is not an osm_converter output file");
+    }
+    if (header.version != version) {
+        throw std::runtime_error(path.string() + " has schema version " + std::to_string(header.version) +
+                                 ", expected " + std::to_string(version) +
+                                 "; rerun osm_converter with --force");
+    }
+    if (header.file_size != file_.size()) {
+        throw std::runtime_error(path.string() + " is " + std::to_string(file_.size()) +
+                                 " bytes but its header records " + std::to_string(header.file_size));
+    }
+
+    // checked before reserving, so a corrupt count cannot ask for a huge table
+    if (header.section_count > (file_.size() - sizeof(converter::FileHeader)) / sizeof(converter::SectionEntry)) {
+        throw std::runtime_error(path.string() + " is truncated: its header lists " +
+                                 std::to_string(header.section_count) + " sections");
+    }
+    content_hash_ = header.content_hash;
+    sections_.reserve(header.section_count);
+    for (std::uint32_t i = 0; i < header.section_count; ++i) {
+        const auto entry = cursor.read<converter::SectionEntry>();
+        const std::uint64_t available = entry.offset <= file_.size() ? file_.size() - entry.offset : 0;
+        if (entry.offset % converter::kSectionAlignment != 0 || entry.element_size == 0 ||
+            entry.count > available / entry.element_size) {
+            throw std::runtime_error(path.string() + " has a corrupt entry for section " +
+                                     std::to_string(entry.id));
+        }
+        sections_.push_back(entry);
+    }
+}
+
+void SectionFile::close() {
+    file_.close();
+    content_hash_ = 0;
+    sections_ = {};
+}
+
+const converter::SectionEntry* SectionFile::find(SectionId id) const {
+    for (const converter::SectionEntry& entry : sections_) {
+        if (entry.id == static_cast<std::uint32_t>(id)) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+}  // namespace gisevo::map_data
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "converter/schema.hpp"
+#include "mapped_file.hpp"
+
+namespace gisevo::map_data {
+
+using converter::SectionId;
+
+/*
+ * A mapped sectioned file as written by converter::SectionWriter
+ * open() validates the header and table of contents once; sections are then handed out
+ * as typed spans straight into the mapping. Every section starts on a 64-byte boundary of
+ * a page-aligned mapping, so the spans are correctly aligned for their element type.
+ */
+class SectionFile {
+public:
+    // Throws std::runtime_error on a missing, truncated or mismatched file
+    void open(const std::filesystem::path& path, const char (&magic)[8], std::uint32_t version);
+    void close();
+    bool is_open() const { return file_.is_open(); }
+    // FileHeader::content_hash, so a file can be identified without reading its sections
+    std::uint64_t content_hash() const { return content_hash_; }
+
+    bool has_section(SectionId id) const { return find(id) != nullptr; }
+
+    // Throws std::runtime_error if the section is missing or its element size does not match T
+    template <typename T>
+    std::span<const T> section(SectionId id) const {
+        const converter::SectionEntry* entry = find(id);
+        if (entry == nullptr) {
+            throw std::runtime_error("missing section " + std::to_string(static_cast<std::uint32_t>(id)));
+        }
+        if (entry->element_size != sizeof(T)) {
+            throw std::runtime_error("section " + std::to_string(entry->id) + " has element size " +
+                                     std::to_string(entry->element_size) + ", expected " +
+                                     std::to_string(sizeof(T)));
+        }
+        return {reinterpret_cast<const T*>(file_.data() + entry->offset), static_cast<std::size_t>(entry->count)};
+    }
+
+private:
+    const converter::SectionEntry* find(SectionId id) const;
+
+    MappedFile file_;
+    std::uint64_t content_hash_ = 0;
+    std::vector<converter::SectionEntry> sections_;
+};
+
+}  // namespace gisevo::map_data
@@ -0,0 +1,165 @@
+#include "../StreetsDatabaseAPI.h"
+#include "map_store.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+using gisevo::map_data::osm_store;
+using gisevo::map_data::speed_profiles;
+using gisevo::map_data::streets_store;
+
+bool loadStreetsDatabaseBIN(const std::string& map_streets_database_filename) {
+    try {
+        streets_store().open(map_streets_database_filename);
+    } catch (const std::exception& ex) {
+        std::cerr << "[map_data] Failed to load streets database: " << ex.what() << std::endl;
+        streets_store().close();
+        return false;
+    }
+
+    // Speed profiles are optional; without them (or with a stale file) departure time routing
+    // uses the speed limits
+    speed_profiles().close();
+    const std::filesystem::path profiles_path = gisevo::map_data::speed_profiles_path(map_streets_database_filename);
+    std::error_code error;
+    if (std::filesystem::exists(profiles_path, error)) {
+        try {
+            speed_profiles().open(profiles_path, streets_store());
+        } catch (const std::exception& ex) {
+            std::cerr << "[map_data] Ignoring speed profiles: " << ex.what()
+                      << "; rerun osm_converter with --speed-profiles" << std::endl;
+            speed_profiles().close();
+        }
+    }
+    return true;
+}
+
+void closeStreetDatabase() {
+    speed_profiles().close();
+    streets_store().close();
+}
+
+int getNumIntersections() {
+    return static_cast<int>(streets_store().intersection_count());
+}
+
+int getNumStreetSegments() {
+    return static_cast<int>(streets_store().segment_count());
+}
+
+int getNumStreets() {
+    return static_cast<int>(streets_store().street_count());
+}
+
+int getNumPointsOfInterest() {
+    return static_cast<int>(osm_store().poi_count());
+}
+
+int getNumFeatures() {
+    return 0;
+}
+
+// Intersections are named after the distinct streets that meet there, e.g. "King Street & Bay Street"
+std::string getIntersectionName(IntersectionIdx intersectionIdx) {
+    const auto& store = streets_store();
+    std::vector<std::string_view> names;
+    for (const std::int32_t segment : store.intersection_segments(intersectionIdx)) {
+        const std::int32_t street = store.segment_street(segment);
+        const std::string_view name = store.street_name(street);
+        if (street != 0 && std::find(names.begin(), names.end(), name) == names.end()) {
+            names.push_back(name);
+        }
+    }
+    if (names.empty()) {
+        return std::string(store.street_name(0));
+    }
+    std::string result(names[0]);
+    for (std::size_t i = 1; i < names.size(); ++i) {
+        result += " & ";
+        result += names[i];
+    }
+    return result;
+}
+
+LatLon getIntersectionPosition(IntersectionIdx intersectionIdx) {
+    const auto& store = streets_store();
+    return store.node_position(store.intersection_node(intersectionIdx));
+}
+
+OSMID getIntersectionOSMNodeID(IntersectionIdx intersectionIdx) {
+    const auto& store = streets_store();
+    return store.node_id(store.intersection_node(intersectionIdx));
+}
+
+int getNumIntersectionStreetSegment(IntersectionIdx intersectionIdx) {
+    return static_cast<int>(streets_store().intersection_segments(intersectionIdx).size());
+}
+
+StreetSegmentIdx getIntersectionStreetSegment(int streetSegmentNum, IntersectionIdx intersectionIdx) {
+    return streets_store().intersection_segments(intersectionIdx)[streetSegmentNum];
+}
+
+StreetSegmentInfo getStreetSegmentInfo(StreetSegmentIdx streetSegmentIdx) {
+    const auto& store = streets_store();
+    StreetSegmentInfo info;
+    info.wayOSMID = store.segment_way_id(streetSegmentIdx);
+    info.from = store.segment_from(streetSegmentIdx);
+    info.to = store.segment_to(streetSegmentIdx);
+    info.oneWay = store.segment_one_way(streetSegmentIdx);
+    info.numCurvePoints = static_cast<int>(store.segment_curve_nodes(streetSegmentIdx).size());
+    info.speedLimit = store.segment_speed(streetSegmentIdx);
+    info.streetID = store.segment_street(streetSegmentIdx);
+    return info;
+}
+
+LatLon getStreetSegmentCurvePoint(int curvePointNum, StreetSegmentIdx streetSegmentIdx) {
+    const auto& store = streets_store();
+    return store.node_position(store.segment_curve_nodes(streetSegmentIdx)[curvePointNum]);
+}
+
+std::string getStreetName(StreetIdx streetIdx) {
+    return std::string(streets_store().street_name(streetIdx));
+}
+
+// POI categories are stored as "<key>:<value>"; the value is the type the rest of the code matches on
+std::string getPOIType(POIIdx poiIdx) {
+    const std::string_view category = osm_store().poi(poiIdx).category;
+    const std::size_t colon = category.find(':');
+    return std::string(colon == std::string_view::npos ? category : category.substr(colon + 1));
+}
+
+std::string getPOIName(POIIdx poiIdx) {
+    return std::string(osm_store().poi(poiIdx).name);
+}
+
+LatLon getPOIPosition(POIIdx poiIdx) {
+    return osm_store().poi(poiIdx).position;
+}
+
+OSMID getPOIOSMNodeID(POIIdx poiIdx) {
+    return osm_store().poi(poiIdx).id;
+}
+
+std::string getFeatureName(FeatureIdx /*featureIdx*/) {
+    return {};
+}
+
+FeatureType getFeatureType(FeatureIdx /*featureIdx*/) {
+    return FeatureType::UNKNOWN;
+}
+
+TypedOSMID getFeatureOSMID(FeatureIdx /*featureIdx*/) {
+    return {};
+}
+
+int getNumFeaturePoints(FeatureIdx /*featureIdx*/) {
+    return 0;
+}
+
+LatLon getFeaturePoint(int /*pointIdx*/, FeatureIdx /*featureIdx*/) {
+    return {};
+}
@@ -0,0 +1,19 @@
+#include "world_projection.hpp"
+
+#include <cmath>
+
+namespace gisevo::map_data {
+namespace {
+
+// Same constants as m1.h so projected points line up with latlonTopoint()
+constexpr double kEarthRadiusInMeters = 6372797.560856;
+constexpr double kDegreeToRadian = 0.017453292519943295769236907684886;
+
+}  // namespace
+
+WorldProjection::WorldProjection(const converter::NetworkSummary& summary)
+    : x_scale_(kEarthRadiusInMeters * kDegreeToRadian *
+               std::cos((summary.min_lat + summary.max_lat) / 2 * kDegreeToRadian)),
+      y_scale_(kEarthRadiusInMeters * kDegreeToRadian) {}
+
+}  // namespace gisevo::map_data
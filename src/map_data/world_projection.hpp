@@ -0,0 +1,29 @@
+#pragma once
+
+#include "../LatLon.h"
+#include "map_store.hpp"
+
+namespace gisevo::map_data {
+
+// Same projection as latlonTopoint(): metres east/north, longitude scaled by the cosine of the
+// map's mid latitude
+struct WorldPoint {
+    double x;
+    double y;
+};
+
+// Projects positions on the map described by `summary` to WorldPoints
+class WorldProjection {
+public:
+    explicit WorldProjection(const converter::NetworkSummary& summary);
+
+    WorldPoint operator()(LatLon position) const {
+        return {x_scale_ * position.longitude(), y_scale_ * position.latitude()};
+    }
+
+private:
+    double x_scale_;
+    double y_scale_;
+};
+
+}  // namespace gisevo::map_data
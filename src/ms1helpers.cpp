@@ -9,6 +9,7 @@
 #include "globals.h"
 #include "struct.h"
 #include "coords_conversions.hpp"
+#include "map_data/map_store.hpp"
 
 void lowerCase(std::string& Orin_String) {
     // loop through all characters within the string
@@ -20,29 +21,22 @@ void lowerCase(std::string& Orin_String) {
     }
 }
 
-void mapOSMIDToNode() {
-    int numOfNodes = getNumberOfNodes();
-    for (int i = 0; i < numOfNodes; ++i) {
-        const OSMNode* tempNode = getNodeByIndex(i);
-        OSMID id = tempNode->id();
-        globals.node_to_id.insert({id, tempNode});
+const OSMNode* findNodeByOSMID(OSMID id) {
+    const auto& store = gisevo::map_data::streets_store();
+    const std::size_t node = store.find_node(id);
+    if (node == gisevo::map_data::StreetsStore::kNotFound) {
+        return nullptr;
     }
+    return getNodeByIndex(static_cast<int>(node));
 }
 
-void mapOSMIDToWay() {
-    for (int i = 0; i < getNumberOfWays(); ++i) {
-        const OSMWay* temp_way = getWayByIndex(i);
-        OSMID id = temp_way->id();
-        globals.id_to_way.insert({id, temp_way});
-    }
-}
-
-void mapOSMIDToRelation() {
-    for (int i = 0; i < getNumberOfRelations(); ++i) {
-        const OSMRelation* temp_relation = getRelationByIndex(i);
-        OSMID id = temp_relation->id();
-        globals.id_to_relation.insert({id, temp_relation});
+const OSMWay* findWayByOSMID(OSMID id) {
+    const auto& store = gisevo::map_data::streets_store();
+    const std::size_t way = store.find_way(id);
+    if (way == gisevo::map_data::StreetsStore::kNotFound) {
+        return nullptr;
     }
+    return getWayByIndex(static_cast<int>(way));
 }
 
 void replaceString(std::string& currentStr, const std::string& toReplace, const std::string& replaceWith) {
@@ -53,60 +47,6 @@ void replaceString(std::string& currentStr, const std::string& toReplace, const
 }
 
 
-void preLoadWayDistance() {
-    std::vector <OSMID> way_nodes;
-    int numberOfWays = getNumberOfWays();
-    double distance = 0;
-    const OSMNode* node1;
-    const OSMNode* node2;
-    const OSMWay* way;
-    OSMID wayid;
-    int j;
-
-    // outer for loop to go through all OSMWays in the map
-    for (int i = 0; i < numberOfWays; ++i) {
-        way = getWayByIndex(i);
-        way_nodes = getWayMembers(way);
-        wayid = way->id();
-        // this loop is to go through each node
-        auto nodesInWay = way_nodes.size();
-        distance = 0;
-
-        // inner for loop to go through all OSMIDs/OSMNodes contained in each way
-        for (j = 0; j < nodesInWay - 1; ++j) {
-            // look for the corresponding node from the id
-            auto search = globals.node_to_id.find(way_nodes[j]);
-
-            // if the id isn't found to be a node, then go to the next (should never occur assuming correct data)
-            if (search != globals.node_to_id.end()) {
-                node1 = search->second;
-                search = globals.node_to_id.find(way_nodes[j+1]);
-                if (search != globals.node_to_id.end()) {
-                    node2 = search->second;
-                    LatLon point1 = getNodeCoords(node1);
-                    LatLon point2 = getNodeCoords(node2);
-                    distance += findDistanceBetweenTwoPoints(point1, point2);
-                }
-            }
-        }
-        if (isClosedWay(way) && j+1 != nodesInWay) { // distance from end to start for closed objects
-            auto search = globals.node_to_id.find(way_nodes[nodesInWay]);
-            if (search != globals.node_to_id.end()) {
-                node1 = search->second;
-                search = globals.node_to_id.find(way_nodes[0]);
-                if (search != globals.node_to_id.end()) {
-                    node2 = search->second;
-                    LatLon point1 = getNodeCoords(node1);
-                    LatLon point2 = getNodeCoords(node2);
-                    distance += findDistanceBetweenTwoPoints(point1, point2);
-                }
-            }
-        }
-        globals.way_distance.insert({wayid, distance});
-
-    }
-}
-
 double latAverageOfFeature(std::vector<LatLon>& featureListOfLatLon) {
     double avg = 0;
     for (auto i : featureListOfLatLon) {
@@ -131,48 +71,6 @@ double trapezoidRule(double& x1, double& y1, double& x2, double& y2) {
     return area;
 }
 
-void loopAllStreetSegments(){
-    globals.max_speed = 0;
-    int num_street_segment = getNumStreetSegments();
-    for (StreetSegmentIdx i = 0; i < num_street_segment; ++i){
-        // preload globals.vec_streetinfo
-        // preload intersections
-        StreetSegmentInfo street_segment_info = getStreetSegmentInfo(i);
-        globals.vec_streetinfo[street_segment_info.streetID].intersections.push_back(street_segment_info.from);
-        globals.vec_streetinfo[street_segment_info.streetID].intersections.push_back(street_segment_info.to);
-        
-        // preload street segments
-        globals.vec_streetinfo[street_segment_info.streetID].street_segments.push_back(i);
-        
-        // preload street length
-        StreetSegmentDistance ss_dis;
-        double ss_length = CalculateSSLength(i);
-        globals.vec_streetinfo[street_segment_info.streetID].street_length += ss_length;
-
-        // set the max speed global variable
-        if (street_segment_info.speedLimit > globals.max_speed) {
-            globals.max_speed = street_segment_info.speedLimit;
-        }
-
-        // preload globals.vec_segmentdis
-        ss_dis.segment_length = ss_length;
-        // avoid dividing by 0
-        if (street_segment_info.speedLimit == 0){
-            ss_dis.travel_time = 0;
-        }
-        else {
-            ss_dis.travel_time = ss_length / street_segment_info.speedLimit;
-        }
-        globals.vec_segmentdis.push_back(ss_dis);
-    }
-
-    // remove duplicates for each street's intersection list
-    for (auto& street : globals.vec_streetinfo){
-        std::sort(street.intersections.begin(), street.intersections.end());
-        street.intersections.erase(std::unique(street.intersections.begin(), street.intersections.end()), street.intersections.end());
-    }   
-}
-
 // void preLoadAjacentIntersections(){
 
 //     // loop through all intersections 
@@ -195,79 +93,6 @@ void loopAllStreetSegments(){
 //     }
 // }
 
-double CalculateSSLength(StreetSegmentIdx street_segment_id) {
-    StreetSegmentInfo input_segment = getStreetSegmentInfo(street_segment_id);
-    double length = 0;
-    
-    // get the Latlon of intersection from and to
-    IntersectionIdx intersection_from = input_segment.from;
-    IntersectionIdx intersection_to = input_segment.to;
-    LatLon position_begin = getIntersectionPosition(intersection_from);
-    LatLon position_end = getIntersectionPosition(intersection_to);
-
-    int num_Curve_pt = input_segment.numCurvePoints;
-    LatLon old_point = position_begin;
-    // if no curve points, the distance can be direclty caculated with two intersection points
-    if(num_Curve_pt == 0){
-        length = findDistanceBetweenTwoPoints(position_begin, position_end);
-    }
-    else {
-        // loop through all curve points to calculate segment length
-        for(int i = 0; i < num_Curve_pt; i++){
-            LatLon new_point = getStreetSegmentCurvePoint(i, street_segment_id);
-            length += findDistanceBetweenTwoPoints(old_point, new_point);
-            // update old point
-            old_point = new_point;
-        }
-        // add in the length between last curve point and intersection_to
-        length += findDistanceBetweenTwoPoints(old_point, position_end);
-    }
-    return length;
-}
-
-void preLoadIntersectionStreetSegment(){
-    // resize the vector 
-    globals.intersection_street_segments.resize(getNumIntersections());
-    int num_intersections = getNumIntersections();
-    // loop through all intersections
-    for(IntersectionIdx intersection = 0; intersection < num_intersections; ++intersection) {
-        // loop through all street segments linked to current intersection
-        int num_street_segments = getNumIntersectionStreetSegment(intersection);
-        for (int i = 0; i < num_street_segments; ++i) {
-            //load intersection street segment
-            int ss_id = getIntersectionStreetSegment(i, intersection);
-            globals.intersection_street_segments[intersection].push_back(ss_id);
-
-            //load adjacent intersections
-            StreetSegmentInfo segment_info = getStreetSegmentInfo(getIntersectionStreetSegment(i, intersection));
-            if (segment_info.from != intersection){
-                globals.adjacent_intersections[intersection].push_back(segment_info.from);
-            }
-            else {
-                globals.adjacent_intersections[intersection].push_back(segment_info.to);
-            }
-        }
-    }    
-}
-
-void loopAllStreets() {
-    for (StreetIdx street_id = 0; street_id < getNumStreets(); ++street_id){
-        // load all streets into a multimap in alphabetical order with their name
-        std::string strt_name = getStreetName(street_id);
-        // remove all the spaces in street names
-        strt_name.erase(std::remove(strt_name.begin(), strt_name.end(), ' '),strt_name.end());
-        // put names in lower cases
-        lowerCase(strt_name);
-        globals.ordered_street_name.insert(std::make_pair(strt_name, street_id));
-
-        // initialize a struct for streetInfo
-        StreetsInfo a_street;
-        // initialize street length to 0
-        a_street.street_length = 0.0;
-        globals.vec_streetinfo.push_back(a_street);
-    }
-}
-
 POIIdx loopThroughAllPOIs(LatLon& my_position, std::string& poi_name) {
     int number_of_POIs = getNumPointsOfInterest();
 
@@ -30,31 +30,18 @@
 void lowerCase(std::string& Orin_String);
 
 
-/* Maps each OSMID with its corresponding OSMNode
- * Called by: loadMap -> m1.cpp
+/* Finds the OSMNode with the given OSMID, or nullptr if the map has no such node
+ * Called by: getOSMNodeTagValue -> m1.cpp, create_vector_of_ways, sortSubwayLines -> m2_way_helpers.cpp
  * Calls: None
- * Estimated Time Complexity: O(n)
+ * Estimated Time Complexity: O(log n), a search over the sorted node ids in streets.bin
  * Implemented in: helpers.cpp
  */
-void mapOSMIDToNode();
+const OSMNode* findNodeByOSMID(OSMID id);
 
-/*
- *
- */
-void mapOSMIDToWay();
-
-/*
- *
- */
-void mapOSMIDToRelation();
-
-/* Calculates each OSMWay's distance
- * Called by: loadMap -> m1.cpp
- * Calls: findDistanceBetweenTwoPoints -> m1.cpp
- * Estimated Time Complexity: O(n^2), however the number of nodes per way is small, making it O(n)
- * Implemented in: helpers.cpp
+/* Finds the OSMWay with the given OSMID, or nullptr if the map has no such way
+ * Estimated Time Complexity: O(log n), a search over the sorted way ids in streets.bin
  */
-void preLoadWayDistance();
+const OSMWay* findWayByOSMID(OSMID id);
 
 
 /* Finds and replaces part of a string
@@ -103,45 +90,6 @@ double trapezoidRule(double& x1, double& y1, double& x2, double& y2);
 //void preLoadAjacentIntersections();
 
 
-/* Loads intersections, street_segments and street_length of each StreetsInfo in vec_streetinfo
- * Loads each StreetSegementDistance in vec_segmentdis
- * Called by: loadMap -> m1.cpp
- * Calls: calculateSSLength -> helpers.cpp
- * Estimated Time Complexity: O(n)
- * Implemented in: helpers.cpp
- */
-void loopAllStreetSegments();
-
-
-/* Calculates the length of the given street segment 
- * Called by: loopAllStreetSegments -> helpers.cpp
- * Calls: findDistanceBetweenTwoPoints
- * Estimated Time Complexity: O(n)
- * Implemented in: helpers.cpp
- */
-double CalculateSSLength(StreetSegmentIdx street_segment_id);
-
-
-/* Loads intersection_street_segments with street segments connected at an intersection
- * organized by IntersectionIdx
- * Called by: loadMap -> m1.cpp
- * Calls: None
- * Estimated Time Complexity: O(n)
- * Implemented in: helpers.cpp
- */
-void preLoadIntersectionStreetSegment ();
-
- 
-/* Loads ordered_street_name with all street names in alphabetical order
- * and initializes a vector of streetsinfo 
- * Called by: loadMap -> m1.cpp
- * Calls: None
- * Estimated Time Complexity: O(n)
- * Implemented in: helpers.cpp
- */
-void loopAllStreets();
-
-
 /* Implements nearly all the functionality required for findClosestPOI
  * Called by: findClosestPOI -> m1.cpp
  * Calls: findDistanceBetweenTwoPoints -> m1.cpp
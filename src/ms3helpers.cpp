@@ -48,41 +48,43 @@ std::pair<Point2D,Point2D> findMaxMinPoint(const std::vector<StreetSegmentIdx>&
 void drawRoadArrows(const std::vector<StreetSegmentIdx>& route,int current_zoom_level, IntersectionIdx src) {
 
     //check if it is going from "from to to" or "to to from" direction
-    IntersectionIdx prev_inter = globals.all_street_segments[route[0]].from;
+    StreetSegmentInfo first = getStreetSegmentInfo(route[0]);
+    IntersectionIdx prev_inter = first.from;
     bool from_to_to = false;
-    if(src == globals.all_street_segments[route[0]].from){
+    if(src == first.from){
         from_to_to =true;
-        prev_inter = globals.all_street_segments[route[0]].to;
+        prev_inter = first.to;
     }
 
     //loop through all segments of the route
     for(int i =0; i< route.size(); i++){
         StreetSegmentIdx segment = route[i];
         street_segment_info info = globals.all_street_segments[segment];
+        StreetSegmentInfo ends = getStreetSegmentInfo(segment);
         info.arrow_width = 5;
         info.arrow_zoom_dep = current_zoom_level;
         if(i!=0) {
             // check for directions (from -> to or to -> from)
-            if (info.from == prev_inter) {
+            if (ends.from == prev_inter) {
                 from_to_to = true;
-                prev_inter = info.to;
+                prev_inter = ends.to;
             }
             else {
                 from_to_to = false;
-                prev_inter = info.from;
+                prev_inter = ends.from;
             }
         }
         //only add in arrows if it is not a one way street
-        if(!info.oneWay) {
+        if(!ends.oneWay) {
             if (info.num_curve_point == 0) {
                 if(from_to_to) {
-                    draw_arrows(segment, globals.all_intersections[info.from].position,
-                                globals.all_intersections[info.to].position);
+                    draw_arrows(segment, globals.all_intersections[ends.from].position,
+                                globals.all_intersections[ends.to].position);
                 }
                 else{
                     //contains curve points
-                    draw_arrows(segment, globals.all_intersections[info.to].position,
-                                globals.all_intersections[info.from].position);
+                    draw_arrows(segment, globals.all_intersections[ends.to].position,
+                                globals.all_intersections[ends.from].position);
                 }
             }
             else {
@@ -106,7 +108,7 @@ void clearRoadArrows(const std::vector<StreetSegmentIdx>& route){
         info.arrow_width = 1;
         info.arrow_zoom_dep = 9;
         //only add in arrows if it is not a one way street
-        if(!info.oneWay) {
+        if(!getStreetSegmentInfo(segment).oneWay) {
             globals.all_street_segments[segment].arrows_to_draw.clear();
         }
     }
@@ -161,8 +163,10 @@ std::vector<std::string> findDirections(const std::vector<StreetSegmentIdx >& ro
 Directions findAngleSegments(StreetSegmentIdx from, StreetSegmentIdx to){
     //calculate the angle between the two segment and the intermediate point, and then substract
     double pi = std::acos(-1);
-    street_segment_info info_from = globals.all_street_segments[from];
-    street_segment_info info_to = globals.all_street_segments[to];
+    const street_segment_info& info_from = globals.all_street_segments[from];
+    const street_segment_info& info_to = globals.all_street_segments[to];
+    StreetSegmentInfo ends_from = getStreetSegmentInfo(from);
+    StreetSegmentInfo ends_to = getStreetSegmentInfo(to);
     ezgl::point2d src_pos, intermediate,dst_pos;
     bool from_curved = true;
     bool to_curved = true;
@@ -174,7 +178,7 @@ Directions findAngleSegments(StreetSegmentIdx from, StreetSegmentIdx to){
     }
 
     //check which way is the two street segment connected
-    if(globals.all_intersections[info_from.to].index == globals.all_intersections[info_to.from].index){
+    if(globals.all_intersections[ends_from.to].index == globals.all_intersections[ends_to.from].index){
         // from -> to & from ->to
         if(from_curved){
             //take the last curve point
@@ -182,52 +186,52 @@ Directions findAngleSegments(StreetSegmentIdx from, StreetSegmentIdx to){
             src_pos = info_from.lines_to_draw[info_from.lines_to_draw.size()-1].first;
         }
         else {
-            src_pos = globals.all_intersections[info_from.from].position;
+            src_pos = globals.all_intersections[ends_from.from].position;
         }
         if(to_curved){
             //take the first curve point
             dst_pos = info_to.lines_to_draw[0].second;
         }
         else{
-            dst_pos = globals.all_intersections[info_to.to].position;
+            dst_pos = globals.all_intersections[ends_to.to].position;
         }
-         intermediate = globals.all_intersections[info_from.to].position;
+         intermediate = globals.all_intersections[ends_from.to].position;
     }
-    else if(globals.all_intersections[info_from.from].index == globals.all_intersections[info_to.from].index){
+    else if(globals.all_intersections[ends_from.from].index == globals.all_intersections[ends_to.from].index){
         // to -> from & from -> to
         if(from_curved){
             //take the first curve point
             src_pos = info_from.lines_to_draw[0].second;
         }
         else{
-            src_pos= globals.all_intersections[info_from.to].position;
+            src_pos= globals.all_intersections[ends_from.to].position;
         }
         if(to_curved){
             //take the first curve point
             dst_pos = info_to.lines_to_draw[0].second;
         }
         else{
-            dst_pos = globals.all_intersections[info_to.to].position;
+            dst_pos = globals.all_intersections[ends_to.to].position;
         }
-        intermediate = globals.all_intersections[info_from.from].position;
+        intermediate = globals.all_intersections[ends_from.from].position;
     }
-    else if(globals.all_intersections[info_from.to].index == globals.all_intersections[info_to.to].index){
+    else if(globals.all_intersections[ends_from.to].index == globals.all_intersections[ends_to.to].index){
         //from -> to & to -> from
         if(from_curved){
             //take the last curve point
             src_pos = info_from.lines_to_draw[info_from.lines_to_draw.size()-1].first;
         }
         else {
-            src_pos = globals.all_intersections[info_from.from].position;
+            src_pos = globals.all_intersections[ends_from.from].position;
         }
         if(to_curved){
             //take the last curve point
             dst_pos = info_to.lines_to_draw[info_to.lines_to_draw.size()-1].first;
         }
         else{
-            dst_pos = globals.all_intersections[info_to.from].position;
+            dst_pos = globals.all_intersections[ends_to.from].position;
         }
-        intermediate = globals.all_intersections[info_from.to].position;
+        intermediate = globals.all_intersections[ends_from.to].position;
     }
     else{
         //to -> from & to -> from
@@ -236,16 +240,16 @@ Directions findAngleSegments(StreetSegmentIdx from, StreetSegmentIdx to){
             src_pos = info_from.lines_to_draw[0].second;
         }
         else{
-            src_pos= globals.all_intersections[info_from.to].position;
+            src_pos= globals.all_intersections[ends_from.to].position;
         }
         if(to_curved){
             //take the last curve point
             dst_pos = info_to.lines_to_draw[info_to.lines_to_draw.size()-1].first;
         }
         else{
-            dst_pos = globals.all_intersections[info_to.from].position;
+            dst_pos = globals.all_intersections[ends_to.from].position;
         }
-        intermediate = globals.all_intersections[info_from.from].position;
+        intermediate = globals.all_intersections[ends_from.from].position;
     }
 
     double src_x = intermediate.x - src_pos.x;
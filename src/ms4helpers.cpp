@@ -5,10 +5,11 @@
 #include "m4.h"
 #include "m3.h"
 #include "ms4helpers.hpp"
+#include "courier_tour.hpp"
 #include "globals.h"
-#include "astaralgo.hpp"
+#include "m3_algo/travel_time_matrix.hpp"
 #include "sort_streetseg/streetsegment_info.hpp"
-#include <omp.h>
+#include "map_data/map_store.hpp"
 
 #include <iostream>
 #include <vector>
@@ -18,186 +19,84 @@
 #include <stdlib.h>
 #include <random>
 #include <limits>
-
-// This function calls multi-dijkstra to find the best travel routes between all dropoff points, and depots to dropoff points
-// We don't need routes between depots
-void compute_all_travel_times(const std::vector<IntersectionIdx>& of_interest,
-                              const std::unordered_map<IntersectionIdx, int>& intersection_to_index,
-                              std::vector<std::vector<OneRoute>>& route_matrix,
-                              const float& turn_penalty) {
-
-    // loop through all deliveries, tack on the depots to the nodes to search
-
-    // need this for parallel operation without race conditions
-    const std::vector<street_segment_info> local_all_segments = globals.all_street_segments;
-
-//    auto start = std::chrono::high_resolution_clock::now();
-
-    #pragma omp parallel for
-    for (auto& i : of_interest) {
-        multi_dijkstra(i, of_interest, turn_penalty, route_matrix, intersection_to_index, local_all_segments);
+#include <tuple>
+
+// Fills in the travel times between all dropoff points, and depots to dropoff points, with one
+// many-to-many search (see computeTravelTimeMatrix)
+RouteMatrix::RouteMatrix(const std::vector<IntersectionIdx>& key_intersections, const float turn_penalty)
+    : keys_(key_intersections), turn_penalty_(turn_penalty) {
+    const TravelTimeMatrix travel_times = computeTravelTimeMatrix(keys_, keys_, turn_penalty);
+    costs_.resize(keys_.size() * keys_.size());
+    for (std::size_t i = 0; i < keys_.size(); ++i) {
+        for (std::size_t j = 0; j < keys_.size(); ++j) {
+            costs_[i * keys_.size() + j] = static_cast<float>(travel_times.time(i, j));
+        }
     }
+}
 
-//    auto end = std::chrono::high_resolution_clock::now();
-//    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end-start);
-//    std::cout << "Took " << duration.count() << std::endl;
-//    std::cout << "Done" << std::endl;
+std::vector<StreetSegmentIdx> RouteMatrix::route(const int from, const int to) const {
+    return findPathBetweenIntersections(turn_penalty_, {keys_[from], keys_[to]});
 }
 
-void multi_dijkstra(const IntersectionIdx start,
-                    const std::vector<IntersectionIdx> of_interest,
-                    const float turn_penalty,
-                    std::vector<std::vector<OneRoute>>& route_matrix,
-                    const std::unordered_map<IntersectionIdx, int> intersection_to_index,
-                    const std::vector<street_segment_info> local_all_segments) {
 
-    // vector for our path of nodes
-    std::vector<StreetSegmentIdx> route_elements;
+CourierIncumbent::CourierIncumbent(const CourierSolveOptions& options, const std::chrono::steady_clock::time_point start,
+                                   const double lower_bound)
+    : options_(options), start_(start), deadline_(start + options.time_budget),
+      target_cost_(options.target_gap > 0 ? lower_bound * (1 + options.target_gap) : 0),
+      best_cost_(std::numeric_limits<double>::infinity()) {}
 
-    int first_array_index = 0;
-    auto first_index = intersection_to_index.find(start);
-    if (first_index != intersection_to_index.end()) {
-        first_array_index = first_index->second;
+void CourierIncumbent::offer(const std::vector<IntersectionIdx>& path, const double cost) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!(cost < best_cost_)) {
+        return;
     }
+    best_ = path;
+    best_cost_ = cost;
+    if (cost <= target_cost_) {
+        reached_target_.store(true, std::memory_order_relaxed);
+    }
+    if (options_.on_improvement) {
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_);
+        options_.on_improvement(CourierImprovement{best_, cost, elapsed});
+    }
+}
 
-    // holds a struct of nodes we have searched before
-    std::vector<Search_Node> visited;
-    visited.resize(getNumIntersections());
-
-    // have we found all routes we were looking for?
-    bool found_all = false;
-
-    // this will keep track if we have found all intersections
-    int found_routes = 0; // will be equal to of_interest.size() when we have found all routes
-
-    // set up the first element, the start intersection
-    // don't know which edge or street we used, also no time so far
-    Wave_Elm first_elm(start, 0, 0, 0);
-
-    // already searched the beginning intersection
-    Search_Node first_node;
-    first_node.edge_id = 0; // will be incorrect for the first node
-    first_node.best_time = 0;
-    first_node.node_id = -1;
-
-    visited[start] = first_node;
-
-    // queue of nodes to search
-    std::priority_queue<Wave_Elm, std::vector<Wave_Elm>, comparator_dijkstra> wave_front;
-
-    wave_front.push(first_elm);
-
-    // loop until the queue is empty or the node is found
-    while (!wave_front.empty() && !found_all) {
-
-        Wave_Elm current_elm = wave_front.top();
-
-        if (!wave_front.empty()) {
-            wave_front.pop();
-        }
-
-        int current_elm_id = current_elm.node_id;
-
-        if (visited[current_elm_id].visited) {
-            continue;
-        }
-
-        visited[current_elm_id].visited = true;
-
-        // check if the current intersection exists inside the vector of intersections of interest
-        if (std::find(of_interest.begin(), of_interest.end(), current_elm_id) != of_interest.end()) {
-            found_routes++;
-            int current_inter = current_elm_id;
-            int next_inter;
-
-            while (visited[current_inter].node_id != -1) {
-                route_elements.push_back(visited[current_inter].edge_id);
-                next_inter = visited[current_inter].node_id;
-                current_inter = next_inter;
-            }
-            std::reverse(route_elements.begin(), route_elements.end());
-
-            // get the corresponding array index from the unordered map
-            int array_index = 0;
-            auto index = intersection_to_index.find(current_elm_id);
-            if (index != intersection_to_index.end()) {
-                array_index = index->second;
-            }
-
-            route_matrix[first_array_index][array_index].route = route_elements;
-            route_matrix[first_array_index][array_index].start = start;
-            route_matrix[first_array_index][array_index].end = current_elm_id;
-            route_matrix[first_array_index][array_index].travel_time = computePathTravelTime(turn_penalty, route_elements);
+bool CourierIncumbent::finished() const {
+    return reached_target_.load(std::memory_order_relaxed) || std::chrono::steady_clock::now() >= deadline_;
+}
 
-            route_elements.clear();
+std::vector<IntersectionIdx> CourierIncumbent::best() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return best_;
+}
 
-            if (found_routes == of_interest.size()) {
-                found_all = true;
+// Every stop is arrived at once, and the route ends by arriving at a depot
+double courierLowerBound(const std::vector<IntersectionIdx>& key_intersections, const std::vector<IntersectionIdx>& depots,
+                         const RouteMatrix& routes_matrix, const std::unordered_map<IntersectionIdx, int>& intersection_to_index) {
+    auto cheapest_arrival = [&](IntersectionIdx intersection) {
+        const int to = intersection_to_index.at(intersection);
+        float cheapest = std::numeric_limits<float>::infinity();
+        for (int from = 0; from < static_cast<int>(routes_matrix.size()); ++from) {
+            if (from != to) {
+                cheapest = std::min(cheapest, routes_matrix.cost(from, to));
             }
-
         }
+        return static_cast<double>(cheapest);
+    };
 
-        if (!found_all) {
-
-            std::vector<StreetSegmentIdx> outgoing_streets = findStreetSegmentsOfIntersection(current_elm_id);
-
-            // loop through all the outgoing streets of the current intersection (node)
-
-            for (auto i: outgoing_streets) {
-                bool invalid_check = false;
-
-                IntersectionIdx next_intersection;
-
-                // if the current node is at from, then the next node is at to
-                // if the current node is at to, and it's not a one way street, then the next node is at from
-
-                if (current_elm_id == local_all_segments[i].from) {
-                    next_intersection = local_all_segments[i].to;
-                } else if (!local_all_segments[i].oneWay) {
-                    next_intersection = local_all_segments[i].from;
-                } else {
-                    invalid_check = true;
-                }
-
-                // if this node was popped from the wavefront before, no sense in checking it
-                // if the road is one way in the wrong direction, skip it
-                if (invalid_check || visited[next_intersection].visited) {
-                    continue;
-                }
-
-                double distance_to_next = findStreetSegmentLength(i);
-
-                Search_Node next_node;
-                next_node.edge_id = i;
-                next_node.node_id = current_elm_id;
-
-                // determine the best time to reach this node so far
-                next_node.best_time =
-                        current_elm.travel_time + distance_to_next / local_all_segments[i].speedLimit;
-
-                // account for the turn penalty if we change streets
-                if (local_all_segments[i].street != current_elm.street_index) {
-                    next_node.best_time += turn_penalty;
-                }
-
-                // only add this new node to the wavefront if we found a shorter route to it
-                if (next_node.best_time < visited[next_intersection].best_time) {
-                    visited[next_intersection] = next_node;
-                    // get the distance to the destination from where we are now
-
-                    double travel_time = next_node.best_time;
-
-                    Wave_Elm next_elm(next_intersection, i, local_all_segments[i].street, travel_time);
-
-                    wave_front.push(next_elm);
-
-                }
-            }
+    double bound = 0;
+    for (const IntersectionIdx intersection : key_intersections) {
+        if (std::find(depots.begin(), depots.end(), intersection) == depots.end()) {
+            bound += cheapest_arrival(intersection);
         }
     }
+    double return_leg = std::numeric_limits<double>::infinity();
+    for (const IntersectionIdx depot : depots) {
+        return_leg = std::min(return_leg, cheapest_arrival(depot));
+    }
+    return bound + return_leg;
 }
 
-
 std::vector<IntersectionIdx> find_unique_intersections(const std::vector<DeliveryInf> &deliveries, const std::vector<IntersectionIdx>& depots) {
     std::vector<IntersectionIdx > unique_intersections;
  //   int new_size = (2*deliveries.size())+(depots.size());
@@ -391,13 +290,13 @@ void updateAvailableStops(IntersectionIdx new_stop, std::vector<IntersectionIdx>
         }
 }
 
-std::vector<CourierSubPath> indexToSubPath(const std::vector<IntersectionIdx>& path, const std::vector<std::vector<OneRoute>>& routes_matrix, std::unordered_map<IntersectionIdx, int>& intersection_to_index){
+std::vector<CourierSubPath> indexToSubPath(const std::vector<IntersectionIdx>& path, const RouteMatrix& routes_matrix, std::unordered_map<IntersectionIdx, int>& intersection_to_index){
     std::vector<CourierSubPath> sub_path;
     for(int i = 0; i < path.size()-1; i++) {
         CourierSubPath current_path;
-        const OneRoute* route = &routes_matrix[intersection_to_index[path[i]]][intersection_to_index[path[i+1]]];
-        current_path.intersections = std::make_pair(route->start,route->end);
-        current_path.subpath = route->route;
+        current_path.intersections = std::make_pair(path[i], path[i+1]);
+        // only the legs of the final path are unpacked into routes
+        current_path.subpath = routes_matrix.route(intersection_to_index[path[i]], intersection_to_index[path[i+1]]);
         sub_path.push_back(current_path);
     }
     return sub_path;
@@ -406,8 +305,8 @@ std::vector<CourierSubPath> indexToSubPath(const std::vector<IntersectionIdx>& p
 [[maybe_unused]] std::vector<IntersectionIdx> twoOptImplementation (
                                                    const std::vector<IntersectionIdx>& start_path,
                                                    const double start_path_cost,
-                                                   const std::vector<std::vector<OneRoute>>& routes_matrix,
-                                                   const long time_taken,
+                                                   const RouteMatrix& routes_matrix,
+                                                   CourierIncumbent& incumbent,
                                                    const std::unordered_map<IntersectionIdx, int>& intersection_to_index,
                                                    const std::unordered_map<IntersectionIdx, Delivery_details> delivery_info,
                                                    const int max_bound,
@@ -423,9 +322,7 @@ std::vector<CourierSubPath> indexToSubPath(const std::vector<IntersectionIdx>& p
     //static thread_local std::mt19937 rng(rd());
     static thread_local std::mt19937 gen_rand(std::random_device{}());
     std::uniform_int_distribution<int> get_rand(min_bound,max_bound);
-
-
-    auto start_time = std::chrono::high_resolution_clock::now();
+    std::size_t since_improvement = 0;
 
     while (!timeout) {
         //std::cout << "HereS" << std::endl;
@@ -448,14 +345,10 @@ std::vector<CourierSubPath> indexToSubPath(const std::vector<IntersectionIdx>& p
 
                 new_path = twoOptVTwo(path, i, j, delivery_info);
 
-                if (new_path != path) {
-                    new_cost = pathCost(new_path, routes_matrix, intersection_to_index);
-                }
+                // an illegal move leaves the path as it was
+                new_cost = new_path != path ? pathCost(new_path, routes_matrix, intersection_to_index) : cost;
 
-                auto current_time = std::chrono::high_resolution_clock::now();
-                auto duration_cost = std::chrono::duration_cast<std::chrono::seconds>(current_time - start_time);
-                if (duration_cost.count() + time_taken >= 48) {
-                    //std::cout << "HereT" << std::endl;
+                if (incumbent.finished() || ++since_improvement >= incumbent.stall_iterations()) {
                     timeout = true;
                     break;
                 }
@@ -463,7 +356,8 @@ std::vector<CourierSubPath> indexToSubPath(const std::vector<IntersectionIdx>& p
                 if (new_cost < cost) {
                     path = new_path;
                     cost = new_cost;
-                    //std::cout << new_cost << std::endl;
+                    incumbent.offer(path, cost);
+                    since_improvement = 0;
                     skip_iter = true;
                     break;
                 }
@@ -482,44 +376,67 @@ std::vector<IntersectionIdx> annealingTwoOpt  (int temperature,
                                                const double alpha,
                                                struct drand48_data buffer,
                                                const std::vector<IntersectionIdx>& start_path,
-                                               const double start_path_cost,
-                                               const std::vector<std::vector<OneRoute>>& routes_matrix,
-                                               const long time_taken,
+                                               const RouteMatrix& routes_matrix,
+                                               CourierIncumbent& incumbent,
                                                const std::unordered_map<IntersectionIdx, int>& intersection_to_index,
                                                const std::unordered_map<IntersectionIdx, Delivery_details> delivery_info,
                                                const int max_bound,
                                                const int min_bound) {
 
-    std::vector<IntersectionIdx> path = start_path;
-    std::vector<IntersectionIdx> new_path = path ;
-    std::vector<IntersectionIdx> global_path = path;
-    double cost = start_path_cost;
-    double new_cost = start_path_cost;
-    double global_cost = start_path_cost;
+    // moves are priced from the legs they change and applied in place (see CourierTour)
+    CourierTour tour(routes_matrix, start_path, intersection_to_index, delivery_info);
+    if (tour.size() <= 5) {
+        return start_path;
+    }
+    std::vector<IntersectionIdx> global_path = start_path;
+    double global_cost = tour.cost();
     bool timeout = false;
-    double delta_c = 0;
     double random = 0;
-    //static thread_local std::random_device rd;
-    //static thread_local std::mt19937 rng(rd());
     static thread_local std::mt19937 gen_rand(std::random_device{}());
     std::uniform_int_distribution<int> get_rand_i(min_bound,max_bound);
-
-
-
-    auto start_time = std::chrono::high_resolution_clock::now();
+    std::uniform_int_distribution<int> get_position(1, tour.size() - 2);
+    std::uniform_int_distribution<int> get_gap(0, tour.size() - 2);
+    std::uniform_real_distribution<double> get_rand(0,1);
+    std::uniform_int_distribution<int> to2(0,4);
+    std::uniform_int_distribution<int> coin(0,1);
+    // 0 swap, 1 2-opt, 2 relocate, 3 Or-opt, 4 pair relocate, 5 segment insertion 3-opt
+    const int long_path[]={2, 3, 3, 4, 5};
+    const int short_path[]= {0, 2, 3, 4, 5};
+    const int* numbers = tour.size() > 130 ? long_path : short_path;
+    std::size_t since_improvement = 0;
+
+    // two different positions between the depots
+    auto two_positions = [&](int& a, int& b) {
+        a = get_position(gen_rand);
+        do {
+            b = get_position(gen_rand);
+        } while (b == a);
+    };
+    // where a run of visits at positions first to last can go (see CourierTour::move_run), or -1 if
+    // it spans every visit between the depots
+    auto outside = [&](int first, int last) {
+        if (first == 1 && last == tour.size() - 2) {
+            return -1;
+        }
+        int to;
+        do {
+            to = get_gap(gen_rand);
+        } while (to >= first - 1 && to <= last);
+        return to;
+    };
 
     while (!timeout) {
         int i =get_rand_i(gen_rand);
 
-        int max_end = std::min((int)(i)+20, static_cast<int>(path.size()) - 1);
+        int max_end = std::min((int)(i)+20, tour.size() - 1);
         int min_end = std::max(1, (int)(i)-5);
         std::uniform_int_distribution<int> get_rand_j(min_end,max_end);
         if(max_bound-min_bound > 10 && max_bound - min_bound < 15){
-            max_end = std::min((int)(i + (max_bound-min_bound))+4, static_cast<int>(path.size()) - 1);
+            max_end = std::min((int)(i + (max_bound-min_bound))+4, tour.size() - 1);
             min_end = std::max(1,((int)(i - (max_bound-min_bound)-1) ));
         }
         else if(max_bound-min_bound >= 15){
-            max_end = std::min((int)(i + 10)+4, static_cast<int>(path.size()) - 1);
+            max_end = std::min((int)(i + 10)+4, tour.size() - 1);
             min_end = std::max(1,((int)(i - 5)-1));
         }
 
@@ -529,77 +446,100 @@ std::vector<IntersectionIdx> annealingTwoOpt  (int temperature,
                 j = get_rand_j(gen_rand);
             }
 
-            std::random_device rand_dev;
-            thread_local std::mt19937 generator(rand_dev());
-            std::uniform_real_distribution<double> get_rand(0,1);
-            static thread_local std::mt19937 rng(std::random_device{}());
-
-            std::uniform_int_distribution<int> to2(0,4);
-            int* numbers;
-            int long_path[]={0, 2, 2, 2,2};
-            int short_path[]= {0,0,2,2,2};
-
-            if(path.size()>130) {
-                numbers = long_path;
-            }
-            else{
-                numbers = short_path;
-            }
-
             int select;
             // equal chance of getting a decimal between 0 to 1
-            double probability = get_rand(generator);
+            double probability = get_rand(gen_rand);
             //50% of running 2-opt
             double compare = temperature > 5?0.75:0.15;
             if(probability < compare){
                 select = 1;
             }
             else{
-                select = (*(numbers+to2(generator)));
+                select = numbers[to2(gen_rand)];
             }
 
-            // select which perturbation to apply
+            // select which move to try; one that would drop off before picking up leaves the tour as
+            // it was, at no cost
+            int a = i;
+            int b = j - 1;
+            int to = 0;
+            bool reversed = false;
+            bool legal = false;
+            double delta_c = 0;
             switch(select){
                 case 0:
-                    new_path = perturbationSwap(path, delivery_info);
+                    two_positions(a, b);
+                    legal = tour.swap_feasible(a, b);
+                    delta_c = legal ? tour.swap_delta(a, b) : 0;
                     break;
 
                 case 1:
-                    new_path = twoOptVTwo(path, i, j, delivery_info);
+                    legal = a < b && tour.reverse_feasible(a, b);
+                    delta_c = legal ? tour.reverse_delta(a, b) : 0;
                     break;
 
                 case 2:
-                    new_path =  perturbationMoveOne(path, delivery_info);
+                    two_positions(a, b);
+                    legal = tour.relocate_feasible(a, b);
+                    delta_c = legal ? tour.relocate_delta(a, b) : 0;
                     break;
 
                 case 3:
-                    new_path = swapAndShift(path,delivery_info);
-                    break;
-                default:
+                    // Or-opt: two or three visits in a row go elsewhere
+                    a = get_position(gen_rand);
+                    b = std::min(a + 1 + coin(gen_rand), tour.size() - 2);
+                    [[fallthrough]];
+                case 5:
+                    // the segment insertion 3-opt takes the run of the 2-opt instead
+                    reversed = coin(gen_rand);
+                    to = outside(a, b);
+                    legal = a < b && to >= 0 && tour.move_run_feasible(a, b, to, reversed);
+                    delta_c = legal ? tour.move_run_delta(a, b, to, reversed) : 0;
                     break;
-            }
 
+                case 4:
+                    // a pick-up goes together with one of its drop-offs
+                    if (tour.pair_count() == 0) {
+                        break;
+                    }
+                    std::tie(a, b) = tour.pair_positions(std::uniform_int_distribution<int>(0, tour.pair_count() - 1)(gen_rand));
+                    do {
+                        to = get_gap(gen_rand);
+                    } while (to == a || to == b);
+                    legal = tour.move_pair_feasible(a, b, to);
+                    delta_c = legal ? tour.move_pair_delta(a, b, to) : 0;
+                    break;
 
-            if (new_path != path) {
-                new_cost = pathCost(new_path, routes_matrix, intersection_to_index);
+                default:
+                    break;
             }
 
-            auto current_time = std::chrono::high_resolution_clock::now();
-            auto duration_cost = std::chrono::duration_cast<std::chrono::seconds>(current_time - start_time);
-            if (duration_cost.count() + time_taken >= 48) {
+            if (incumbent.finished() || ++since_improvement >= incumbent.stall_iterations()) {
                 timeout = true;
                 break;
             }
 
-            delta_c = new_cost - cost;
             drand48_r(&buffer, &random);
             if (delta_c < 0 || random < exp(-delta_c / temperature)) {
-                if(new_cost <global_cost){
-                    global_cost = new_cost;
-                    global_path = new_path;
+                if (legal) {
+                    if (select == 0) {
+                        tour.swap(a, b);
+                    } else if (select == 1) {
+                        tour.reverse(a, b);
+                    } else if (select == 2) {
+                        tour.relocate(a, b);
+                    } else if (select == 4) {
+                        tour.move_pair(a, b, to);
+                    } else {
+                        tour.move_run(a, b, to, reversed);
+                    }
+                }
+                if(tour.cost() <global_cost){
+                    global_cost = tour.cost();
+                    global_path = tour.path();
+                    incumbent.offer(global_path, global_cost);
+                    since_improvement = 0;
                 }
-                path = new_path;
-                cost = new_cost;
                 break;
             }
             j = temp+1;
@@ -611,10 +551,7 @@ std::vector<IntersectionIdx> annealingTwoOpt  (int temperature,
             temperature *= alpha;
         }
     }
-    if (global_cost <new_cost) {
-        path = global_path;
-    }
-    return path;
+    return global_path;
 }
 
 
@@ -623,14 +560,12 @@ std::vector<IntersectionIdx> simulatedAnnealing(int temperature,
                         const std::vector<IntersectionIdx> start_path,
                         const double start_path_cost,
                         const int num_perturbations,
-                        const std::vector<std::vector<OneRoute>> routes_matrix,
+                        const RouteMatrix& routes_matrix,
                         struct drand48_data buffer,
                         const double alpha,
-                        const double time_taken,
+                        CourierIncumbent& incumbent,
                         const std::unordered_map<IntersectionIdx, int> intersection_to_index) {
 
-    auto start = std::chrono::high_resolution_clock::now();
-    double execution_time = 0;
     std::vector<IntersectionIdx> path = start_path;
     std::vector<IntersectionIdx> new_path = start_path;
     double cost = start_path_cost;
@@ -639,8 +574,10 @@ std::vector<IntersectionIdx> simulatedAnnealing(int temperature,
     double random = 0;
     // start point for 2 opt
     //(lrand48_r(&buffer, &random2) % 49) + 1;
-    // keep making perturbations while the time is less than 45 seconds
-    while (time_taken + execution_time < 45) {
+    double best_cost = start_path_cost;
+    std::size_t since_improvement = 0;
+    // keep making perturbations until the incumbent says to stop or nothing improves for a while
+    while (!incumbent.finished() && since_improvement < incumbent.stall_iterations()) {
 
 
         for (int i = 0; i < num_perturbations; ++i) {
@@ -653,6 +590,13 @@ std::vector<IntersectionIdx> simulatedAnnealing(int temperature,
                     path = new_path;
                     cost = new_cost;
                 }
+                if (cost < best_cost) {
+                    best_cost = cost;
+                    incumbent.offer(path, cost);
+                    since_improvement = 0;
+                } else {
+                    ++since_improvement;
+                }
             //}
         }
         if (temperature < 0.00001) {
@@ -661,17 +605,12 @@ std::vector<IntersectionIdx> simulatedAnnealing(int temperature,
         else {
             temperature *= alpha;
         }
-
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::seconds>(end-start);
-        execution_time = duration.count();
-       // std::cout << execution_time << std::endl;
     }
     return path;
 }
 
 double pathCost(const std::vector<IntersectionIdx>& path,
-                const std::vector<std::vector<OneRoute>>& routes_matrix,
+                const RouteMatrix& routes_matrix,
                 const std::unordered_map<IntersectionIdx, int>& intersection_to_index) {
 
     double cost = 0;
@@ -679,40 +618,12 @@ double pathCost(const std::vector<IntersectionIdx>& path,
     for (uint i = 0; i < path.size()-1; ++i) {
         auto find_first = intersection_to_index.find(path[i]);
         auto find_second = intersection_to_index.find(path[i+1]);
-        cost += routes_matrix[find_first->second][find_second->second].travel_time;
+        cost += routes_matrix.cost(find_first->second, find_second->second);
     }
 
     return cost;
 }
 
-std::vector<IntersectionIdx> perturbationSwap(std::vector<IntersectionIdx>& path, std::unordered_map<IntersectionIdx, Delivery_details> delivery_info){
-
-   thread_local static std::mt19937 rng(std::random_device{}());
-    std::vector<IntersectionIdx> path2 = path;
-    // not enough elements for meaningful swap
-    if (path2.size() <= 3){
-        return path2;
-    }
-
-    // min = 1, max = path.size() - 2
-    std::uniform_int_distribution<int> random_index(1, path2.size() - 2);
-    int swap_1 = random_index(rng);
-    int swap_2;
-
-    do {
-        swap_2 = random_index(rng);
-    } while (swap_2 == swap_1);
-
-    std::swap(path2[swap_1], path2[swap_2]);
-
-    if (checkLegalNodeParallel(path2, delivery_info)) {
-        return path2;
-    }
-    else {
-        return path;
-    }
-}
-
 std::vector<IntersectionIdx> perturbationTwoOpt(std::vector<IntersectionIdx> path) {
     // not enough elements for meaningful 2opt
     if (path.size() <= 3){
@@ -747,40 +658,6 @@ std::vector<IntersectionIdx> twoOptVTwo(std::vector<IntersectionIdx>& path, cons
 }
 
 
-std::vector<IntersectionIdx> perturbationMoveOne(std::vector<IntersectionIdx>& path, std::unordered_map<IntersectionIdx, Delivery_details> delivery_info){
-
-    thread_local static std::mt19937 rng(std::random_device{}());
-    std::vector<IntersectionIdx> path2 = path;
-
-    // not enough elements for meaninful move
-    if (path2.size() <= 3){
-        return path;
-    }
-
-    // min = 1, max = path.size() - 2
-    std::uniform_int_distribution<int> random_index(1, path2.size() - 2);
-    int start = random_index(rng);
-    int end;
-
-    do {
-        end = random_index(rng);
-    } while (end == start);
-
-    if (start < end){
-        std::rotate(path2.begin() + start, path2.begin() + start + 1, path2.begin() + end + 1);
-    }
-    else{
-        std::rotate(path2.begin() + end, path2.begin() + end + 1, path2.begin() + start + 1);
-    }
-
-    if (checkLegalNodeParallel(path2, delivery_info)) {
-        return path2;
-    }
-    else {
-        return path;
-    }
-}
-
 // std::vector<IntersectionIdx> perturbeTravelRoute(std::vector<IntersectionIdx>& path){
 //     int num_perturbation = 3;
 //     std::random_device rand_dev;
@@ -823,7 +700,7 @@ int generateDistribution(const int& min, const int& max) {
 }
 
 
-std::vector<IntersectionIdx> greedyAlgo (std::vector<IntersectionIdx>& pick_ups,std::vector<std::vector<OneRoute>>& routes_matrix, IntersectionIdx depot, const std::unordered_map<IntersectionIdx, int>& intersection_to_index) {
+std::vector<IntersectionIdx> greedyAlgo (std::vector<IntersectionIdx>& pick_ups,const RouteMatrix& routes_matrix, IntersectionIdx depot, const std::unordered_map<IntersectionIdx, int>& intersection_to_index) {
         std::unordered_map<IntersectionIdx ,Delivery_details> infos = globals.delivery_info;
         IntersectionIdx prev_node = depot;
         std::vector<IntersectionIdx> available_stops = pick_ups;
@@ -838,8 +715,7 @@ std::vector<IntersectionIdx> greedyAlgo (std::vector<IntersectionIdx>& pick_ups,
             //loop through all the legal next stop
             for (int i = 0; i < available_stops.size(); i++) {
                 IntersectionIdx node = available_stops[i];
-//                double current_time = routes_matrix[intersection_to_index[prev_node]][intersection_to_index[node]].travel_time;
-                double current_time = routes_matrix.at(intersection_to_index.at(prev_node)).at(intersection_to_index.at(node)).travel_time;
+                double current_time = routes_matrix.cost(intersection_to_index.at(prev_node), intersection_to_index.at(node));
                 if (current_time < fastest_time) {
                     fastest_time = current_time;
                     closest_node = node;
@@ -859,14 +735,14 @@ std::vector<IntersectionIdx> greedyAlgo (std::vector<IntersectionIdx>& pick_ups,
         return path;
 }
 
-void findDepotsCloseToPickUp(const std::vector<IntersectionIdx>& depots,const std::vector<IntersectionIdx>& pick_ups,IntersectionIdx & closest_depot, IntersectionIdx& second_closest,const std::vector<std::vector<OneRoute>>& routes_matrix,const std::unordered_map<IntersectionIdx, int>& intersection_to_index) {
+void findDepotsCloseToPickUp(const std::vector<IntersectionIdx>& depots,const std::vector<IntersectionIdx>& pick_ups,IntersectionIdx & closest_depot, IntersectionIdx& second_closest,const RouteMatrix& routes_matrix,const std::unordered_map<IntersectionIdx, int>& intersection_to_index) {
     double global_fastest_pick = DBL_MAX;
     double global_second_fastest_pick = DBL_MAX;
     for (const auto &depot: depots) {
         double depot_fastest_pick = DBL_MAX;
         // find depot close to pick up
         for (auto node: pick_ups) {
-            double current_time = routes_matrix.at(intersection_to_index.at(depot)).at(intersection_to_index.at(node)).travel_time;
+            double current_time = routes_matrix.cost(intersection_to_index.at(depot), intersection_to_index.at(node));
             if (current_time < depot_fastest_pick) {
                 depot_fastest_pick = current_time;
             }
@@ -884,13 +760,13 @@ void findDepotsCloseToPickUp(const std::vector<IntersectionIdx>& depots,const st
     }
 }
 
-void findDepotsCloseToDropOff(const std::vector<IntersectionIdx>& depots,const std::vector<IntersectionIdx>& drop_offs,IntersectionIdx & close_drop,IntersectionIdx&second_close_drop,const std::vector<std::vector<OneRoute>>& routes_matrix,const std::unordered_map<IntersectionIdx, int>& intersection_to_index) {
+void findDepotsCloseToDropOff(const std::vector<IntersectionIdx>& depots,const std::vector<IntersectionIdx>& drop_offs,IntersectionIdx & close_drop,IntersectionIdx&second_close_drop,const RouteMatrix& routes_matrix,const std::unordered_map<IntersectionIdx, int>& intersection_to_index) {
     double global_fastest_drop = DBL_MAX;
     double global_second_fastest_drop = DBL_MAX; // New variable for second closest pickup
     for (const auto &depot: depots) {
         double depot_fastest_drop = DBL_MAX;
         for (auto node: drop_offs) {
-            double current_time = routes_matrix.at(intersection_to_index.at(depot)).at(intersection_to_index.at(node)).travel_time;
+            double current_time = routes_matrix.cost(intersection_to_index.at(depot), intersection_to_index.at(node));
             if (current_time < depot_fastest_drop) {
                 depot_fastest_drop = current_time;
             }
@@ -908,36 +784,3 @@ void findDepotsCloseToDropOff(const std::vector<IntersectionIdx>& depots,const s
 }
 
 
-std::vector<IntersectionIdx> swapAndShift(std::vector<IntersectionIdx>& path, std::unordered_map<IntersectionIdx, Delivery_details> delivery_info){
-    std::random_device rand_dev;
-    std::mt19937 generator(rand_dev());
-    std::uniform_int_distribution<int> get_rand(1,path.size()-3);
-    IntersectionIdx start = get_rand(generator);
-    IntersectionIdx end =  std::min(start+3, static_cast<int>(path.size()) - 2);
-    std::vector<IntersectionIdx> new_path =path;
-    IntersectionIdx temp1 = new_path[end];
-    IntersectionIdx temp2 =  new_path[end-1];
-    IntersectionIdx temp3 =  new_path[end-2];
-    IntersectionIdx temp4 =  new_path[end-3];
-    std::uniform_int_distribution<int> rand_2(0,1);
-    if(rand_2(generator)==0) {
-        new_path[end] = temp2;
-        new_path[end - 1] = temp3;
-        new_path[end - 2] = temp4;
-        new_path[end - 3] = temp1;
-    }
-    else{
-        new_path[end-3]=temp3;
-        new_path[end-2]=temp2;
-        new_path[end-1]=temp1;
-        new_path[end]=temp4;
-    }
-    if(!checkLegalNodeParallel(new_path,delivery_info)){
-        return path;
-    }
-    else{
-        return new_path;
-    }
-}
-
-
@@ -5,13 +5,17 @@
 #pragma once
 
 #include "StreetsDatabaseAPI.h"
+#include "courier_solve.hpp"
 #include "m4.h"
 #include "struct.h"
 #include "sort_streetseg/streetsegment_info.hpp"
 #include <iostream>
 #include <vector>
+#include <atomic>
 #include <chrono>
+#include <mutex>
 #include <random>
+#include <utility>
 
 enum Stop_Type{
     DEPOT = 0,
@@ -19,41 +23,70 @@ enum Stop_Type{
     DROPOFF,
 };
 
-class OneRoute {
+/*
+ * Travel times between the key intersections of a delivery problem, by their position in
+ * key_intersections (see preloadKeys)
+ * The optimisers only read a dense K x K table of float costs. No routes are stored: the route of
+ * a leg is searched for again when indexToSubPath unpacks the final path, which is a few point to
+ * point searches instead of a route for every pair.
+ */
+class RouteMatrix {
 public:
-    std::vector<StreetSegmentIdx> route;
-    double travel_time;
-    IntersectionIdx start;
-    IntersectionIdx end;
-
-    // Constructors
-    OneRoute(std::vector<StreetSegmentIdx> i_route,
-             double i_travel_time,
-             IntersectionIdx i_start,
-             IntersectionIdx i_end) {
-
-        route = i_route;
-        travel_time = i_travel_time;
-        start = i_start;
-        end = i_end;
-    }
-    OneRoute() = default;
+    RouteMatrix() = default;
+    RouteMatrix(const std::vector<IntersectionIdx>& key_intersections, float turn_penalty);
+    // A table computed elsewhere, costs[from * key_intersections.size() + to]
+    RouteMatrix(std::vector<IntersectionIdx> key_intersections, std::vector<float> costs)
+        : keys_(std::move(key_intersections)), costs_(std::move(costs)) {}
+
+    std::size_t size() const { return keys_.size(); }
+    IntersectionIdx intersection(int index) const { return keys_[index]; }
+
+    // infinity if the leg cannot be driven
+    float cost(int from, int to) const { return costs_[static_cast<std::size_t>(from) * keys_.size() + to]; }
+
+    // The fastest route of the leg, as findPathBetweenIntersections returns it
+    std::vector<StreetSegmentIdx> route(int from, int to) const;
+
+private:
+    std::vector<IntersectionIdx> keys_;
+    float turn_penalty_ = 0;
+    std::vector<float> costs_;
+};
+
+/*
+ * The best delivery order any optimiser thread has found, and whether they should stop looking
+ * (see CourierSolveOptions)
+ */
+class CourierIncumbent {
+public:
+    CourierIncumbent(const CourierSolveOptions& options, std::chrono::steady_clock::time_point start,
+                     double lower_bound);
+
+    // Keeps the path if it is faster than the best so far, and reports it to options.on_improvement
+    void offer(const std::vector<IntersectionIdx>& path, double cost);
+    // Whether the time budget is spent or the best order is within the target gap
+    bool finished() const;
+    std::size_t stall_iterations() const { return options_.stall_iterations; }
+    std::vector<IntersectionIdx> best() const;
+
+private:
+    const CourierSolveOptions& options_;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::steady_clock::time_point deadline_;
+    double target_cost_;
+    std::atomic<bool> reached_target_{false};
+    mutable std::mutex mutex_;
+    std::vector<IntersectionIdx> best_;
+    double best_cost_;
 };
 
-void compute_all_travel_times(const std::vector<IntersectionIdx>& of_interest,
-                              const std::unordered_map<IntersectionIdx, int>& intersection_to_index,
-                              std::vector<std::vector<OneRoute>>& route_matrix,
-                              const float& turn_penalty);
+// Lower bound on the travel time of any delivery order: the cheapest leg into every stop, plus the
+// cheapest leg back into a depot
+double courierLowerBound(const std::vector<IntersectionIdx>& key_intersections, const std::vector<IntersectionIdx>& depots,
+                         const RouteMatrix& routes_matrix, const std::unordered_map<IntersectionIdx, int>& intersection_to_index);
 
 std::vector<IntersectionIdx> find_unique_intersections(const std::vector<DeliveryInf> &deliveries, const std::vector<IntersectionIdx>& depots);
 
-void multi_dijkstra(IntersectionIdx start,
-                    std::vector<IntersectionIdx> of_interest,
-                    float turn_penalty,
-                    std::vector<std::vector<OneRoute>>& route_matrix,
-                    std::unordered_map<IntersectionIdx, int> intersection_to_index,
-                    std::vector<street_segment_info> local_all_segments);
-
 void preloadDeliveryStops(const std::vector<DeliveryInf> &deliveries);
 
 void clearVisitedNodes(std::vector<IntersectionIdx> &path, int index);
@@ -66,36 +99,32 @@ void loadDeliveryDetails(const std::vector<DeliveryInf> &deliveries,const std::v
 
 void updateAvailableStops(IntersectionIdx new_stop, std::vector<IntersectionIdx> &available_stops, std::unordered_map<IntersectionIdx ,Delivery_details>& infos);
 
-std::vector<CourierSubPath> indexToSubPath(const std::vector<IntersectionIdx>& path, const std::vector<std::vector<OneRoute>>& routes_matrix, std::unordered_map<IntersectionIdx, int>& intersection_to_index);
+std::vector<CourierSubPath> indexToSubPath(const std::vector<IntersectionIdx>& path, const RouteMatrix& routes_matrix, std::unordered_map<IntersectionIdx, int>& intersection_to_index);
 
 std::vector<IntersectionIdx> simulatedAnnealing(int temperature,
                                                 std::vector<IntersectionIdx> start_path,
                                                 double start_path_cost,
                                                 int num_perturbations,
-                                                std::vector<std::vector<OneRoute>> routes_matrix,
+                                                const RouteMatrix& routes_matrix,
                                                 struct drand48_data buffer,
                                                 double alpha,
-                                                double time_taken,
+                                                CourierIncumbent& incumbent,
                                                 std::unordered_map<IntersectionIdx, int> intersection_to_index);
 
-double pathCost(const std::vector<IntersectionIdx>& path, const std::vector<std::vector<OneRoute>>& routes_matrix, const std::unordered_map<IntersectionIdx, int>& intersection_to_index);
-
-std::vector<IntersectionIdx> perturbationSwap(std::vector<IntersectionIdx>& path, std::unordered_map<IntersectionIdx, Delivery_details> delivery_info);
+double pathCost(const std::vector<IntersectionIdx>& path, const RouteMatrix& routes_matrix, const std::unordered_map<IntersectionIdx, int>& intersection_to_index);
 
 std::vector<IntersectionIdx> perturbationTwoOpt(std::vector<IntersectionIdx> path);
 
 std::vector<IntersectionIdx> perturbeTravelRoute(std::vector<IntersectionIdx>& path);
 
-std::vector<IntersectionIdx> perturbationMoveOne(std::vector<IntersectionIdx>& path, std::unordered_map<IntersectionIdx, Delivery_details> delivery_info);
-
 int generateDistribution(const int& min, const int& max);
 
 std::vector<IntersectionIdx> twoOptVTwo(std::vector<IntersectionIdx>& path, const int index_1, const int index_2 ,std::unordered_map<IntersectionIdx, Delivery_details> delivery_info);
 
 std::vector<IntersectionIdx> twoOptImplementation (const std::vector<IntersectionIdx>& start_path,
                                                    const double start_path_cost,
-                                                   const std::vector<std::vector<OneRoute>>& routes_matrix,
-                                                   const long time_taken,
+                                                   const RouteMatrix& routes_matrix,
+                                                   CourierIncumbent& incumbent,
                                                    const std::unordered_map<IntersectionIdx, int>& intersection_to_index,
                                                    const std::unordered_map<IntersectionIdx, Delivery_details> delivery_info,
                                                    const int max_bound,
@@ -103,7 +132,7 @@ std::vector<IntersectionIdx> twoOptImplementation (const std::vector<Intersectio
 
 std::vector<IntersectionIdx> simulatedAnnealingV2 (const std::vector<IntersectionIdx>& start_path,
                                                    const double start_path_cost,
-                                                   const std::vector<std::vector<OneRoute>>& routes_matrix,
+                                                   const RouteMatrix& routes_matrix,
                                                    const long time_taken,
                                                    const std::unordered_map<IntersectionIdx, int>& intersection_to_index,
                                                    std::unordered_map<IntersectionIdx, Delivery_details> delivery_details,
@@ -112,22 +141,19 @@ std::vector<IntersectionIdx> simulatedAnnealingV2 (const std::vector<Intersectio
 
 bool checkLegalNodeParallel(const std::vector<IntersectionIdx> path, std::unordered_map<IntersectionIdx, Delivery_details> delivery_info);
 
-std::vector<IntersectionIdx> greedyAlgo (std::vector<IntersectionIdx>& pick_ups,std::vector<std::vector<OneRoute>>& routes_matrix, IntersectionIdx depot, const std::unordered_map<IntersectionIdx, int>& intersection_to_index );
+std::vector<IntersectionIdx> greedyAlgo (std::vector<IntersectionIdx>& pick_ups,const RouteMatrix& routes_matrix, IntersectionIdx depot, const std::unordered_map<IntersectionIdx, int>& intersection_to_index );
 
-void findDepotsCloseToPickUp(const std::vector<IntersectionIdx>& depots,const std::vector<IntersectionIdx>& pick_ups,IntersectionIdx & closest_depot, IntersectionIdx& second_closest,const std::vector<std::vector<OneRoute>>& routes_matrix,const std::unordered_map<IntersectionIdx, int>& intersection_to_index);
+void findDepotsCloseToPickUp(const std::vector<IntersectionIdx>& depots,const std::vector<IntersectionIdx>& pick_ups,IntersectionIdx & closest_depot, IntersectionIdx& second_closest,const RouteMatrix& routes_matrix,const std::unordered_map<IntersectionIdx, int>& intersection_to_index);
 
-void findDepotsCloseToDropOff(const std::vector<IntersectionIdx>& depots,const std::vector<IntersectionIdx>& drop_offs,IntersectionIdx & close_drop,IntersectionIdx&second_close_drop,const std::vector<std::vector<OneRoute>>& routes_matrix,const std::unordered_map<IntersectionIdx, int>& intersection_to_index);
+void findDepotsCloseToDropOff(const std::vector<IntersectionIdx>& depots,const std::vector<IntersectionIdx>& drop_offs,IntersectionIdx & close_drop,IntersectionIdx&second_close_drop,const RouteMatrix& routes_matrix,const std::unordered_map<IntersectionIdx, int>& intersection_to_index);
 
 std::vector<IntersectionIdx> annealingTwoOpt  (int temperature,
                                                 const double alpha,
                                                struct drand48_data buffer,
                                                 const std::vector<IntersectionIdx>& start_path,
-                                                const double start_path_cost,
-                                                const std::vector<std::vector<OneRoute>>& routes_matrix,
-                                                const long time_taken,
+                                                const RouteMatrix& routes_matrix,
+                                                CourierIncumbent& incumbent,
                                                 const std::unordered_map<IntersectionIdx, int>& intersection_to_index,
                                                 const std::unordered_map<IntersectionIdx, Delivery_details> delivery_info,
                                                 const int max_bound,
                                                 const int min_bound);
-
-std::vector<IntersectionIdx> swapAndShift(std::vector<IntersectionIdx>& path, std::unordered_map<IntersectionIdx, Delivery_details> delivery_info);
\ No newline at end of file
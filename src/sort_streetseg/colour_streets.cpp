@@ -200,41 +200,24 @@ double calculate_angle(double from_pos_x, double from_pos_y, double to_pos_x, do
 void compute_streets_info() {
 
     globals.all_street_segments.resize(getNumStreetSegments());
+    globals.street_segment_labels.resize(getNumStreetSegments());
 
     for (uint i = 0; i < getNumStreetSegments(); ++i) {
         StreetSegmentInfo info = getStreetSegmentInfo(i);
+        street_segment_label& label = globals.street_segment_labels[i];
 
         globals.all_street_segments[i].arrow_width = 1;
         globals.all_street_segments[i].arrow_colour = ezgl::BLACK;
         globals.all_street_segments[i].arrow_zoom_dep = 9;
-        globals.all_street_segments[i].text_colour = ezgl::BLACK;
-        globals.all_street_segments[i].dark_text_colour = ezgl::WHITE;
+        label.text_colour = ezgl::BLACK;
+        label.dark_text_colour = ezgl::WHITE;
         globals.all_street_segments[i].type = globals.ss_road_type[i];
-        globals.all_street_segments[i].street = info.streetID;
-        globals.all_street_segments[i].street_name = getStreetName(info.streetID);
-        globals.all_street_segments[i].inter_from = getIntersectionName(info.from);
-        globals.all_street_segments[i].inter_to = getIntersectionName(info.to);
-        globals.all_street_segments[i].from = info.from;
-        globals.all_street_segments[i].to = info.to;
         globals.all_street_segments[i].num_curve_point = info.numCurvePoints;
 
-
-
         set_colour_of_street(globals.ss_road_type[i], i);
         // type
         // road_color
 
-        // only used for drawing the A* algorithm
-        globals.all_street_segments[i].index = i;
-        globals.all_street_segments[i].to = info.to;
-        globals.all_street_segments[i].from = info.from;
-        globals.all_street_segments[i].oneWay = info.oneWay;
-        globals.all_street_segments[i].speedLimit = info.speedLimit;
-
-        OSMID current_street_id = info.wayOSMID;
-
-        globals.all_street_segments[i].id = current_street_id;
-
         LatLon from_pos = getIntersectionPosition(info.from);
         LatLon to_pos = getIntersectionPosition(info.to);
         double from_pos_x, from_pos_y, to_pos_x, to_pos_y;
@@ -311,21 +294,21 @@ void compute_streets_info() {
         // draw street names
         // calculates angle of street name and draws street names
         std::string street_name = getStreetName(info.streetID);
-        double segment_length = globals.vec_segmentdis[i].segment_length;
+        double segment_length = findStreetSegmentLength(i);
         double name_pos_x = (from_pos_x + to_pos_x) / 2;
         double name_pos_y = (from_pos_y + to_pos_y) / 2;
 
         if (street_name == "<unknown>") {
             continue;
         }
-        globals.all_street_segments[i].text_rotation = calculate_angle(from_pos_x, from_pos_y, to_pos_x, to_pos_y);
+        label.text_rotation = calculate_angle(from_pos_x, from_pos_y, to_pos_x, to_pos_y);
 
         text_prop text;
         text.label = street_name;
         text.loc = {name_pos_x, name_pos_y};
         text.length_x = segment_length;
         text.length_y = 100;
-        globals.all_street_segments[i].text_to_draw.push_back(text);
+        label.text_to_draw.push_back(text);
 
     }
 }
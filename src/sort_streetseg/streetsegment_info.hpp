@@ -40,37 +40,36 @@ struct text_prop {
     double length_y;
 };
 
+// Render data of a street segment, indexed by StreetSegmentIdx in globals.all_street_segments
+// The fields the graph searches read (from, to, one way, street, travel time) are not kept here;
+// they come from the routing edges and segment tables in the streets.bin mapping, so a search
+// never pulls these render vectors into cache.
 struct street_segment_info {
-    StreetIdx street;
-    std::string street_name;
-    std::string inter_to;
-    std::string inter_from;
     int num_curve_point;
     Point2D max_pos;
     Point2D min_pos;
-    StreetSegmentIdx index;
-    IntersectionIdx to;
-    IntersectionIdx from;
-    bool oneWay;
-    double speedLimit;
-    OSMID id;
     RoadType type;
     GdkRGBA road_colour;
     GdkRGBA dark_road_colour;
     GdkRGBA arrow_colour;
-    GdkRGBA text_colour;
-    GdkRGBA dark_text_colour;
     double x_avg;
     double y_avg;
     int arrow_width;
     std::vector<std::pair<Point2D, Point2D>> lines_to_draw;
     std::vector<std::pair<Point2D, Point2D>> arrows_to_draw;
-    std::vector<text_prop> text_to_draw;
-    double text_rotation;
     std::vector<std::pair<int, int>> zoom_levels;
     int arrow_zoom_dep;
 };
 
+// Street name label of a segment, indexed by StreetSegmentIdx in globals.street_segment_labels
+// Street and intersection names are looked up through the StreetsDatabaseAPI when needed.
+struct street_segment_label {
+    GdkRGBA text_colour;
+    GdkRGBA dark_text_colour;
+    std::vector<text_prop> text_to_draw;
+    double text_rotation;
+};
+
 extern std::vector<RoadType> m2_local_all_street_types;
 
 void draw_arrows(int idx, Point2D from, Point2D to);
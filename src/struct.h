@@ -8,22 +8,6 @@
 #include "ezgl/graphics.hpp"
 #include "POI/POI_setup.hpp"
 
-struct StreetsInfo {
-    // contains all the intersections of the street
-    std::vector <IntersectionIdx> intersections;
-    // contatins all the street segment of the street
-    std::vector <StreetSegmentIdx> street_segments;
-    // length of the street
-    double street_length;
-};
-
-struct StreetSegmentDistance{
-    // length of street segment
-    double segment_length;
-    // travel time if traveling at speed limit
-    double travel_time;
-};
-
 class POI_info{
     public:
     ezgl::point2d poi_loc;
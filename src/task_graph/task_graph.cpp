@@ -0,0 +1,218 @@
+#include "task_graph.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <thread>
+
+namespace gisevo {
+
+void TaskGraph::add(std::string name, std::function<void()> work, std::vector<std::string> reads,
+                    std::vector<std::string> writes) {
+    const std::size_t id = tasks_.size();
+    tasks_.push_back(Task{std::move(name), std::move(work), {}, 0});
+
+    for (const std::string& read : reads) {
+        if (std::find(writes.begin(), writes.end(), read) != writes.end()) {
+            continue;
+        }
+        Resource& resource = resources_[read];
+        if (resource.last_writer != kNoTask) {
+            add_edge(resource.last_writer, id);
+        }
+        resource.readers.push_back(id);
+    }
+    for (const std::string& write : writes) {
+        Resource& resource = resources_[write];
+        if (resource.last_writer != kNoTask) {
+            add_edge(resource.last_writer, id);
+        }
+        for (const std::size_t reader : resource.readers) {
+            add_edge(reader, id);
+        }
+        resource.readers.clear();
+        resource.last_writer = id;
+    }
+}
+
+// Edges are only ever added into the newest task, so a repeated edge is always the last one
+void TaskGraph::add_edge(std::size_t from, std::size_t to) {
+    std::vector<std::size_t>& successors = tasks_[from].successors;
+    if (from == to || (!successors.empty() && successors.back() == to)) {
+        return;
+    }
+    successors.push_back(to);
+    ++tasks_[to].predecessor_count;
+}
+
+void TaskGraph::run(unsigned workers) {
+    using clock = std::chrono::steady_clock;
+
+    if (workers == 0) {
+        workers = std::max(1U, std::thread::hardware_concurrency());
+    }
+    workers = static_cast<unsigned>(std::min<std::size_t>(workers, std::max<std::size_t>(tasks_.size(), 1)));
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::size_t> tasks;
+    };
+    std::vector<Queue> queues(workers);
+    std::vector<std::atomic<std::size_t>> waiting_on(tasks_.size());
+    for (std::size_t i = 0; i < tasks_.size(); ++i) {
+        waiting_on[i].store(tasks_[i].predecessor_count, std::memory_order_relaxed);
+    }
+
+    // ready and remaining are guarded by sleep_mutex so a worker cannot miss a wake up
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    std::size_t ready = 0;
+    std::size_t remaining = tasks_.size();
+
+    std::atomic<bool> failed{false};
+    std::exception_ptr first_error;
+    std::vector<std::vector<Timing>> worker_timings(workers);
+    const clock::time_point started = clock::now();
+
+    auto push = [&](unsigned worker, std::size_t task) {
+        {
+            std::lock_guard<std::mutex> lock(queues[worker].mutex);
+            queues[worker].tasks.push_back(task);
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            ++ready;
+        }
+        wake.notify_one();
+    };
+
+    // A worker takes its newest task (its successors are likely still in cache) and steals the
+    // oldest task from another worker
+    auto take = [&](unsigned worker, std::size_t& task) {
+        for (unsigned i = 0; i < workers; ++i) {
+            Queue& queue = queues[(worker + i) % workers];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty()) {
+                continue;
+            }
+            if (i == 0) {
+                task = queue.tasks.back();
+                queue.tasks.pop_back();
+            } else {
+                task = queue.tasks.front();
+                queue.tasks.pop_front();
+            }
+            std::lock_guard<std::mutex> sleep_lock(sleep_mutex);
+            --ready;
+            return true;
+        }
+        return false;
+    };
+
+    auto execute = [&](unsigned worker, std::size_t id) {
+        Task& task = tasks_[id];
+        if (!failed.load(std::memory_order_acquire)) {
+            const clock::time_point begin = clock::now();
+            try {
+                task.work();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(sleep_mutex);
+                if (!first_error) {
+                    first_error = std::current_exception();
+                }
+                failed.store(true, std::memory_order_release);
+            }
+            const clock::time_point end = clock::now();
+            worker_timings[worker].push_back(Timing{task.name, begin - started, end - begin, worker});
+        }
+        for (const std::size_t successor : task.successors) {
+            if (waiting_on[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                push(worker, successor);
+            }
+        }
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        if (--remaining == 0) {
+            wake.notify_all();
+        }
+    };
+
+    auto work_loop = [&](unsigned worker) {
+        for (;;) {
+            std::size_t task;
+            if (take(worker, task)) {
+                execute(worker, task);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            wake.wait(lock, [&] { return ready > 0 || remaining == 0; });
+            if (remaining == 0) {
+                return;
+            }
+        }
+    };
+
+    unsigned next_queue = 0;
+    for (std::size_t i = 0; i < tasks_.size(); ++i) {
+        if (tasks_[i].predecessor_count == 0) {
+            push(next_queue, i);
+            next_queue = (next_queue + 1) % workers;
+        }
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (unsigned worker = 1; worker < workers; ++worker) {
+        threads.emplace_back(work_loop, worker);
+    }
+    work_loop(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    wall_time_ = clock::now() - started;
+
+    timings_.clear();
+    for (const auto& timings : worker_timings) {
+        timings_.insert(timings_.end(), timings.begin(), timings.end());
+    }
+    std::sort(timings_.begin(), timings_.end(),
+              [](const Timing& a, const Timing& b) { return a.start < b.start; });
+
+    if (first_error) {
+        std::rethrow_exception(first_error);
+    }
+}
+
+void TaskGraph::print_report(std::ostream& out) const {
+    std::size_t name_width = 4;
+    for (const Timing& timing : timings_) {
+        name_width = std::max(name_width, timing.name.size());
+    }
+
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << std::fixed << std::setprecision(1);
+    out << std::left << std::setw(static_cast<int>(name_width)) << "task" << std::right << std::setw(11)
+        << "start ms" << std::setw(11) << "time ms" << std::setw(8) << "worker" << '\n';
+
+    std::chrono::duration<double, std::milli> busy{0};
+    for (const Timing& timing : timings_) {
+        out << std::left << std::setw(static_cast<int>(name_width)) << timing.name << std::right << std::setw(11)
+            << timing.start.count() << std::setw(11) << timing.duration.count() << std::setw(8) << timing.worker
+            << '\n';
+        busy += timing.duration;
+    }
+    out << "wall " << wall_time_.count() << " ms, task time " << busy.count() << " ms";
+    if (wall_time_.count() > 0.0) {
+        out << " (" << std::setprecision(2) << busy / wall_time_ << "x parallel)";
+    }
+    out << '\n';
+    out.flags(flags);
+    out.precision(precision);
+}
+
+}  // namespace gisevo
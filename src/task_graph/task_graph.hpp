@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gisevo {
+
+/*
+ * A set of tasks with declared data dependencies, run on a fixed pool of worker threads
+ * Each task names the shared data it reads and writes. A task runs after every task added
+ * before it that writes something it reads or writes, or reads something it writes, so the
+ * graph computes the same thing as running the tasks one by one in the order they were added.
+ * Ready tasks go on the queue of the worker that released them and idle workers steal from
+ * the other queues.
+ */
+class TaskGraph {
+public:
+    struct Timing {
+        std::string name;
+        std::chrono::duration<double, std::milli> start;  // since run() started
+        std::chrono::duration<double, std::milli> duration;
+        unsigned worker;
+    };
+
+    void add(std::string name, std::function<void()> work, std::vector<std::string> reads,
+             std::vector<std::string> writes);
+
+    // Runs every task once, using the calling thread as one of the workers. If a task throws,
+    // the tasks depending on it are skipped and the first exception is rethrown once the
+    // running tasks have finished.
+    void run(unsigned workers = 0);
+
+    // One entry per task that ran, in order of start time
+    const std::vector<Timing>& timings() const { return timings_; }
+    std::chrono::duration<double, std::milli> wall_time() const { return wall_time_; }
+    void print_report(std::ostream& out) const;
+
+private:
+    struct Task {
+        std::string name;
+        std::function<void()> work;
+        std::vector<std::size_t> successors;
+        std::size_t predecessor_count = 0;
+    };
+
+    static constexpr std::size_t kNoTask = static_cast<std::size_t>(-1);
+
+    // Tasks touching a resource since its last write, used to derive the edges in add()
+    struct Resource {
+        std::size_t last_writer = kNoTask;
+        std::vector<std::size_t> readers;
+    };
+
+    void add_edge(std::size_t from, std::size_t to);
+
+    std::vector<Task> tasks_;
+    std::unordered_map<std::string, Resource> resources_;
+    std::vector<Timing> timings_;
+    std::chrono::duration<double, std::milli> wall_time_{0};
+};
+
+}  // namespace gisevo
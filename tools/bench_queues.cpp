@@ -0,0 +1,204 @@
+// Microbenchmark of the routing search queues (src/m3_algo/search_queues.hpp)
+//
+// Runs the same Dijkstra and A* searches on a synthetic road grid with each queue and reports the
+// time per search and the largest number of queued entries. The lazy binary heap is the queue the
+// searches used before: it pushes a new entry every time a label improves and skips stale ones on
+// pop, so it holds more entries than there are queued states. The indexed queues also keep the
+// position of every state they touch (stamped labels, not counted in the sizes shown).
+//
+//   bench_queues [grid side, default 300] [searches per run, default 200]
+//
+// Cache misses are not counted here; run it under `perf stat -e cache-misses` for those.
+
+#include "m3_algo/search_queues.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// The queue the searches used before search_queues.hpp, with the same interface
+class LazyBinaryHeap {
+public:
+    void reset(std::size_t) { entries_.clear(); }
+    bool empty() const { return entries_.empty(); }
+    std::size_t size() const { return entries_.size(); }
+
+    void push(std::uint32_t id, double key) {
+        entries_.push_back({key, id});
+        std::push_heap(entries_.begin(), entries_.end(), std::greater<>());
+    }
+
+    std::pair<double, std::uint32_t> pop() {
+        std::pop_heap(entries_.begin(), entries_.end(), std::greater<>());
+        const std::pair<double, std::uint32_t> entry = entries_.back();
+        entries_.pop_back();
+        return entry;
+    }
+
+    static constexpr std::size_t kEntryBytes = sizeof(std::pair<double, std::uint32_t>);
+
+private:
+    std::vector<std::pair<double, std::uint32_t>> entries_;
+};
+
+// A side x side grid with each street between neighbours taking 10-60 s, both ways
+struct Grid {
+    struct Edge {
+        std::uint32_t to;
+        double time;
+    };
+
+    explicit Grid(std::uint32_t grid_side) : side(grid_side), first(side * side + 1, 0) {
+        std::mt19937 random(7);
+        std::uniform_real_distribution<double> time(10, 60);
+        std::vector<std::vector<Edge>> out(side * side);
+        for (std::uint32_t row = 0; row < side; ++row) {
+            for (std::uint32_t column = 0; column < side; ++column) {
+                const std::uint32_t at = row * side + column;
+                for (const std::uint32_t next : {column + 1 < side ? at + 1 : at, row + 1 < side ? at + side : at}) {
+                    if (next != at) {
+                        const double t = time(random);
+                        out[at].push_back({next, t});
+                        out[next].push_back({at, t});
+                    }
+                }
+            }
+        }
+        for (std::uint32_t at = 0; at < side * side; ++at) {
+            first[at + 1] = first[at] + static_cast<std::uint32_t>(out[at].size());
+            edges.insert(edges.end(), out[at].begin(), out[at].end());
+        }
+    }
+
+    std::uint32_t size() const { return side * side; }
+
+    // Straight line time at the fastest speed, so it never overestimates
+    double lower_bound(std::uint32_t from, std::uint32_t to) const {
+        const double rows = std::abs(static_cast<double>(from / side) - static_cast<double>(to / side));
+        const double columns = std::abs(static_cast<double>(from % side) - static_cast<double>(to % side));
+        return 10 * std::hypot(rows, columns);
+    }
+
+    std::uint32_t side;
+    std::vector<std::uint32_t> first;
+    std::vector<Edge> edges;
+};
+
+struct Result {
+    double milliseconds = 0;
+    std::size_t peak_entries = 0;
+    double checksum = 0;
+};
+
+// Entries in the queue. The indexed queues hold each state at most once, so theirs is the
+// number of states reached but not settled yet, which the search counts.
+template <typename Queue>
+std::size_t queued(const Queue& queue, std::size_t open_states) {
+    if constexpr (requires { queue.size(); }) {
+        return queue.size();
+    } else {
+        return open_states;
+    }
+}
+
+// One search per pair; end == kAll runs Dijkstra to every intersection, otherwise A* to end
+constexpr std::uint32_t kAll = std::numeric_limits<std::uint32_t>::max();
+
+template <typename Queue>
+Result run(const Grid& grid, const std::vector<std::pair<std::uint32_t, std::uint32_t>>& pairs) {
+    Queue queue;
+    std::vector<double> time(grid.size());
+    std::vector<char> settled(grid.size());
+    Result result;
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& [from, end] : pairs) {
+        std::fill(time.begin(), time.end(), std::numeric_limits<double>::infinity());
+        std::fill(settled.begin(), settled.end(), 0);
+        auto heuristic = [&](std::uint32_t at) { return end == kAll ? 0.0 : grid.lower_bound(at, end); };
+        queue.reset(grid.size());
+        time[from] = 0;
+        queue.push(from, heuristic(from));
+        std::size_t open = 1;
+        while (!queue.empty()) {
+            result.peak_entries = std::max(result.peak_entries, queued(queue, open));
+            const std::uint32_t at = queue.pop().second;
+            if (settled[at]) {
+                continue;
+            }
+            settled[at] = 1;
+            --open;
+            if (at == end) {
+                break;
+            }
+            for (std::uint32_t e = grid.first[at]; e < grid.first[at + 1]; ++e) {
+                const Grid::Edge& edge = grid.edges[e];
+                const double arrival = time[at] + edge.time;
+                if (!settled[edge.to] && arrival < time[edge.to]) {
+                    open += time[edge.to] == std::numeric_limits<double>::infinity();
+                    time[edge.to] = arrival;
+                    queue.push(edge.to, arrival + heuristic(edge.to));
+                }
+            }
+        }
+        result.checksum += time[end == kAll ? grid.size() - 1 : end];
+    }
+    result.milliseconds =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / pairs.size();
+    return result;
+}
+
+template <typename Queue>
+void report(const char* queue_name, std::size_t entry_bytes, const Grid& grid,
+            const std::vector<std::pair<std::uint32_t, std::uint32_t>>& pairs) {
+    const Result result = run<Queue>(grid, pairs);
+    std::printf("  %-22s %9.3f ms  %9zu entries  %8.1f KiB  (checksum %.0f)\n", queue_name, result.milliseconds,
+                result.peak_entries, result.peak_entries * entry_bytes / 1024.0, result.checksum);
+}
+
+// key and id, as stored by IndexedDaryHeap and RadixHeap
+constexpr std::size_t kIndexedEntryBytes = 16;
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const std::uint32_t side = argc > 1 ? static_cast<std::uint32_t>(std::atoi(argv[1])) : 300;
+    const std::size_t searches = argc > 2 ? static_cast<std::size_t>(std::atoi(argv[2])) : 200;
+    if (side < 2 || searches == 0) {
+        std::fprintf(stderr, "usage: %s [grid side >= 2] [searches > 0]\n", argv[0]);
+        return 1;
+    }
+    const Grid grid(side);
+    std::mt19937 random(11);
+    std::uniform_int_distribution<std::uint32_t> intersection(0, grid.size() - 1);
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> to_all;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> to_one;
+    for (std::size_t i = 0; i < searches; ++i) {
+        to_all.emplace_back(intersection(random), kAll);
+        to_one.emplace_back(intersection(random), intersection(random));
+    }
+    std::printf("%u x %u grid, %zu searches per queue; time per search, peak queue size\n", side, side, searches);
+
+    std::printf("Dijkstra to every intersection:\n");
+    report<LazyBinaryHeap>("lazy binary heap", LazyBinaryHeap::kEntryBytes, grid, to_all);
+    report<IndexedDaryHeap<2>>("indexed binary heap", kIndexedEntryBytes, grid, to_all);
+    report<IndexedDaryHeap<4>>("indexed 4-ary heap", kIndexedEntryBytes, grid, to_all);
+    report<RadixHeap>("radix heap", kIndexedEntryBytes, grid, to_all);
+
+    // the straight line bound is consistent, so A* keys never drop below the last one popped
+    std::printf("A* between two intersections:\n");
+    report<LazyBinaryHeap>("lazy binary heap", LazyBinaryHeap::kEntryBytes, grid, to_one);
+    report<IndexedDaryHeap<2>>("indexed binary heap", kIndexedEntryBytes, grid, to_one);
+    report<IndexedDaryHeap<4>>("indexed 4-ary heap", kIndexedEntryBytes, grid, to_one);
+    report<RadixHeap>("radix heap", kIndexedEntryBytes, grid, to_one);
+    return 0;
+}
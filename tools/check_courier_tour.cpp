@@ -0,0 +1,251 @@
+// Randomized check of the courier local search moves (src/courier_tour.hpp)
+//
+// Builds random delivery problems over random asymmetric travel time tables, where an
+// intersection can be a pick-up and a drop-off several times over, and applies random swap,
+// relocate, reverse, move_run and move_pair moves. Every move the tour calls feasible must keep
+// every pick-up before its drop-off, keep the same visits between the two depot ends and change
+// the cost by exactly its delta; the cost kept by the tour must match rescoring the order.
+//
+//   check_courier_tour [instances, default 300] [seed, default 1]
+//
+// Prints the moves checked per kind and exits with 1 at the first wrong one.
+
+#include "courier_tour.hpp"
+#include "ms4helpers.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+enum Move { kSwap, kRelocate, kReverse, kMoveRun, kMovePair };
+constexpr int kMoveCount = kMovePair + 1;
+const char* const kMoveNames[kMoveCount] = {"swap", "relocate", "reverse", "move_run", "move_pair"};
+
+struct Problem {
+    RouteMatrix matrix;
+    std::unordered_map<IntersectionIdx, int> intersection_to_index;
+    std::unordered_map<IntersectionIdx, Delivery_details> delivery_info;
+    std::vector<std::pair<IntersectionIdx, IntersectionIdx>> deliveries;
+    std::vector<IntersectionIdx> start_path;
+};
+
+class Checker {
+public:
+    explicit Checker(unsigned seed) : random_(seed) {}
+
+    int between(int low, int high) { return std::uniform_int_distribution<int>(low, high)(random_); }
+
+    // Intersection 0 is the depot; all pick-ups, then all drop-offs, is a legal starting order
+    Problem problem() {
+        const int keys = between(4, 25);
+        std::vector<IntersectionIdx> key_intersections(keys);
+        std::vector<float> costs(static_cast<std::size_t>(keys) * keys);
+        for (int k = 0; k < keys; ++k) {
+            key_intersections[k] = k;
+        }
+        for (float& cost : costs) {
+            cost = static_cast<float>(between(1, 1000));
+        }
+        Problem problem{RouteMatrix(key_intersections, costs), {}, {}, {}, {}};
+        for (int k = 0; k < keys; ++k) {
+            problem.intersection_to_index[k] = k;
+        }
+        const int deliveries = between(1, 15);
+        for (int d = 0; d < deliveries; ++d) {
+            const IntersectionIdx pick_up = between(1, keys - 1);
+            const IntersectionIdx drop_off = between(1, keys - 1);
+            if (pick_up != drop_off) {
+                problem.deliveries.emplace_back(pick_up, drop_off);
+                problem.delivery_info[pick_up].corres_dropoff.push_back(drop_off);
+                problem.delivery_info[drop_off].corres_pickup.push_back(pick_up);
+            }
+        }
+        problem.start_path.push_back(0);
+        for (const auto& [pick_up, drop_off] : problem.deliveries) {
+            problem.start_path.push_back(pick_up);
+        }
+        for (const auto& [pick_up, drop_off] : problem.deliveries) {
+            problem.start_path.push_back(drop_off);
+        }
+        problem.start_path.push_back(0);
+        return problem;
+    }
+
+    // Applies random moves to the tour, checking each feasible one against a full rescore
+    bool check(const Problem& problem, int moves) {
+        CourierTour tour(problem.matrix, problem.start_path, problem.intersection_to_index, problem.delivery_info);
+        const int size = tour.size();
+        for (int m = 0; m < moves; ++m) {
+            const std::vector<IntersectionIdx> before = tour.path();
+            if (std::fabs(cost(problem, before) - tour.cost()) > 1e-6) {
+                std::printf("tour cost %f does not match its order (%f)\n", tour.cost(), cost(problem, before));
+                return false;
+            }
+            const int move = between(0, kMoveCount - 1);
+            bool feasible = false;
+            double delta = 0;
+            switch (move) {
+                case kSwap:
+                case kRelocate: {
+                    const int a = between(1, size - 2);
+                    const int b = between(1, size - 2);
+                    if (a == b) {
+                        continue;
+                    }
+                    if (move == kSwap) {
+                        delta = tour.swap_delta(a, b);
+                        feasible = tour.swap_feasible(a, b);
+                        if (feasible) {
+                            tour.swap(a, b);
+                        }
+                    } else {
+                        delta = tour.relocate_delta(a, b);
+                        feasible = tour.relocate_feasible(a, b);
+                        if (feasible) {
+                            tour.relocate(a, b);
+                        }
+                    }
+                    break;
+                }
+                case kReverse: {
+                    const int first = between(1, size - 3);
+                    const int last = between(first + 1, size - 2);
+                    delta = tour.reverse_delta(first, last);
+                    feasible = tour.reverse_feasible(first, last);
+                    if (feasible) {
+                        tour.reverse(first, last);
+                    }
+                    break;
+                }
+                case kMoveRun: {
+                    const int first = between(1, size - 2);
+                    const int last = std::min(size - 2, first + between(0, 6));
+                    if (first == 1 && last == size - 2) {
+                        continue;
+                    }
+                    int to;
+                    do {
+                        to = between(0, size - 2);
+                    } while (to >= first - 1 && to <= last);
+                    const bool reversed = between(0, 1) == 1;
+                    delta = tour.move_run_delta(first, last, to, reversed);
+                    feasible = tour.move_run_feasible(first, last, to, reversed);
+                    if (feasible) {
+                        tour.move_run(first, last, to, reversed);
+                    }
+                    break;
+                }
+                case kMovePair: {
+                    if (tour.pair_count() == 0) {
+                        continue;
+                    }
+                    const auto [pick_up, drop_off] = tour.pair_positions(between(0, tour.pair_count() - 1));
+                    if (pick_up >= drop_off) {
+                        std::printf("pair at positions %d, %d is out of order\n", pick_up, drop_off);
+                        return false;
+                    }
+                    int to;
+                    do {
+                        to = between(0, size - 2);
+                    } while (to == pick_up || to == drop_off);
+                    delta = tour.move_pair_delta(pick_up, drop_off, to);
+                    feasible = tour.move_pair_feasible(pick_up, drop_off, to);
+                    if (feasible) {
+                        tour.move_pair(pick_up, drop_off, to);
+                    }
+                    break;
+                }
+            }
+            ++checked_[move];
+            if (!feasible) {
+                continue;
+            }
+            ++feasible_[move];
+            const std::vector<IntersectionIdx> after = tour.path();
+            if (!legal(problem, after)) {
+                std::printf("%s called an order feasible that drops off before picking up\n", kMoveNames[move]);
+                return false;
+            }
+            if (!same_visits(before, after)) {
+                std::printf("%s lost, added or moved a depot visit\n", kMoveNames[move]);
+                return false;
+            }
+            const double change = cost(problem, after) - cost(problem, before);
+            if (std::fabs(change - delta) > 1e-6) {
+                std::printf("%s priced a move at %f that changed the cost by %f\n", kMoveNames[move], delta, change);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void report() const {
+        for (int move = 0; move < kMoveCount; ++move) {
+            std::printf("%-9s %8ld checked, %8ld feasible\n", kMoveNames[move], checked_[move], feasible_[move]);
+        }
+    }
+
+private:
+    static double cost(const Problem& problem, const std::vector<IntersectionIdx>& path) {
+        double total = 0;
+        for (std::size_t p = 1; p < path.size(); ++p) {
+            total += problem.matrix.cost(problem.intersection_to_index.at(path[p - 1]),
+                                         problem.intersection_to_index.at(path[p]));
+        }
+        return total;
+    }
+
+    // Some visit of every pick-up comes before some visit of its drop-off, between the depots
+    static bool legal(const Problem& problem, const std::vector<IntersectionIdx>& path) {
+        const auto inner_end = path.end() - 1;
+        for (const auto& [pick_up, drop_off] : problem.deliveries) {
+            const auto picked = std::find(path.begin() + 1, inner_end, pick_up);
+            if (picked == inner_end || std::find(picked + 1, inner_end, drop_off) == inner_end) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static bool same_visits(std::vector<IntersectionIdx> before, std::vector<IntersectionIdx> after) {
+        if (after.front() != before.front() || after.back() != before.back()) {
+            return false;
+        }
+        std::sort(before.begin(), before.end());
+        std::sort(after.begin(), after.end());
+        return before == after;
+    }
+
+    std::mt19937 random_;
+    std::array<long, kMoveCount> checked_{};
+    std::array<long, kMoveCount> feasible_{};
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const int instances = argc > 1 ? std::atoi(argv[1]) : 300;
+    const unsigned seed = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 1;
+    Checker checker(seed);
+    for (int instance = 0; instance < instances; ++instance) {
+        const Problem problem = checker.problem();
+        // too few visits between the depots for every move to have room
+        if (problem.start_path.size() < 6) {
+            continue;
+        }
+        if (!checker.check(problem, 3000)) {
+            std::printf("instance %d (seed %u) failed\n", instance, seed);
+            return 1;
+        }
+    }
+    checker.report();
+    return 0;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "converter/schema.hpp"
+
+#include <cstddef>
+#include <filesystem>
+
+namespace gisevo::converter {
+
+struct ChangeSummary {
+  std::size_t node_changes = 0;
+  std::size_t way_changes = 0;
+  std::size_t missing_node_refs = 0;  // references to nodes that are in neither the map nor the change
+  bool streets_changed = false;  // the nodes or ways differ from the ones read back, not just touched
+  bool pois_changed = false;     // likewise for the POIs
+};
+
+// Applies an OSM change file (.osc or .osc.gz) to a dataset read back with read_map_binaries().
+// Created and modified highway ways replace their old record (new ways are appended); a way that
+// is deleted or loses its highway tag is removed. Node changes update the stored locations and
+// POIs. Only nodes still referenced by a way are kept, as in a full conversion. The tables are
+// rebuilt with nodes and ways in OSM id order, so way, segment, street and intersection indices
+// can shift when ways are added or removed.
+ChangeSummary apply_change_file(ConverterData& data, const std::filesystem::path& change_file);
+
+}  // namespace gisevo::converter
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace gisevo::converter {
+
+// 64-bit hash of a byte range, stored in the headers of the converter's files so the runtime
+// can tell two versions of a map apart without reading them. Four independent
+// multiply-xorshift lanes over 8-byte words, so hashing a large map is bound by writing it
+// rather than by the multiply latency. Pass the hash of the previous range as `seed` to hash
+// several ranges as one.
+inline std::uint64_t content_hash(const void* data, std::size_t size, std::uint64_t seed = 0) {
+  constexpr std::uint64_t kMultiplier = 0x9E3779B97F4A7C15ULL;
+  const auto* bytes = static_cast<const unsigned char*>(data);
+  std::uint64_t lanes[4] = {seed ^ size, seed ^ size ^ 0x243F6A8885A308D3ULL,
+                            seed ^ size ^ 0x13198A2E03707344ULL, seed ^ size ^ 0xA4093822299F31D0ULL};
+  std::size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    for (int lane = 0; lane < 4; ++lane) {
+      std::uint64_t word;
+      std::memcpy(&word, bytes + i + 8 * lane, sizeof(word));
+      lanes[lane] = (lanes[lane] ^ word) * kMultiplier;
+      lanes[lane] ^= lanes[lane] >> 29;
+    }
+  }
+  for (; i < size; ++i) {
+    lanes[0] = (lanes[0] ^ bytes[i]) * kMultiplier;
+  }
+  std::uint64_t hash = 0;
+  for (const std::uint64_t lane : lanes) {
+    hash = (hash ^ lane) * kMultiplier;
+    hash ^= hash >> 32;
+  }
+  return hash;
+}
+
+}  // namespace gisevo::converter
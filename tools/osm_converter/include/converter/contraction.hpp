@@ -0,0 +1,38 @@
+#pragma once
+
+#include "converter/schema.hpp"
+#include "converter/street_tables.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace gisevo::converter {
+
+// The kCh* sections of streets.bin
+struct ContractionHierarchy {
+  std::vector<std::uint32_t> ranks;
+  std::vector<std::uint32_t> up_edge_offsets;
+  std::vector<ChEdge> up_edges;
+  std::vector<std::uint32_t> down_edge_offsets;
+  std::vector<ChEdge> down_edges;
+};
+
+// Contracts the intersections of the routing graph one at a time, cheapest first (fewest
+// shortcuts added relative to edges removed, spread out by the number of neighbours already
+// contracted). Contracting an intersection adds a shortcut between each pair of its remaining
+// neighbours unless a bounded witness search finds a path at least as fast around it, so the
+// shortest path between any two intersections is a path that only goes up in rank and then
+// only down. Parallel segments keep only the fastest, and self loops are dropped; neither is
+// ever on a shortest path.
+ContractionHierarchy build_contraction_hierarchy(const StreetTables& tables);
+
+// Contracts in a given order, such as the ranks of an earlier hierarchy of the same graph whose
+// travel times have since changed. Any order gives correct routes, and skipping the priority
+// updates, which run witness searches around every intersection each time a neighbour is
+// contracted, saves most of the time; the result may have a few more shortcuts than a fresh
+// order would give.
+ContractionHierarchy build_contraction_hierarchy(const StreetTables& tables,
+                                                 std::span<const std::uint32_t> ranks);
+
+}  // namespace gisevo::converter
@@ -11,6 +11,17 @@ struct ConverterConfig {
   std::string map_name;
   bool force_rebuild = false;
   bool quiet = false;
+  // Decoder threads; 0 uses libosmium's default (OSMIUM_POOL_THREADS, else all cores but two)
+  int threads = 0;
+  // Contraction is the slowest step of a conversion; without the hierarchy, the runtime answers
+  // queries without a turn penalty with its landmark (ALT) search instead
+  bool contract = true;
+  // When set, <map_name>.speeds.bin is written from this speed profile description (see
+  // read_speed_profiles), also for existing binaries that are otherwise left alone
+  std::filesystem::path speed_profiles;
+  // When set, the existing binaries for map_name are patched from this .osc instead of
+  // converting input_pbf; input_pbf is then only used to derive the default map name
+  std::filesystem::path change_file;
 };
 
 int run_converter(const ConverterConfig& config);
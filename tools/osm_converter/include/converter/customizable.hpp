@@ -0,0 +1,29 @@
+#pragma once
+
+#include "converter/schema.hpp"
+#include "converter/street_tables.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace gisevo::converter {
+
+// The kCch* sections of streets.bin
+struct CustomizableHierarchy {
+  std::vector<std::uint32_t> ranks;
+  std::vector<std::uint32_t> arc_offsets;
+  std::vector<std::int32_t> arcs;
+  std::vector<std::uint32_t> edge_arcs;
+};
+
+// The metric independent half of a customizable contraction hierarchy. Intersections are ordered
+// by geometric nested dissection: each cell of the network is cut by the straight line (of a few
+// directions and positions) that leaves the fewest intersections on one side with a segment
+// across, those intersections are ranked above the rest of the cell, and the two halves are
+// dissected in turn. Eliminating the intersections in that order without witness searches then
+// connects the higher ranked neighbours of each intersection to one another. Nothing depends on
+// travel times or segment directions, so the runtime fits any weights to the arcs in one pass
+// over their lower triangles (see m3_algo/route_metrics.hpp).
+CustomizableHierarchy build_customizable_hierarchy(const StreetTables& tables);
+
+}  // namespace gisevo::converter
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "converter/map_writer.hpp"
+#include "converter/schema.hpp"
+
+#include <cstdint>
+#include <filesystem>
+
+namespace gisevo::converter {
+
+// Reads a streets.bin/osm.bin pair written by this version of the converter back into
+// ConverterData. Way references come back as OSM node ids, limited to the nodes that were
+// resolved when the files were written. Throws std::runtime_error on a missing, corrupt or
+// outdated file.
+ConverterData read_map_binaries(const std::filesystem::path& streets_file,
+                                const std::filesystem::path& osm_file);
+
+// Also reads back the hierarchies of streets.bin and the routing graph they were built for
+ConverterData read_map_binaries(const std::filesystem::path& streets_file,
+                                const std::filesystem::path& osm_file, StreetHierarchies& hierarchies);
+
+// FileHeader::content_hash of a streets.bin written by this version of the converter, read
+// without loading the rest of the file
+std::uint64_t read_streets_content_hash(const std::filesystem::path& streets_file);
+
+}  // namespace gisevo::converter
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "converter/contraction.hpp"
+#include "converter/customizable.hpp"
+#include "converter/schema.hpp"
+#include "converter/speed_profiles.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace gisevo::converter {
+
+// Both writers build the file next to the target and rename it into place, so a map that is
+// currently memory-mapped by the application is never truncated underneath it.
+
+// The hierarchies of an earlier streets.bin and the routing graph they were built for, read
+// back by read_map_binaries() so that applying a change file need not rebuild them
+struct StreetHierarchies {
+  std::vector<std::uint32_t> intersection_segment_offsets;
+  std::vector<std::int32_t> intersection_adjacent;
+  std::vector<std::uint32_t> routing_edge_offsets;
+  std::vector<RoutingEdge> routing_edges;
+  ContractionHierarchy contraction;
+  CustomizableHierarchy customizable;
+};
+
+// Writes the street network, including the precomputed intersection graph from
+// build_street_tables(), as a sectioned streets.bin (kStreetsSchemaVersion). Without `contract`
+// the kCh* and kCch* sections are written empty. Returns the content hash of the file.
+//
+// With `previous`, hierarchies built for the same routing graph are reused. If the new graph has
+// the same intersections, segments and edges in the same order, the customizable hierarchy
+// (which ignores travel times) is copied, and so is the contraction hierarchy if the travel
+// times are the same too (e.g. only names changed). If they differ (nodes moved), the graph is
+// contracted again in the previous order, which skips choosing one.
+std::uint64_t write_streets_file(const ConverterData& data, const std::filesystem::path& output_file,
+                                 bool contract, const StreetHierarchies* previous = nullptr);
+
+// Writes the profile of every street segment of the network (numbered as write_streets_file
+// numbers them) as a sectioned speeds.bin (kSpeedProfilesSchemaVersion), stamped with the
+// content hash of the streets.bin holding that network so the runtime can tell a stale one
+void write_speed_profiles_file(const ConverterData& data, const SpeedProfileSet& profiles,
+                               std::uint64_t streets_hash, const std::filesystem::path& output_file);
+
+// Writes the POIs as an osm.bin record stream (kOsmSchemaVersion)
+void write_osm_file(const ConverterData& data, const std::filesystem::path& output_file);
+
+}  // namespace gisevo::converter
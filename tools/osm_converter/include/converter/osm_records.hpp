@@ -0,0 +1,20 @@
+#pragma once
+
+#include "converter/schema.hpp"
+
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <optional>
+
+namespace gisevo::converter {
+
+// Street record for a highway=* way with at least two node references, nullopt otherwise.
+// Ways tagged oneway=-1/reverse have their references reversed so they run in the direction
+// of travel.
+std::optional<StreetSegmentRecord> make_street_record(const osmium::Way& way);
+
+// POI record for a node whose tags match one of the POI categories, nullopt otherwise
+std::optional<PoiRecord> make_poi_record(const osmium::Node& node);
+
+}  // namespace gisevo::converter
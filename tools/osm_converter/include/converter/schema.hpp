@@ -1,19 +1,222 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
 
 namespace gisevo::converter {
 
-inline constexpr std::uint32_t kSchemaVersion = 1;
+// streets.bin is a sectioned file (see FileHeader); osm.bin is still a record stream.
+// v3 adds the intersection graph and derived per-street tables; v4 adds the tile index and
+// numbers intersections tile by tile; v5 adds the routing edge table; v6 sorts the ways by id
+// and adds way lengths; v7 adds the contraction hierarchy; v8 adds the customizable hierarchy;
+// v9 records a content hash in the header; v10 drops the tile index and numbers intersections
+// by node again. osm.bin v2 stores a content hash after the version.
+inline constexpr std::uint32_t kStreetsSchemaVersion = 10;
+inline constexpr std::uint32_t kOsmSchemaVersion = 2;
 inline constexpr char kStreetsMagic[8] = {'G', 'I', 'S', 'E', 'V', 'O', 'S', '1'};
 inline constexpr char kOsmMagic[8] = {'G', 'I', 'S', 'E', 'V', 'O', 'O', '1'};
 
+// The runtime's cache of what loadMap derives from a map (src/load_cache) is a sectioned file
+// too, with its own magic and the kCache* section ids. The version covers the file layout;
+// the code that fills it is versioned by the key stored inside. v2 adds the routing landmarks;
+// v3 keys it on the content hashes of the map headers.
+inline constexpr std::uint32_t kLoadCacheSchemaVersion = 3;
+inline constexpr char kLoadCacheMagic[8] = {'G', 'I', 'S', 'E', 'V', 'O', 'C', '1'};
+
+// Weekly speed profiles (osm_converter --speed-profiles) are an optional side file,
+// <map>.speeds.bin, sectioned too with its own magic and the kProfile* section ids. v2 records
+// the content hash of the streets.bin it was written for.
+inline constexpr std::uint32_t kSpeedProfilesSchemaVersion = 2;
+inline constexpr char kSpeedProfilesMagic[8] = {'G', 'I', 'S', 'E', 'V', 'O', 'P', '1'};
+inline constexpr std::uint32_t kMinutesPerWeek = 7 * 24 * 60;
+
+// Every section starts on a cache-line boundary so it can be mapped as a typed array.
+inline constexpr std::size_t kSectionAlignment = 64;
+
+// Fixed header at offset 0 of a sectioned file, followed by `section_count` SectionEntry
+// records (the table of contents) and then the section payloads.
+struct FileHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t section_count;
+  std::uint64_t file_size;
+  std::uint64_t content_hash;  // content_hash() of the table of contents, then each payload
+  std::uint8_t reserved[32];
+};
+static_assert(sizeof(FileHeader) == 64);
+
+struct SectionEntry {
+  std::uint32_t id;            // SectionId
+  std::uint32_t element_size;  // bytes per element, checked against the reader's type
+  std::uint64_t offset;        // from the start of the file, multiple of kSectionAlignment
+  std::uint64_t count;         // number of elements
+  std::uint64_t reserved;
+};
+static_assert(sizeof(SectionEntry) == 32);
+
+// Sections of streets.bin. Arrays indexed by the same entity share a count (structure of
+// arrays); `*Offsets` sections hold count + 1 entries delimiting runs in the matching array.
+// Offsets into node reference arrays are uint64, offsets into segment/intersection lists uint32.
+enum class SectionId : std::uint32_t {
+  kNodeIds = 1,         // int64 OSM id per node, sorted ascending
+  kNodeLat,             // double
+  kNodeLon,             // double
+  kWayIds,              // int64 OSM id per highway way, sorted ascending
+  kWayCategories,       // uint8 HighwayCategory
+  kWayFlags,            // uint8 kWayFlag* bits
+  kWaySpeeds,           // float maxspeed in km/h, <= 0 if untagged
+  kWayNames,            // uint32 string index
+  kWayNodeOffsets,      // uint64, way count + 1
+  kWayNodes,            // uint32 node index
+  kStringOffsets,       // uint64, string count + 1; string 0 is ""
+  kStringData,          // char, not NUL terminated
+
+  // intersection graph: ways split at every node shared by two or more ways and at way ends
+  kIntersectionNodes,           // uint32 node index
+  kIntersectionSegmentOffsets,  // uint32, intersection count + 1
+  kIntersectionSegments,        // int32 segment index
+  kIntersectionAdjacent,        // int32 intersection at the far end of the matching kIntersectionSegments entry
+  kSegmentWays,                 // uint32 way index
+  kSegmentFrom,                 // int32 intersection
+  kSegmentTo,                   // int32 intersection
+  kSegmentStreets,              // int32 street
+  kSegmentFlags,                // uint8 kWayFlag* bits of the way
+  kSegmentSpeeds,               // float speed limit in m/s (maxspeed or the category default)
+  kSegmentLengths,              // double metres along the curve points
+  kSegmentTravelTimes,          // double seconds at the speed limit
+  kSegmentCurveOffsets,         // uint64, segment count + 1
+  kCurveNodes,                  // uint32 node index
+
+  // streets are the distinct way names; street 0 is "<unknown>" and holds the unnamed ways
+  kStreetNames,                 // uint32 string index
+  kStreetKeys,                  // uint32 string index of the lower case, space free search key
+  kStreetsByKey,                // int32 street ids ordered by search key, then id
+  kStreetLengths,               // double metres
+  kStreetSegmentOffsets,        // uint32, street count + 1
+  kStreetSegments,              // int32 segment index, ascending
+  kStreetIntersectionOffsets,   // uint32, street count + 1
+  kStreetIntersections,         // int32 intersection index, ascending and unique
+
+  kSummary,                     // one NetworkSummary
+
+  // the graph as the searches walk it: per intersection, the segments that can be left along
+  // (one way segments only from their `from` end), in kIntersectionSegments order
+  kRoutingEdgeOffsets,          // uint32, intersection count + 1
+  kRoutingEdges,                // RoutingEdge
+
+  kWayLengths,                  // double metres along the way's nodes, per way
+
+  // contraction hierarchy over the routing edges (see contraction.hpp). Each edge between two
+  // intersections is stored once, at its lower ranked end.
+  kChRanks,                     // uint32 contraction order per intersection, unique
+  kChUpEdgeOffsets,             // uint32, intersection count + 1
+  kChUpEdges,                   // ChEdge to a higher ranked intersection
+  kChDownEdgeOffsets,           // uint32, intersection count + 1
+  kChDownEdges,                 // ChEdge from a higher ranked intersection
+
+  // metric independent customizable hierarchy (see customizable.hpp): the routing graph with
+  // directions and weights dropped, ordered by nested dissection and completed so that the
+  // higher ranked neighbours of every intersection are all connected to each other
+  kCchRanks,                    // uint32 elimination order per intersection, unique
+  kCchArcOffsets,               // uint32, intersection count + 1
+  kCchArcs,                     // int32 higher ranked neighbour, by ascending rank
+  kCchEdgeArcs,                 // uint32 kCchArcs index per routing edge, kNoCchArc for self loops
+
+  // load cache sections; the record types are defined by the runtime (src/load_cache)
+  kCacheKey = 1000,             // one key identifying the map files and the code version
+  kCacheStringOffsets,          // uint64, string count + 1
+  kCacheStringData,             // char
+  kCacheSegments,               // per street segment render and label data
+  kCacheSegmentLineOffsets,     // uint32, segment count + 1
+  kCacheSegmentLines,
+  kCacheSegmentArrowOffsets,    // uint32, segment count + 1
+  kCacheSegmentArrows,
+  kCacheSegmentZoomOffsets,     // uint32, segment count + 1
+  kCacheSegmentZoomLevels,
+  kCacheSegmentTextOffsets,     // uint32, segment count + 1
+  kCacheSegmentTexts,
+  kCacheWays,
+  kCacheWayPointOffsets,        // uint64, way count + 1
+  kCacheWayPoints,
+  kCacheFeatures,               // closed features, then open features
+  kCacheFeaturePointOffsets,    // uint64, feature count + 1
+  kCacheFeaturePoints,
+  kCachePois,                   // in bucket order
+  kCacheSubwayLines,
+  kCacheSubwayWayOffsets,       // uint32, subway line count + 1
+  kCacheSubwayPointOffsets,     // uint64, subway way count + 1
+  kCacheSubwayPoints,
+  kCacheLandmarkUnit,           // double, seconds per step of kCacheLandmarkTimes
+  kCacheLandmarks,              // int32 intersection per landmark
+  kCacheLandmarkTimes,          // uint16 per intersection: times to, then from, each landmark
+
+  // speed profile sections; profiles are shared, so a map needs few of them
+  kProfileBreakpointOffsets = 2000,  // uint32, profile count + 1; profile 0 is free flow and has none
+  kProfileBreakpoints,               // SpeedBreakpoint, ascending minute within a profile
+  kSegmentProfiles,                  // uint16 profile per street segment
+  kProfileStreetsHash,               // uint64, FileHeader::content_hash of the matching streets.bin
+};
+
+inline constexpr std::uint8_t kWayFlagOneWay = 1U << 0;
+
+inline constexpr const char* kUnknownStreetName = "<unknown>";
+
+// Whole-map aggregates the runtime would otherwise compute with a pass over every node or segment
+struct NetworkSummary {
+  double min_lat;
+  double max_lat;
+  double min_lon;
+  double max_lon;
+  float max_speed;  // fastest segment speed limit in m/s
+  std::uint8_t reserved[28];
+};
+static_assert(sizeof(NetworkSummary) == 64);
+
+// Everything a graph search reads to relax one edge, packed so an intersection's edges are
+// one contiguous run
+struct RoutingEdge {
+  std::int32_t segment;
+  std::int32_t to;      // intersection at the far end
+  std::int32_t street;  // for turn penalties
+  std::uint32_t reserved;
+  double travel_time;   // seconds, same as kSegmentTravelTimes
+};
+static_assert(sizeof(RoutingEdge) == 24);
+
+// Corner of a piecewise linear weekly speed profile; the profile runs linearly from one corner to
+// the next, and from the last back round to the first
+struct SpeedBreakpoint {
+  std::uint16_t minute;          // of the week, from Monday 00:00
+  std::uint16_t speed_permille;  // of the segment's speed limit, 1 to 1000
+};
+static_assert(sizeof(SpeedBreakpoint) == 4);
+
+// Profile of the segments without one, driven at the speed limit all week
+inline constexpr std::uint16_t kFreeFlowProfile = 0;
+
+inline constexpr std::int32_t kChShortcut = -1;
+inline constexpr std::uint32_t kNoCchArc = 0xFFFFFFFFu;
+
+// Edge of the contraction hierarchy. An up edge leads from the intersection owning it to `to`;
+// a down edge leads from `to` into the intersection owning it. A shortcut stands for the down
+// edge `first` into the intersection it bypasses followed by the up edge `second` out of it.
+struct ChEdge {
+  std::int32_t to;
+  std::int32_t segment;  // the street segment, or kChShortcut
+  std::uint32_t first;   // kChDownEdges index, shortcuts only
+  std::uint32_t second;  // kChUpEdges index, shortcuts only
+  double travel_time;    // seconds
+};
+static_assert(sizeof(ChEdge) == 24);
+
 struct NodeRecord {
   std::int64_t osm_id;
   double lat;
   double lon;
+
+  bool operator==(const NodeRecord&) const = default;
 };
 
 enum class HighwayCategory : std::uint8_t {
@@ -31,12 +234,53 @@ enum class HighwayCategory : std::uint8_t {
   kCycleway,
 };
 
+// OSM highway value written back for a category (the `_link` variants collapse onto their parent).
+constexpr const char* highway_category_name(HighwayCategory category) {
+  switch (category) {
+    case HighwayCategory::kMotorway: return "motorway";
+    case HighwayCategory::kTrunk: return "trunk";
+    case HighwayCategory::kPrimary: return "primary";
+    case HighwayCategory::kSecondary: return "secondary";
+    case HighwayCategory::kTertiary: return "tertiary";
+    case HighwayCategory::kResidential: return "residential";
+    case HighwayCategory::kService: return "service";
+    case HighwayCategory::kTrack: return "track";
+    case HighwayCategory::kFootway: return "footway";
+    case HighwayCategory::kPath: return "path";
+    case HighwayCategory::kCycleway: return "cycleway";
+    case HighwayCategory::kUnknown: break;
+  }
+  return "road";
+}
+
+// Speed assumed when a way has no usable maxspeed tag (max_speed_kph <= 0).
+constexpr float default_speed_kph(HighwayCategory category) {
+  switch (category) {
+    case HighwayCategory::kMotorway: return 100.0F;
+    case HighwayCategory::kTrunk: return 80.0F;
+    case HighwayCategory::kPrimary: return 60.0F;
+    case HighwayCategory::kSecondary: return 50.0F;
+    case HighwayCategory::kTertiary: return 50.0F;
+    case HighwayCategory::kResidential: return 40.0F;
+    case HighwayCategory::kService: return 20.0F;
+    case HighwayCategory::kTrack: return 20.0F;
+    case HighwayCategory::kFootway: return 5.0F;
+    case HighwayCategory::kPath: return 5.0F;
+    case HighwayCategory::kCycleway: return 15.0F;
+    case HighwayCategory::kUnknown: break;
+  }
+  return 40.0F;
+}
+
 struct StreetSegmentRecord {
   std::int64_t osm_id;
   HighwayCategory category;
   float max_speed_kph;
+  bool one_way = false;  // node_refs are already in the direction of travel
   std::string name;
   std::vector<std::int64_t> node_refs;
+
+  bool operator==(const StreetSegmentRecord&) const = default;
 };
 
 struct PoiRecord {
@@ -45,6 +289,8 @@ struct PoiRecord {
   double lon;
   std::string category;
   std::string name;
+
+  bool operator==(const PoiRecord&) const = default;
 };
 
 struct ConverterData {
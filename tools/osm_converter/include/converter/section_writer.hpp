@@ -0,0 +1,46 @@
+#pragma once
+
+#include "converter/schema.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace gisevo::converter {
+
+// Collects typed arrays and writes them as a sectioned file (FileHeader + table of
+// contents + 64-byte aligned payloads). The arrays are not copied, so they must outlive
+// the call to write().
+class SectionWriter {
+ public:
+  template <typename T>
+  void add(SectionId id, std::span<const T> values) {
+    static_assert(std::is_trivially_copyable_v<T>, "sections hold plain data");
+    sections_.push_back(PendingSection{id, static_cast<std::uint32_t>(sizeof(T)),
+                                       reinterpret_cast<const char*>(values.data()), values.size()});
+  }
+
+  template <typename T>
+  void add(SectionId id, const std::vector<T>& values) {
+    add(id, std::span<const T>(values));
+  }
+
+  // Returns the content hash recorded in the header
+  std::uint64_t write(const std::filesystem::path& output_file, const char (&magic)[8],
+                      std::uint32_t version) const;
+
+ private:
+  struct PendingSection {
+    SectionId id;
+    std::uint32_t element_size;
+    const char* data;
+    std::size_t count;
+  };
+
+  std::vector<PendingSection> sections_;
+};
+
+}  // namespace gisevo::converter
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "converter/schema.hpp"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gisevo::converter {
+
+// Speed profiles and the ways they apply to, as read from a description file. Profile i of the
+// file gets id i + 1; id 0 (kFreeFlowProfile) drives at the speed limit all week.
+struct SpeedProfileSet {
+  std::vector<std::string> names;
+  std::vector<std::vector<SpeedBreakpoint>> profiles;    // corners sorted by minute
+  std::array<std::uint16_t, 256> category_profiles{};    // by HighwayCategory
+  std::unordered_map<std::int64_t, std::uint16_t> way_profiles;  // by OSM way id, over the category
+};
+
+// Reads a speed profile description. Each line is one of
+//
+//   profile <name> <day><hh:mm>=<percent> ...   a profile with its corners, e.g. Mon08:00=45 is
+//                                               45% of the speed limit at 8am on Mondays
+//   highway <category> <name>                   every way of a category (highway_category_name)
+//   way <osm id> <name>                         one way, overriding its category
+//
+// with '#' starting a comment. Throws std::runtime_error, naming the line, on anything else.
+SpeedProfileSet read_speed_profiles(const std::filesystem::path& description);
+
+}  // namespace gisevo::converter
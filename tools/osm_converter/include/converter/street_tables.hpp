@@ -0,0 +1,70 @@
+#pragma once
+
+#include "converter/schema.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gisevo::converter {
+
+// Structure-of-arrays form of the street network, one vector per streets.bin section
+struct StreetTables {
+  std::vector<std::int64_t> node_ids;
+  std::vector<double> node_lat;
+  std::vector<double> node_lon;
+
+  std::vector<std::int64_t> way_ids;
+  std::vector<std::uint8_t> way_categories;
+  std::vector<std::uint8_t> way_flags;
+  std::vector<float> way_speeds;
+  std::vector<std::uint32_t> way_names;
+  std::vector<std::uint64_t> way_node_offsets;
+  std::vector<std::uint32_t> way_nodes;
+  std::vector<double> way_lengths;
+
+  std::vector<std::uint64_t> string_offsets;
+  std::vector<char> string_data;
+
+  std::vector<std::uint32_t> intersection_nodes;
+  std::vector<std::uint32_t> intersection_segment_offsets;
+  std::vector<std::int32_t> intersection_segments;
+  std::vector<std::int32_t> intersection_adjacent;
+  std::vector<std::uint32_t> routing_edge_offsets;
+  std::vector<RoutingEdge> routing_edges;
+
+  std::vector<std::uint32_t> segment_ways;
+  std::vector<std::int32_t> segment_from;
+  std::vector<std::int32_t> segment_to;
+  std::vector<std::int32_t> segment_streets;
+  std::vector<std::uint8_t> segment_flags;
+  std::vector<float> segment_speeds;
+  std::vector<double> segment_lengths;
+  std::vector<double> segment_travel_times;
+  std::vector<std::uint64_t> segment_curve_offsets;
+  std::vector<std::uint32_t> curve_nodes;
+
+  std::vector<std::uint32_t> street_names;
+  std::vector<std::uint32_t> street_keys;
+  std::vector<std::int32_t> streets_by_key;
+  std::vector<double> street_lengths;
+  std::vector<std::uint32_t> street_segment_offsets;
+  std::vector<std::int32_t> street_segments;
+  std::vector<std::uint32_t> street_intersection_offsets;
+  std::vector<std::int32_t> street_intersections;
+
+  NetworkSummary summary{};
+};
+
+// Sorts the nodes and ways by OSM id, resolves way references to node indices (dropping references to
+// nodes without a location, and ways left with fewer than two), then splits the ways into the
+// intersection graph and derives the per-street tables.
+StreetTables build_street_tables(const ConverterData& data);
+
+// Great-circle distance approximation used by the runtime's findDistanceBetweenTwoPoints
+double distance_between_points_m(double lat1, double lon1, double lat2, double lon2);
+
+// Street search key: ASCII upper case folded to lower case and spaces removed
+std::string street_search_key(std::string name);
+
+}  // namespace gisevo::converter
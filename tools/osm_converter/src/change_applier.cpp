@@ -0,0 +1,138 @@
+#include "converter/change_applier.hpp"
+
+#include "converter/osm_records.hpp"
+
+#include <osmium/handler.hpp>
+#include <osmium/io/gzip_compression.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/io/xml_input.hpp>
+#include <osmium/visitor.hpp>
+
+#include <algorithm>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace gisevo::converter {
+namespace {
+
+// Latest version of every object in the change file, in order of first appearance;
+// nullopt means the object no longer contributes a record
+template <typename T>
+class PendingChanges {
+ public:
+  void set(std::int64_t id, std::optional<T> record) {
+    auto [iter, inserted] = index_.try_emplace(id, entries_.size());
+    if (inserted) {
+      entries_.emplace_back(std::move(record));
+    } else {
+      entries_[iter->second] = std::move(record);
+    }
+  }
+
+  // Replaces or removes the records that changed, keeping the order of the rest, and
+  // appends the new ones. Returns whether any record is now different; a change that restates
+  // a record as it was (e.g. a new version with the same tags) does not count.
+  bool apply(std::vector<T>& records) const {
+    std::vector<bool> used(entries_.size(), false);
+    std::vector<T> result;
+    result.reserve(records.size() + entries_.size());
+    bool changed = false;
+    for (auto& record : records) {
+      const auto change = index_.find(record.osm_id);
+      if (change == index_.end()) {
+        result.push_back(std::move(record));
+        continue;
+      }
+      used[change->second] = true;
+      const auto& replacement = entries_[change->second];
+      changed = changed || !replacement || !(*replacement == record);
+      if (replacement) {
+        result.push_back(*replacement);
+      }
+    }
+    for (std::size_t i = 0; i < entries_.size(); ++i) {
+      if (!used[i] && entries_[i]) {
+        result.push_back(*entries_[i]);
+        changed = true;
+      }
+    }
+    records = std::move(result);
+    return changed;
+  }
+
+ private:
+  std::unordered_map<std::int64_t, std::size_t> index_;
+  std::vector<std::optional<T>> entries_;
+};
+
+class ChangeCollector final : public osmium::handler::Handler {
+ public:
+  explicit ChangeCollector(ChangeSummary& summary) : summary_(summary) {}
+
+  void node(const osmium::Node& node) {
+    ++summary_.node_changes;
+    std::optional<NodeRecord> record;
+    if (node.visible() && node.location().valid()) {
+      record = NodeRecord{node.id(), node.location().lat(), node.location().lon()};
+    }
+    nodes.set(node.id(), record);
+    pois.set(node.id(), node.visible() ? make_poi_record(node) : std::nullopt);
+  }
+
+  void way(const osmium::Way& way) {
+    ++summary_.way_changes;
+    ways.set(way.id(), way.visible() ? make_street_record(way) : std::nullopt);
+  }
+
+  PendingChanges<NodeRecord> nodes;
+  PendingChanges<StreetSegmentRecord> ways;
+  PendingChanges<PoiRecord> pois;
+
+ private:
+  ChangeSummary& summary_;
+};
+
+// Drops the nodes no way references any more and counts references that cannot be resolved
+std::size_t prune_nodes(ConverterData& data) {
+  std::vector<std::int64_t> refs;
+  for (const auto& way : data.street_segments) {
+    refs.insert(refs.end(), way.node_refs.begin(), way.node_refs.end());
+  }
+  std::sort(refs.begin(), refs.end());
+  refs.erase(std::unique(refs.begin(), refs.end()), refs.end());
+
+  std::sort(data.nodes.begin(), data.nodes.end(),
+            [](const NodeRecord& a, const NodeRecord& b) { return a.osm_id < b.osm_id; });
+  std::erase_if(data.nodes, [&](const NodeRecord& node) {
+    return !std::binary_search(refs.begin(), refs.end(), node.osm_id);
+  });
+  return refs.size() - data.nodes.size();
+}
+
+}  // namespace
+
+ChangeSummary apply_change_file(ConverterData& data, const fs::path& change_file) {
+  ChangeSummary summary;
+  ChangeCollector collector{summary};
+  {
+    osmium::io::Reader reader{change_file, osmium::osm_entity_bits::node | osmium::osm_entity_bits::way};
+    osmium::apply(reader, collector);
+    reader.close();
+  }
+
+  // new nodes no way references (most POIs) are pruned again, so the node table is compared as a
+  // whole rather than by whether a change touched it
+  const std::vector<NodeRecord> previous_nodes = data.nodes;
+  const bool ways_changed = collector.ways.apply(data.street_segments);
+  collector.nodes.apply(data.nodes);
+  summary.pois_changed = collector.pois.apply(data.pois);
+  summary.missing_node_refs = prune_nodes(data);
+  summary.streets_changed = ways_changed || data.nodes != previous_nodes;
+  return summary;
+}
+
+}  // namespace gisevo::converter
@@ -0,0 +1,293 @@
+#include "converter/contraction.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+namespace gisevo::converter {
+namespace {
+
+// A witness search gives up after settling this many intersections and the shortcut is added;
+// an unneeded shortcut costs space but never correctness
+constexpr std::size_t kWitnessSettleLimit = 500;
+constexpr std::uint32_t kNoEdge = std::numeric_limits<std::uint32_t>::max();
+constexpr double kInfinity = std::numeric_limits<double>::infinity();
+
+struct Edge {
+  std::int32_t from;
+  std::int32_t to;
+  std::int32_t segment;  // or kChShortcut
+  std::uint32_t first;   // shortcuts: the edges into and out of the bypassed intersection
+  std::uint32_t second;
+  double travel_time;
+};
+
+// An edge as seen from one of its ends
+struct Arc {
+  std::int32_t node;  // the other end
+  std::uint32_t edge;
+};
+
+class Contractor {
+ public:
+  explicit Contractor(const StreetTables& tables);
+  // Picks the order as it goes, or follows `ranks` when given
+  ContractionHierarchy run(std::span<const std::uint32_t> ranks = {});
+
+ private:
+  // Keeps only the fastest edge between two intersections
+  void add_edge(const Edge& edge);
+  // Number of shortcuts contracting node needs; they are added when `apply` is set
+  std::size_t shortcuts(std::int32_t node, bool apply);
+  std::int64_t priority(std::int32_t node);
+  void contract(std::int32_t node);
+  // Fills distance_ from source over the remaining graph without passing through `skip`,
+  // stopping past `limit` seconds or kWitnessSettleLimit intersections
+  void witness_search(std::int32_t source, std::int32_t skip, double limit);
+
+  std::vector<Edge> edges_;
+  // Edges between intersections that are not contracted yet
+  std::vector<std::vector<Arc>> out_;
+  std::vector<std::vector<Arc>> in_;
+  std::vector<std::uint32_t> contracted_neighbours_;
+  // Edges that became final when their lower ranked end was contracted
+  std::vector<std::vector<std::uint32_t>> up_;
+  std::vector<std::vector<std::uint32_t>> down_;
+
+  std::vector<double> distance_;
+  std::vector<std::int32_t> touched_;
+};
+
+Contractor::Contractor(const StreetTables& tables)
+    : out_(tables.intersection_nodes.size()),
+      in_(tables.intersection_nodes.size()),
+      contracted_neighbours_(tables.intersection_nodes.size(), 0),
+      up_(tables.intersection_nodes.size()),
+      down_(tables.intersection_nodes.size()),
+      distance_(tables.intersection_nodes.size(), kInfinity) {
+  for (std::size_t i = 0; i < tables.intersection_nodes.size(); ++i) {
+    for (std::uint32_t k = tables.routing_edge_offsets[i]; k < tables.routing_edge_offsets[i + 1]; ++k) {
+      const RoutingEdge& edge = tables.routing_edges[k];
+      if (edge.to != static_cast<std::int32_t>(i)) {
+        add_edge(Edge{static_cast<std::int32_t>(i), edge.to, edge.segment, 0, 0, edge.travel_time});
+      }
+    }
+  }
+}
+
+void Contractor::add_edge(const Edge& edge) {
+  for (const Arc& arc : out_[edge.from]) {
+    if (arc.node == edge.to) {
+      // Neither end is contracted, so nothing refers to the slower edge yet
+      if (edge.travel_time < edges_[arc.edge].travel_time) {
+        edges_[arc.edge] = edge;
+      }
+      return;
+    }
+  }
+  if (edges_.size() >= kNoEdge) {
+    throw std::runtime_error("Too many contraction hierarchy edges for 32-bit edge indices");
+  }
+  const auto id = static_cast<std::uint32_t>(edges_.size());
+  edges_.push_back(edge);
+  out_[edge.from].push_back(Arc{edge.to, id});
+  in_[edge.to].push_back(Arc{edge.from, id});
+}
+
+void Contractor::witness_search(std::int32_t source, std::int32_t skip, double limit) {
+  for (const std::int32_t node : touched_) {
+    distance_[node] = kInfinity;
+  }
+  touched_.clear();
+
+  using Entry = std::pair<double, std::int32_t>;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<>> queue;
+  distance_[source] = 0.0;
+  touched_.push_back(source);
+  queue.emplace(0.0, source);
+
+  std::size_t settled = 0;
+  while (!queue.empty()) {
+    const auto [distance, node] = queue.top();
+    queue.pop();
+    if (distance > distance_[node]) {
+      continue;
+    }
+    if (distance > limit || ++settled > kWitnessSettleLimit) {
+      break;
+    }
+    for (const Arc& arc : out_[node]) {
+      if (arc.node == skip) {
+        continue;
+      }
+      const double next = distance + edges_[arc.edge].travel_time;
+      if (next < distance_[arc.node]) {
+        if (distance_[arc.node] == kInfinity) {
+          touched_.push_back(arc.node);
+        }
+        distance_[arc.node] = next;
+        queue.emplace(next, arc.node);
+      }
+    }
+  }
+}
+
+std::size_t Contractor::shortcuts(std::int32_t node, bool apply) {
+  std::size_t count = 0;
+  for (const Arc& in : in_[node]) {
+    const double to_node = edges_[in.edge].travel_time;
+    double limit = -1.0;
+    for (const Arc& out : out_[node]) {
+      if (out.node != in.node) {
+        limit = std::max(limit, to_node + edges_[out.edge].travel_time);
+      }
+    }
+    if (limit < 0.0) {
+      continue;
+    }
+    witness_search(in.node, node, limit);
+    for (const Arc& out : out_[node]) {
+      const double via = to_node + edges_[out.edge].travel_time;
+      if (out.node == in.node || distance_[out.node] <= via) {
+        continue;
+      }
+      ++count;
+      if (apply) {
+        add_edge(Edge{in.node, out.node, kChShortcut, in.edge, out.edge, via});
+      }
+    }
+  }
+  return count;
+}
+
+std::int64_t Contractor::priority(std::int32_t node) {
+  const auto removed = static_cast<std::int64_t>(in_[node].size() + out_[node].size());
+  return static_cast<std::int64_t>(shortcuts(node, false)) - removed + contracted_neighbours_[node];
+}
+
+void Contractor::contract(std::int32_t node) {
+  for (const Arc& out : out_[node]) {
+    up_[node].push_back(out.edge);
+  }
+  for (const Arc& in : in_[node]) {
+    down_[node].push_back(in.edge);
+  }
+  shortcuts(node, true);
+
+  auto unlink = [&](std::vector<Arc>& arcs) {
+    for (std::size_t k = 0; k < arcs.size(); ++k) {
+      if (arcs[k].node == node) {
+        arcs[k] = arcs.back();
+        arcs.pop_back();
+        return;
+      }
+    }
+  };
+  for (const Arc& out : out_[node]) {
+    unlink(in_[out.node]);
+    ++contracted_neighbours_[out.node];
+  }
+  for (const Arc& in : in_[node]) {
+    unlink(out_[in.node]);
+    ++contracted_neighbours_[in.node];
+  }
+  out_[node] = {};
+  in_[node] = {};
+}
+
+ContractionHierarchy Contractor::run(std::span<const std::uint32_t> ranks) {
+  const std::size_t node_count = out_.size();
+  ContractionHierarchy hierarchy;
+  hierarchy.ranks.assign(node_count, 0);
+
+  if (!ranks.empty()) {
+    if (ranks.size() != node_count) {
+      throw std::runtime_error("Contraction order does not match the routing graph");
+    }
+    std::vector<std::int32_t> order(node_count, -1);
+    for (std::size_t i = 0; i < node_count; ++i) {
+      if (ranks[i] >= node_count || order[ranks[i]] != -1) {
+        throw std::runtime_error("Contraction order is not a permutation");
+      }
+      order[ranks[i]] = static_cast<std::int32_t>(i);
+    }
+    hierarchy.ranks.assign(ranks.begin(), ranks.end());
+    for (const std::int32_t node : order) {
+      contract(node);
+    }
+  } else {
+    // Priorities only change when a neighbour is contracted, so they are refreshed lazily: the
+    // cheapest entry is recomputed and put back if it is no longer the cheapest
+    using Entry = std::pair<std::int64_t, std::int32_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<>> queue;
+    for (std::size_t i = 0; i < node_count; ++i) {
+      queue.emplace(priority(static_cast<std::int32_t>(i)), static_cast<std::int32_t>(i));
+    }
+    std::uint32_t rank = 0;
+    while (!queue.empty()) {
+      const std::int32_t node = queue.top().second;
+      queue.pop();
+      const std::int64_t current = priority(node);
+      if (!queue.empty() && current > queue.top().first) {
+        queue.emplace(current, node);
+        continue;
+      }
+      hierarchy.ranks[node] = rank++;
+      contract(node);
+    }
+  }
+
+  std::vector<std::uint32_t> up_position(edges_.size(), kNoEdge);
+  std::vector<std::uint32_t> down_position(edges_.size(), kNoEdge);
+  std::uint32_t up_count = 0;
+  std::uint32_t down_count = 0;
+  for (std::size_t i = 0; i < node_count; ++i) {
+    for (const std::uint32_t edge : up_[i]) {
+      up_position[edge] = up_count++;
+    }
+    for (const std::uint32_t edge : down_[i]) {
+      down_position[edge] = down_count++;
+    }
+  }
+
+  auto to_ch_edge = [&](const Edge& edge, std::int32_t to) {
+    if (edge.segment != kChShortcut) {
+      return ChEdge{to, edge.segment, 0, 0, edge.travel_time};
+    }
+    return ChEdge{to, kChShortcut, down_position[edge.first], up_position[edge.second], edge.travel_time};
+  };
+  hierarchy.up_edge_offsets.reserve(node_count + 1);
+  hierarchy.up_edge_offsets.push_back(0);
+  hierarchy.up_edges.reserve(up_count);
+  hierarchy.down_edge_offsets.reserve(node_count + 1);
+  hierarchy.down_edge_offsets.push_back(0);
+  hierarchy.down_edges.reserve(down_count);
+  for (std::size_t i = 0; i < node_count; ++i) {
+    for (const std::uint32_t edge : up_[i]) {
+      hierarchy.up_edges.push_back(to_ch_edge(edges_[edge], edges_[edge].to));
+    }
+    for (const std::uint32_t edge : down_[i]) {
+      hierarchy.down_edges.push_back(to_ch_edge(edges_[edge], edges_[edge].from));
+    }
+    hierarchy.up_edge_offsets.push_back(static_cast<std::uint32_t>(hierarchy.up_edges.size()));
+    hierarchy.down_edge_offsets.push_back(static_cast<std::uint32_t>(hierarchy.down_edges.size()));
+  }
+  return hierarchy;
+}
+
+}  // namespace
+
+ContractionHierarchy build_contraction_hierarchy(const StreetTables& tables) {
+  return Contractor(tables).run();
+}
+
+ContractionHierarchy build_contraction_hierarchy(const StreetTables& tables,
+                                                 std::span<const std::uint32_t> ranks) {
+  return Contractor(tables).run(ranks);
+}
+
+}  // namespace gisevo::converter
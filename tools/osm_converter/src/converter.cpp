@@ -1,27 +1,28 @@
 #include "converter/converter.hpp"
 
+#include "converter/osm_records.hpp"
 #include "converter/schema.hpp"
+#include "converter/change_applier.hpp"
+#include "converter/map_reader.hpp"
+#include "converter/map_writer.hpp"
+#include "converter/speed_profiles.hpp"
 
+#include <osmium/index/map/flex_mem.hpp>
 #include <osmium/io/pbf_input.hpp>
 #include <osmium/io/reader.hpp>
+#include <osmium/osm/location.hpp>
 #include <osmium/osm/node.hpp>
-#include <osmium/osm/tag.hpp>
 #include <osmium/osm/way.hpp>
+#include <osmium/thread/pool.hpp>
 #include <osmium/visitor.hpp>
 
 #include <algorithm>
 #include <chrono>
-#include <cctype>
 #include <exception>
 #include <filesystem>
-#include <fstream>
 #include <iostream>
-#include <optional>
-#include <stdexcept>
 #include <string>
-#include <string_view>
-#include <unordered_map>
-#include <unordered_set>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -32,317 +33,237 @@ namespace {
 
 using osm_id = osmium::object_id_type;
 
+// Location of every node in the input. FlexMem starts as a sorted sparse array and switches
+// to a dense array once the ids are dense enough (full planets), so lookups never hash.
+using LocationIndex = osmium::index::map::FlexMem<osmium::unsigned_object_id_type, osmium::Location>;
+
 struct ConverterDataInternal {
   ConverterData data;
-  std::unordered_set<osm_id> referenced_nodes;
-  std::unordered_map<osm_id, std::size_t> node_index_lookup;
-  std::vector<osm_id> missing_node_ids;
+  std::size_t missing_node_count = 0;
 };
 
-std::string to_lower_copy(std::string_view value) {
-  std::string result(value);
-  std::transform(result.begin(), result.end(), result.begin(),
-                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
-  return result;
-}
-
-HighwayCategory encode_highway_category(const char* value) {
-  if (value == nullptr) {
-    return HighwayCategory::kUnknown;
-  }
-  const std::string lower = to_lower_copy(value);
-  if (lower == "motorway") return HighwayCategory::kMotorway;
-  if (lower == "motorway_link") return HighwayCategory::kMotorway;
-  if (lower == "trunk") return HighwayCategory::kTrunk;
-  if (lower == "trunk_link") return HighwayCategory::kTrunk;
-  if (lower == "primary") return HighwayCategory::kPrimary;
-  if (lower == "primary_link") return HighwayCategory::kPrimary;
-  if (lower == "secondary") return HighwayCategory::kSecondary;
-  if (lower == "secondary_link") return HighwayCategory::kSecondary;
-  if (lower == "tertiary") return HighwayCategory::kTertiary;
-  if (lower == "tertiary_link") return HighwayCategory::kTertiary;
-  if (lower == "residential") return HighwayCategory::kResidential;
-  if (lower == "living_street") return HighwayCategory::kResidential;
-  if (lower == "service") return HighwayCategory::kService;
-  if (lower == "track") return HighwayCategory::kTrack;
-  if (lower == "footway") return HighwayCategory::kFootway;
-  if (lower == "pedestrian") return HighwayCategory::kFootway;
-  if (lower == "path") return HighwayCategory::kPath;
-  if (lower == "cycleway") return HighwayCategory::kCycleway;
-  return HighwayCategory::kUnknown;
-}
-
-float parse_max_speed(const osmium::TagList& tags) {
-  const char* raw_value = tags.get_value_by_key("maxspeed");
-  if (!raw_value) {
-    return -1.0F;
-  }
-  std::string value = raw_value;
-  value.erase(std::remove_if(value.begin(), value.end(), ::isspace), value.end());
-  bool mph = false;
-  if (value.size() > 3) {
-    const std::string suffix = to_lower_copy(std::string_view(value).substr(value.size() - 3));
-    if (suffix == "mph") {
-      mph = true;
-      value.resize(value.size() - 3);
-    }
-  }
-  try {
-    const float numeric = std::stof(value);
-    if (mph) {
-      return numeric * 1.60934F;
-    }
-    return numeric;
-  } catch (const std::exception&) {
-    return -1.0F;
-  }
-}
-
-std::optional<std::string> detect_poi_category(const osmium::TagList& tags) {
-  if (const char* amenity = tags.get_value_by_key("amenity")) {
-    return std::string("amenity:") + amenity;
-  }
-  if (const char* shop = tags.get_value_by_key("shop")) {
-    return std::string("shop:") + shop;
-  }
-  if (const char* tourism = tags.get_value_by_key("tourism")) {
-    return std::string("tourism:") + tourism;
-  }
-  if (const char* leisure = tags.get_value_by_key("leisure")) {
-    return std::string("leisure:") + leisure;
-  }
-  if (const char* railway = tags.get_value_by_key("railway")) {
-    return std::string("railway:") + railway;
-  }
-  if (const char* public_transport = tags.get_value_by_key("public_transport")) {
-    return std::string("public_transport:") + public_transport;
-  }
-  if (const char* highway = tags.get_value_by_key("highway")) {
-    const std::string lower = to_lower_copy(highway);
-    if (lower == "bus_stop" || lower == "tram_stop" || lower == "platform") {
-      return std::string("highway:") + lower;
-    }
-  }
-  if (const char* aeroway = tags.get_value_by_key("aeroway")) {
-    return std::string("aeroway:") + aeroway;
-  }
-  return std::nullopt;
-}
-
 class HighwayCollector final : public osmium::handler::Handler {
  public:
   explicit HighwayCollector(ConverterDataInternal& internal)
     : internal_(internal) {}
 
   void way(const osmium::Way& way) {
-    const char* highway = way.tags().get_value_by_key("highway");
-    if (!highway) {
-      return;
+    if (auto record = make_street_record(way)) {
+      internal_.data.street_segments.emplace_back(std::move(*record));
     }
-
-    StreetSegmentRecord record;
-    record.osm_id = way.id();
-    record.category = encode_highway_category(highway);
-    record.max_speed_kph = parse_max_speed(way.tags());
-
-    if (const char* name = way.tags().get_value_by_key("name")) {
-      record.name = name;
-    }
-
-    for (const auto& node_ref : way.nodes()) {
-      internal_.referenced_nodes.insert(node_ref.ref());
-      record.node_refs.push_back(node_ref.ref());
-    }
-
-    if (record.node_refs.size() < 2) {
-      return;
-    }
-
-    internal_.data.street_segments.emplace_back(std::move(record));
   }
 
  private:
   ConverterDataInternal& internal_;
 };
 
+// Records every node location (highway ways are resolved against them after the pass, so the
+// input does not need to be sorted) and collects the POIs
 class NodeCollector final : public osmium::handler::Handler {
  public:
-  explicit NodeCollector(ConverterDataInternal& internal)
-      : internal_(internal) {}
+  NodeCollector(ConverterDataInternal& internal, LocationIndex& locations)
+      : internal_(internal), locations_(locations) {}
 
   void node(const osmium::Node& node) {
     if (!node.location().valid()) {
       return;
     }
 
-    const osm_id id = node.id();
-
-    if (internal_.referenced_nodes.contains(id)) {
-      NodeRecord record;
-      record.osm_id = id;
-      record.lat = node.location().lat();
-      record.lon = node.location().lon();
-
-      auto [iter, inserted] = internal_.node_index_lookup.emplace(id, internal_.data.nodes.size());
-      if (inserted) {
-        internal_.data.nodes.emplace_back(record);
-      }
+    // negative ids only appear in unsaved editor data, which the converter does not take
+    if (node.id() > 0) {
+      locations_.set(node.positive_id(), node.location());
     }
 
-    if (auto poi_category = detect_poi_category(node.tags())) {
-      PoiRecord poi;
-      poi.osm_id = id;
-      poi.lat = node.location().lat();
-      poi.lon = node.location().lon();
-      poi.category = std::move(*poi_category);
-      if (const char* name = node.tags().get_value_by_key("name")) {
-        poi.name = name;
-      }
-      internal_.data.pois.emplace_back(std::move(poi));
+    if (auto poi = make_poi_record(node)) {
+      internal_.data.pois.emplace_back(std::move(*poi));
     }
   }
 
  private:
   ConverterDataInternal& internal_;
+  LocationIndex& locations_;
 };
 
-class WayNodeValidator final : public osmium::handler::Handler {
- public:
-  explicit WayNodeValidator(ConverterDataInternal& internal)
-      : internal_(internal) {}
-
-  void way(const osmium::Way& way) {
-  if (!way.tags().has_key("highway")) {
-      return;
-    }
-
-    for (const auto& node_ref : way.nodes()) {
-      if (!internal_.node_index_lookup.contains(node_ref.ref())) {
-        internal_.missing_node_ids.push_back(node_ref.ref());
+// Fills data.nodes with the location of every node referenced by a highway way, sorted by id.
+// References to nodes that are absent from the input are counted in missing_node_count.
+void resolve_way_nodes(ConverterDataInternal& internal, const LocationIndex& locations,
+                       unsigned thread_count) {
+  std::vector<osm_id> ids;
+  for (const auto& way : internal.data.street_segments) {
+    ids.insert(ids.end(), way.node_refs.begin(), way.node_refs.end());
+  }
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+  // lookups are independent reads of the finished index, so split them across threads
+  std::vector<osmium::Location> found(ids.size());
+  auto lookup = [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      if (ids[i] > 0) {
+        found[i] = locations.get_noexcept(static_cast<osmium::unsigned_object_id_type>(ids[i]));
       }
     }
+  };
+  thread_count = std::max(1U, std::min<unsigned>(thread_count, static_cast<unsigned>(ids.size() / 65536 + 1)));
+  const std::size_t chunk = (ids.size() + thread_count - 1) / thread_count;
+  std::vector<std::thread> workers;
+  for (unsigned t = 1; t < thread_count; ++t) {
+    workers.emplace_back(lookup, std::min(ids.size(), t * chunk), std::min(ids.size(), (t + 1) * chunk));
+  }
+  lookup(0, std::min(ids.size(), chunk));
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  internal.data.nodes.reserve(ids.size());
+  for (std::size_t i = 0; i < ids.size(); ++i) {
+    if (!found[i].valid()) {
+      ++internal.missing_node_count;
+      continue;
+    }
+    NodeRecord record;
+    record.osm_id = ids[i];
+    record.lat = found[i].lat();
+    record.lon = found[i].lon();
+    internal.data.nodes.push_back(record);
   }
-
- private:
-  ConverterDataInternal& internal_;
-};
-
-template <typename T>
-void write_pod(std::ofstream& out, const T& value) {
-  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
 }
 
-void write_string(std::ofstream& out, const std::string& value) {
-  const std::uint32_t length = static_cast<std::uint32_t>(value.size());
-  write_pod(out, length);
-  out.write(value.data(), static_cast<std::streamsize>(value.size()));
-}
+ConverterDataInternal build_dataset(const fs::path& input, int threads, bool quiet) {
+  ConverterDataInternal internal;
+  LocationIndex locations;
 
-void write_node_refs(std::ofstream& out, const std::vector<std::int64_t>& refs) {
-  const std::uint32_t count = static_cast<std::uint32_t>(refs.size());
-  write_pod(out, count);
-  if (!refs.empty()) {
-    out.write(reinterpret_cast<const char*>(refs.data()),
-              static_cast<std::streamsize>(refs.size() * sizeof(std::int64_t)));
+  // a single pass over the file; PBF blocks are decompressed and decoded on the pool
+  // while the handlers run on this thread
+  osmium::thread::Pool pool{threads};
+  {
+    osmium::io::Reader reader{input, osmium::osm_entity_bits::node | osmium::osm_entity_bits::way, pool};
+    NodeCollector node_handler{internal, locations};
+    HighwayCollector highway_handler{internal};
+    osmium::apply(reader, node_handler, highway_handler);
+    reader.close();
   }
-}
 
-void write_streets_file(const ConverterDataInternal& internal, const fs::path& output_file) {
-  std::ofstream out(output_file, std::ios::binary | std::ios::trunc);
-  if (!out) {
-    throw std::runtime_error("Failed to open streets output file: " + output_file.string());
-  }
+  locations.sort();
+  resolve_way_nodes(internal, locations, static_cast<unsigned>(pool.num_threads()));
 
-  out.write(kStreetsMagic, sizeof(kStreetsMagic));
-  write_pod(out, kSchemaVersion);
+  if (internal.missing_node_count > 0 && !quiet) {
+    std::cerr << "Warning: missing " << internal.missing_node_count
+              << " node locations referenced by highway ways." << std::endl;
+  }
 
-  const std::uint64_t node_count = internal.data.nodes.size();
-  const std::uint64_t segment_count = internal.data.street_segments.size();
-  write_pod(out, node_count);
-  write_pod(out, segment_count);
+  return internal;
+}
 
-  for (const auto& node : internal.data.nodes) {
-    write_pod(out, node.osm_id);
-    write_pod(out, node.lat);
-    write_pod(out, node.lon);
+// --speed-profiles: the profile of every street segment of `data`, written next to the
+// streets.bin with content hash `streets_hash`
+void write_profiles(const ConverterConfig& config, const ConverterData& data, std::uint64_t streets_hash,
+                    const fs::path& speeds_path) {
+  write_speed_profiles_file(data, read_speed_profiles(config.speed_profiles), streets_hash, speeds_path);
+  if (!config.quiet) {
+    std::cout << "[converter] Wrote speed profiles " << speeds_path << std::endl;
   }
+}
 
-  for (const auto& segment : internal.data.street_segments) {
-    write_pod(out, segment.osm_id);
-    const std::uint8_t category = static_cast<std::uint8_t>(segment.category);
-    write_pod(out, category);
-    write_pod(out, segment.max_speed_kph);
-    write_string(out, segment.name);
-    write_node_refs(out, segment.node_refs);
+// Content hash of the streets.bin at `path`, or 0 if there is none this version can read
+std::uint64_t existing_streets_hash(const fs::path& path) {
+  try {
+    return read_streets_content_hash(path);
+  } catch (const std::exception&) {
+    return 0;
   }
 }
 
-void write_osm_file(const ConverterDataInternal& internal, const fs::path& output_file) {
-  std::ofstream out(output_file, std::ios::binary | std::ios::trunc);
-  if (!out) {
-    throw std::runtime_error("Failed to open OSM output file: " + output_file.string());
+// Called when streets.bin changed without --speed-profiles: the segments may have been
+// renumbered, so the speeds.bin written for the old file no longer describes them. The runtime
+// would ignore it (its streets hash no longer matches), but it is removed so it does not look
+// current.
+void remove_stale_profiles(const ConverterConfig& config, const fs::path& speeds_path) {
+  std::error_code error;
+  if (fs::remove(speeds_path, error) && !config.quiet) {
+    std::cout << "[converter] Removed " << speeds_path
+              << ", written for the previous streets.bin; rerun with --speed-profiles to rebuild it"
+              << std::endl;
   }
+}
 
-  out.write(kOsmMagic, sizeof(kOsmMagic));
-  write_pod(out, kSchemaVersion);
-
-  const std::uint64_t poi_count = internal.data.pois.size();
-  write_pod(out, poi_count);
+// --apply-changes: patches the existing binaries in place instead of decoding the PBF again
+int apply_changes(const ConverterConfig& config, const fs::path& streets_path, const fs::path& osm_path,
+                  const fs::path& speeds_path) {
+  if (!fs::exists(config.change_file)) {
+    std::cerr << "[converter] Change file does not exist: " << config.change_file << std::endl;
+    return 1;
+  }
+  if (!fs::exists(streets_path) || !fs::exists(osm_path)) {
+    std::cerr << "[converter] --apply-changes needs existing binaries: " << streets_path << " / "
+              << osm_path << std::endl;
+    return 1;
+  }
 
-  for (const auto& poi : internal.data.pois) {
-    write_pod(out, poi.osm_id);
-    write_pod(out, poi.lat);
-    write_pod(out, poi.lon);
-    write_string(out, poi.category);
-    write_string(out, poi.name);
+  if (!config.quiet) {
+    std::cout << "[converter] Applying " << config.change_file << " to " << streets_path << " / "
+              << osm_path << std::endl;
   }
-}
 
-ConverterDataInternal build_dataset(const fs::path& input, bool quiet) {
-  ConverterDataInternal internal;
+  const auto start_time = std::chrono::steady_clock::now();
 
-  {
-    osmium::io::Reader way_reader{input, osmium::osm_entity_bits::way};
-    HighwayCollector highway_handler{internal};
-    osmium::apply(way_reader, highway_handler);
-    way_reader.close();
+  ConverterData data;
+  ChangeSummary summary;
+  try {
+    // streets.bin is only rewritten if its nodes or ways changed, and then keeps the hierarchies
+    // where the routing graph allows (see write_streets_file)
+    StreetHierarchies hierarchies;
+    data = read_map_binaries(streets_path, osm_path, hierarchies);
+    const std::uint64_t previous_hash = read_streets_content_hash(streets_path);
+    summary = apply_change_file(data, config.change_file);
+    const std::uint64_t streets_hash =
+        summary.streets_changed ? write_streets_file(data, streets_path, config.contract, &hierarchies)
+                                : previous_hash;
+    if (summary.pois_changed) {
+      write_osm_file(data, osm_path);
+    }
+    // segments may be renumbered when the streets change, so the profiles are rebuilt when
+    // given, and otherwise the ones written for the old streets.bin are dropped
+    if (!config.speed_profiles.empty()) {
+      write_profiles(config, data, streets_hash, speeds_path);
+    } else if (streets_hash != previous_hash) {
+      remove_stale_profiles(config, speeds_path);
+    }
+  } catch (const std::exception& ex) {
+    std::cerr << "[converter] Applying changes failed: " << ex.what() << std::endl;
+    return 1;
   }
 
-  {
-    osmium::io::Reader node_reader{input, osmium::osm_entity_bits::node};
-    NodeCollector node_handler{internal};
-    osmium::apply(node_reader, node_handler);
-    node_reader.close();
+  if (summary.missing_node_refs > 0) {
+    std::cerr << "[converter] Warning: " << summary.missing_node_refs
+              << " way node references are neither in the map nor in the change file; rebuild "
+                 "from the PBF with --force to resolve them"
+              << std::endl;
   }
 
-  {
-    osmium::io::Reader validator_reader{input, osmium::osm_entity_bits::way};
-    WayNodeValidator validator{internal};
-    osmium::apply(validator_reader, validator);
-    validator_reader.close();
-  }
+  const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start_time);
 
-  if (!internal.missing_node_ids.empty() && !quiet) {
-    std::sort(internal.missing_node_ids.begin(), internal.missing_node_ids.end());
-    internal.missing_node_ids.erase(
-        std::unique(internal.missing_node_ids.begin(), internal.missing_node_ids.end()),
-        internal.missing_node_ids.end());
-    std::cerr << "Warning: missing " << internal.missing_node_ids.size()
-              << " node locations referenced by highway ways." << std::endl;
+  if (!config.quiet) {
+    std::cout << "[converter] Applied " << summary.node_changes << " node and " << summary.way_changes
+              << " way changes in " << elapsed.count() << "ms (streets.bin "
+              << (summary.streets_changed ? "rewritten" : "unchanged") << ", osm.bin "
+              << (summary.pois_changed ? "rewritten" : "unchanged") << ")" << std::endl;
   }
 
-  return internal;
+  return 0;
 }
 
 }  // namespace
 
 int run_converter(const ConverterConfig& config) {
-  if (config.input_pbf.empty()) {
+  const bool applying_changes = !config.change_file.empty();
+  if (config.input_pbf.empty() && !applying_changes) {
     std::cerr << "[converter] Missing --input argument" << std::endl;
     return 1;
   }
 
-  if (!fs::exists(config.input_pbf)) {
+  if (!applying_changes && !fs::exists(config.input_pbf)) {
     std::cerr << "[converter] Input file does not exist: " << config.input_pbf << std::endl;
     return 1;
   }
@@ -351,6 +272,11 @@ int run_converter(const ConverterConfig& config) {
   if (map_name.empty()) {
     map_name = config.input_pbf.stem().string();
   }
+  if (map_name.empty()) {
+    std::cerr << "[converter] --apply-changes needs --map-name or --input to locate the binaries"
+              << std::endl;
+    return 1;
+  }
 
   fs::path output_dir = config.output_directory;
   if (output_dir.empty()) {
@@ -359,6 +285,11 @@ int run_converter(const ConverterConfig& config) {
 
   const fs::path streets_path = output_dir / (map_name + ".streets.bin");
   const fs::path osm_path = output_dir / (map_name + ".osm.bin");
+  const fs::path speeds_path = output_dir / (map_name + ".speeds.bin");
+
+  if (applying_changes) {
+    return apply_changes(config, streets_path, osm_path, speeds_path);
+  }
 
   const bool both_exist = fs::exists(streets_path) && fs::exists(osm_path);
   if (both_exist && !config.force_rebuild) {
@@ -366,6 +297,15 @@ int run_converter(const ConverterConfig& config) {
       std::cout << "[converter] Existing binaries found; skipping conversion for " << map_name
                 << std::endl;
     }
+    if (!config.speed_profiles.empty()) {
+      try {
+        write_profiles(config, read_map_binaries(streets_path, osm_path),
+                       read_streets_content_hash(streets_path), speeds_path);
+      } catch (const std::exception& ex) {
+        std::cerr << "[converter] Writing speed profiles failed: " << ex.what() << std::endl;
+        return 1;
+      }
+    }
     return 0;
   }
 
@@ -387,9 +327,15 @@ int run_converter(const ConverterConfig& config) {
 
   ConverterDataInternal internal;
   try {
-    internal = build_dataset(config.input_pbf, config.quiet);
-    write_streets_file(internal, streets_path);
-    write_osm_file(internal, osm_path);
+    internal = build_dataset(config.input_pbf, config.threads, config.quiet);
+    const std::uint64_t previous_hash = existing_streets_hash(streets_path);
+    const std::uint64_t streets_hash = write_streets_file(internal.data, streets_path, config.contract);
+    write_osm_file(internal.data, osm_path);
+    if (!config.speed_profiles.empty()) {
+      write_profiles(config, internal.data, streets_hash, speeds_path);
+    } else if (streets_hash != previous_hash) {
+      remove_stale_profiles(config, speeds_path);
+    }
   } catch (const std::exception& ex) {
     std::cerr << "[converter] Conversion failed: " << ex.what() << std::endl;
     return 1;
@@ -0,0 +1,231 @@
+#include "converter/customizable.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
+namespace gisevo::converter {
+namespace {
+
+constexpr double kDegreeToRadian = 0.017453292519943295769236907684886;
+// Cells this small are ranked as they are instead of being cut further
+constexpr std::size_t kLeafSize = 4;
+// Where a cell is cut along each direction, as a fraction of its intersections
+constexpr double kCutFractions[] = {0.35, 0.42, 0.5, 0.58, 0.65};
+
+struct Point {
+  double x;
+  double y;
+};
+
+// Cut directions: east, north and the two diagonals
+constexpr Point kDirections[] = {{1.0, 0.0}, {0.0, 1.0}, {0.7071067811865476, 0.7071067811865476},
+                                 {0.7071067811865476, -0.7071067811865476}};
+
+// Part of the network still to be ordered; its intersections take ranks [top - size, top)
+struct Cell {
+  std::vector<std::int32_t> nodes;
+  std::uint32_t top;
+};
+
+class Dissector {
+ public:
+  explicit Dissector(const StreetTables& tables);
+  std::vector<std::uint32_t> run();
+
+ private:
+  // Ranks the separator of `cell` and queues the two halves it leaves
+  void dissect(const Cell& cell, std::vector<Cell>& pending);
+  // Whether `node` has a neighbour in the current cell on the other side of the cut
+  bool on_boundary(std::int32_t node) const;
+
+  const StreetTables& tables_;
+  std::vector<Point> points_;
+  std::vector<std::uint32_t> cell_of_;
+  std::vector<std::uint8_t> side_;
+  std::vector<std::uint32_t> ranks_;
+  std::uint32_t cell_count_ = 0;
+};
+
+Dissector::Dissector(const StreetTables& tables)
+    : tables_(tables),
+      cell_of_(tables.intersection_nodes.size(), 0),
+      side_(tables.intersection_nodes.size(), 0),
+      ranks_(tables.intersection_nodes.size(), 0) {
+  // Equirectangular projection; only the relative positions within a cell matter
+  points_.reserve(tables.intersection_nodes.size());
+  for (const std::uint32_t node : tables.intersection_nodes) {
+    const double lat = tables.node_lat[node];
+    points_.push_back(Point{tables.node_lon[node] * std::cos(lat * kDegreeToRadian), lat});
+  }
+}
+
+bool Dissector::on_boundary(std::int32_t node) const {
+  const std::uint32_t cell = cell_of_[node];
+  for (std::uint32_t k = tables_.intersection_segment_offsets[node];
+       k < tables_.intersection_segment_offsets[node + 1]; ++k) {
+    const std::int32_t other = tables_.intersection_adjacent[k];
+    if (cell_of_[other] == cell && side_[other] != side_[node]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Dissector::dissect(const Cell& cell, std::vector<Cell>& pending) {
+  const std::size_t size = cell.nodes.size();
+  if (size <= kLeafSize) {
+    for (std::size_t k = 0; k < size; ++k) {
+      ranks_[cell.nodes[k]] = cell.top - static_cast<std::uint32_t>(size - k);
+    }
+    return;
+  }
+  const std::uint32_t id = ++cell_count_;
+  for (const std::int32_t node : cell.nodes) {
+    cell_of_[node] = id;
+  }
+
+  // Try every cut and keep the one whose smaller boundary is smallest, then the most balanced
+  std::vector<std::pair<double, std::int32_t>> keyed(size);
+  std::vector<std::uint8_t> best_sides(size);
+  std::size_t best_separator = size + 1;
+  std::size_t best_imbalance = size + 1;
+  std::uint8_t separator_side = 0;
+  for (const Point& direction : kDirections) {
+    for (std::size_t k = 0; k < size; ++k) {
+      const Point& point = points_[cell.nodes[k]];
+      keyed[k] = {point.x * direction.x + point.y * direction.y, cell.nodes[k]};
+    }
+    std::sort(keyed.begin(), keyed.end());
+    for (const double fraction : kCutFractions) {
+      const std::size_t split = std::clamp<std::size_t>(static_cast<std::size_t>(size * fraction), 1, size - 1);
+      for (std::size_t k = 0; k < size; ++k) {
+        side_[keyed[k].second] = k < split ? 0 : 1;
+      }
+      std::size_t boundary[2] = {0, 0};
+      for (const std::int32_t node : cell.nodes) {
+        boundary[side_[node]] += on_boundary(node) ? 1 : 0;
+      }
+      const std::uint8_t smaller = boundary[1] < boundary[0] ? 1 : 0;
+      const std::size_t imbalance = split > size - split ? 2 * split - size : size - 2 * split;
+      if (boundary[smaller] < best_separator ||
+          (boundary[smaller] == best_separator && imbalance < best_imbalance)) {
+        best_separator = boundary[smaller];
+        best_imbalance = imbalance;
+        separator_side = smaller;
+        for (std::size_t k = 0; k < size; ++k) {
+          best_sides[k] = side_[cell.nodes[k]];
+        }
+      }
+    }
+  }
+
+  for (std::size_t k = 0; k < size; ++k) {
+    side_[cell.nodes[k]] = best_sides[k];
+  }
+  std::vector<std::int32_t> separator;
+  Cell halves[2];
+  for (const std::int32_t node : cell.nodes) {
+    if (side_[node] == separator_side && on_boundary(node)) {
+      separator.push_back(node);
+    } else {
+      halves[side_[node]].nodes.push_back(node);
+    }
+  }
+  for (std::size_t k = 0; k < separator.size(); ++k) {
+    ranks_[separator[k]] = cell.top - static_cast<std::uint32_t>(separator.size() - k);
+  }
+  halves[1].top = cell.top - static_cast<std::uint32_t>(separator.size());
+  halves[0].top = halves[1].top - static_cast<std::uint32_t>(halves[1].nodes.size());
+  for (Cell& half : halves) {
+    if (!half.nodes.empty()) {
+      pending.push_back(std::move(half));
+    }
+  }
+}
+
+std::vector<std::uint32_t> Dissector::run() {
+  const std::size_t node_count = points_.size();
+  std::vector<Cell> pending(1);
+  pending[0].top = static_cast<std::uint32_t>(node_count);
+  pending[0].nodes.resize(node_count);
+  for (std::size_t i = 0; i < node_count; ++i) {
+    pending[0].nodes[i] = static_cast<std::int32_t>(i);
+  }
+  while (!pending.empty()) {
+    const Cell cell = std::move(pending.back());
+    pending.pop_back();
+    dissect(cell, pending);
+  }
+  return std::move(ranks_);
+}
+
+}  // namespace
+
+CustomizableHierarchy build_customizable_hierarchy(const StreetTables& tables) {
+  const std::size_t node_count = tables.intersection_nodes.size();
+  CustomizableHierarchy hierarchy;
+  hierarchy.ranks = Dissector(tables).run();
+  const std::vector<std::uint32_t>& ranks = hierarchy.ranks;
+  auto by_rank = [&](std::int32_t a, std::int32_t b) { return ranks[a] < ranks[b]; };
+
+  std::vector<std::int32_t> order(node_count);
+  std::vector<std::vector<std::int32_t>> upper(node_count);
+  for (std::size_t i = 0; i < node_count; ++i) {
+    order[ranks[i]] = static_cast<std::int32_t>(i);
+    for (std::uint32_t k = tables.intersection_segment_offsets[i]; k < tables.intersection_segment_offsets[i + 1];
+         ++k) {
+      const std::int32_t other = tables.intersection_adjacent[k];
+      if (ranks[other] > ranks[i]) {
+        upper[i].push_back(other);
+      }
+    }
+  }
+
+  // Eliminating an intersection connects its higher ranked neighbours pairwise. Handing them to
+  // the lowest of them is enough: it is eliminated next among them and passes them on in turn.
+  for (const std::int32_t node : order) {
+    std::vector<std::int32_t>& neighbours = upper[node];
+    std::sort(neighbours.begin(), neighbours.end(), by_rank);
+    neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+    if (neighbours.size() > 1) {
+      std::vector<std::int32_t>& parent = upper[neighbours.front()];
+      parent.insert(parent.end(), neighbours.begin() + 1, neighbours.end());
+    }
+  }
+
+  hierarchy.arc_offsets.reserve(node_count + 1);
+  hierarchy.arc_offsets.push_back(0);
+  for (std::size_t i = 0; i < node_count; ++i) {
+    if (hierarchy.arcs.size() + upper[i].size() >= kNoCchArc) {
+      throw std::runtime_error("Too many customizable hierarchy arcs for 32-bit arc indices");
+    }
+    hierarchy.arcs.insert(hierarchy.arcs.end(), upper[i].begin(), upper[i].end());
+    hierarchy.arc_offsets.push_back(static_cast<std::uint32_t>(hierarchy.arcs.size()));
+    upper[i] = {};
+  }
+
+  hierarchy.edge_arcs.reserve(tables.routing_edges.size());
+  for (std::size_t i = 0; i < node_count; ++i) {
+    for (std::uint32_t k = tables.routing_edge_offsets[i]; k < tables.routing_edge_offsets[i + 1]; ++k) {
+      std::int32_t lower = static_cast<std::int32_t>(i);
+      std::int32_t higher = tables.routing_edges[k].to;
+      if (lower == higher) {
+        hierarchy.edge_arcs.push_back(kNoCchArc);
+        continue;
+      }
+      if (ranks[higher] < ranks[lower]) {
+        std::swap(lower, higher);
+      }
+      const auto begin = hierarchy.arcs.begin() + hierarchy.arc_offsets[lower];
+      const auto end = hierarchy.arcs.begin() + hierarchy.arc_offsets[lower + 1];
+      const auto arc = std::lower_bound(begin, end, higher, by_rank);
+      hierarchy.edge_arcs.push_back(static_cast<std::uint32_t>(arc - hierarchy.arcs.begin()));
+    }
+  }
+  return hierarchy;
+}
+
+}  // namespace gisevo::converter
@@ -1,5 +1,6 @@
 #include "converter/converter.hpp"
 
+#include <charconv>
 #include <filesystem>
 #include <iostream>
 #include <string_view>
@@ -10,12 +11,17 @@ namespace {
 
 void print_usage() {
   std::cout << "Usage: osm_converter --input <file.osm.pbf> [options]\n"
+               "       osm_converter --map-name <name> --apply-changes <file.osc> [options]\n"
                "\n"
                "Options:\n"
                "  -i, --input <path>        Path to the source .osm.pbf file\n"
                "  -o, --output-dir <path>   Directory for output binaries (default: cwd)\n"
                "  -n, --map-name <name>     Base name for generated files (default: input stem)\n"
+               "  -c, --apply-changes <f>  Patch existing binaries from an .osc/.osc.gz change file\n"
                "  -f, --force               Regenerate even if binaries already exist\n"
+               "  -t, --threads <n>         Threads for PBF decoding (default: all cores but two)\n"
+               "      --no-contraction      Skip the contraction hierarchies (faster on large extracts)\n"
+               "  -s, --speed-profiles <f>  Write <map>.speeds.bin from a speed profile description\n"
                "  -q, --quiet               Suppress progress logging\n"
                "  -h, --help                Show this help text\n";
 }
@@ -49,8 +55,33 @@ int main(int argc, char* argv[]) {
         return 1;
       }
       config.map_name = argv[++i];
+    } else if (arg == "-c" || arg == "--apply-changes") {
+      if (i + 1 >= argc) {
+        std::cerr << "[converter] Missing value for --apply-changes" << std::endl;
+        return 1;
+      }
+      config.change_file = fs::path(argv[++i]);
+    } else if (arg == "-s" || arg == "--speed-profiles") {
+      if (i + 1 >= argc) {
+        std::cerr << "[converter] Missing value for --speed-profiles" << std::endl;
+        return 1;
+      }
+      config.speed_profiles = fs::path(argv[++i]);
+    } else if (arg == "-t" || arg == "--threads") {
+      if (i + 1 >= argc) {
+        std::cerr << "[converter] Missing value for --threads" << std::endl;
+        return 1;
+      }
+      const std::string_view value(argv[++i]);
+      const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), config.threads);
+      if (error != std::errc{} || end != value.data() + value.size() || config.threads < 1) {
+        std::cerr << "[converter] Invalid value for --threads: " << value << std::endl;
+        return 1;
+      }
     } else if (arg == "-f" || arg == "--force") {
       config.force_rebuild = true;
+    } else if (arg == "--no-contraction") {
+      config.contract = false;
     } else if (arg == "-q" || arg == "--quiet") {
       config.quiet = true;
     } else {
@@ -0,0 +1,236 @@
+#include "converter/map_reader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace gisevo::converter {
+namespace {
+
+std::vector<char> read_file(const fs::path& path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    throw std::runtime_error("Failed to open " + path.string());
+  }
+  return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// Bounds-checked reader over a whole file held in memory
+class BufferCursor {
+ public:
+  BufferCursor(const std::vector<char>& buffer, const fs::path& path) : buffer_(buffer), path_(path) {}
+
+  void seek(std::uint64_t position) {
+    if (position > buffer_.size()) {
+      throw std::runtime_error(path_.string() + " is truncated");
+    }
+    position_ = position;
+  }
+
+  // Throws unless count values of T are left to read
+  template <typename T>
+  void require(std::uint64_t count) const {
+    if (count > (buffer_.size() - position_) / sizeof(T)) {
+      throw std::runtime_error(path_.string() + " is truncated");
+    }
+  }
+
+  template <typename T>
+  void read_into(T* values, std::uint64_t count) {
+    require<T>(count);
+    std::memcpy(values, buffer_.data() + position_, count * sizeof(T));
+    position_ += count * sizeof(T);
+  }
+
+  template <typename T>
+  T read() {
+    T value;
+    read_into(&value, 1);
+    return value;
+  }
+
+  std::string read_string() {
+    std::string value(read<std::uint32_t>(), '\0');
+    read_into(value.data(), value.size());
+    return value;
+  }
+
+ private:
+  const std::vector<char>& buffer_;
+  const fs::path& path_;
+  std::uint64_t position_ = 0;
+};
+
+void check_magic(const char (&magic)[8], const char (&expected)[8], std::uint32_t version,
+                 std::uint32_t expected_version, const fs::path& path) {
+  if (!std::equal(std::begin(magic), std::end(magic), std::begin(expected))) {
+    throw std::runtime_error(path.string() + " is not an osm_converter output file");
+  }
+  if (version != expected_version) {
+    throw std::runtime_error(path.string() + " has schema version " + std::to_string(version) +
+                             ", expected " + std::to_string(expected_version) +
+                             "; rebuild it from the PBF with --force");
+  }
+}
+
+class SectionReader {
+ public:
+  explicit SectionReader(const fs::path& path) : path_(path), buffer_(read_file(path)), cursor_(buffer_, path_) {
+    const auto header = cursor_.read<FileHeader>();
+    check_magic(header.magic, kStreetsMagic, header.version, kStreetsSchemaVersion, path_);
+    // counts from the file are checked before allocating for them
+    cursor_.require<SectionEntry>(header.section_count);
+    toc_.resize(header.section_count);
+    cursor_.read_into(toc_.data(), toc_.size());
+  }
+
+  template <typename T>
+  std::vector<T> section(SectionId id) {
+    const auto entry = std::find_if(toc_.begin(), toc_.end(), [id](const SectionEntry& candidate) {
+      return candidate.id == static_cast<std::uint32_t>(id);
+    });
+    if (entry == toc_.end() || entry->element_size != sizeof(T)) {
+      throw std::runtime_error(path_.string() + " is missing section " +
+                               std::to_string(static_cast<std::uint32_t>(id)));
+    }
+    cursor_.seek(entry->offset);
+    cursor_.require<T>(entry->count);
+    std::vector<T> values(entry->count);
+    cursor_.read_into(values.data(), values.size());
+    return values;
+  }
+
+ private:
+  fs::path path_;
+  std::vector<char> buffer_;
+  BufferCursor cursor_;
+  std::vector<SectionEntry> toc_;
+};
+
+void read_hierarchies(SectionReader& reader, StreetHierarchies& hierarchies) {
+  hierarchies.intersection_segment_offsets = reader.section<std::uint32_t>(SectionId::kIntersectionSegmentOffsets);
+  hierarchies.intersection_adjacent = reader.section<std::int32_t>(SectionId::kIntersectionAdjacent);
+  hierarchies.routing_edge_offsets = reader.section<std::uint32_t>(SectionId::kRoutingEdgeOffsets);
+  hierarchies.routing_edges = reader.section<RoutingEdge>(SectionId::kRoutingEdges);
+
+  ContractionHierarchy& contraction = hierarchies.contraction;
+  contraction.ranks = reader.section<std::uint32_t>(SectionId::kChRanks);
+  contraction.up_edge_offsets = reader.section<std::uint32_t>(SectionId::kChUpEdgeOffsets);
+  contraction.up_edges = reader.section<ChEdge>(SectionId::kChUpEdges);
+  contraction.down_edge_offsets = reader.section<std::uint32_t>(SectionId::kChDownEdgeOffsets);
+  contraction.down_edges = reader.section<ChEdge>(SectionId::kChDownEdges);
+
+  CustomizableHierarchy& customizable = hierarchies.customizable;
+  customizable.ranks = reader.section<std::uint32_t>(SectionId::kCchRanks);
+  customizable.arc_offsets = reader.section<std::uint32_t>(SectionId::kCchArcOffsets);
+  customizable.arcs = reader.section<std::int32_t>(SectionId::kCchArcs);
+  customizable.edge_arcs = reader.section<std::uint32_t>(SectionId::kCchEdgeArcs);
+}
+
+void read_streets(const fs::path& path, ConverterData& data, StreetHierarchies* hierarchies) {
+  SectionReader reader(path);
+  if (hierarchies != nullptr) {
+    read_hierarchies(reader, *hierarchies);
+  }
+  const auto node_ids = reader.section<std::int64_t>(SectionId::kNodeIds);
+  const auto node_lat = reader.section<double>(SectionId::kNodeLat);
+  const auto node_lon = reader.section<double>(SectionId::kNodeLon);
+  const auto way_ids = reader.section<std::int64_t>(SectionId::kWayIds);
+  const auto way_categories = reader.section<std::uint8_t>(SectionId::kWayCategories);
+  const auto way_flags = reader.section<std::uint8_t>(SectionId::kWayFlags);
+  const auto way_speeds = reader.section<float>(SectionId::kWaySpeeds);
+  const auto way_names = reader.section<std::uint32_t>(SectionId::kWayNames);
+  const auto way_node_offsets = reader.section<std::uint64_t>(SectionId::kWayNodeOffsets);
+  const auto way_nodes = reader.section<std::uint32_t>(SectionId::kWayNodes);
+  const auto string_offsets = reader.section<std::uint64_t>(SectionId::kStringOffsets);
+  const auto string_data = reader.section<char>(SectionId::kStringData);
+
+  const std::size_t way_count = way_ids.size();
+  const bool consistent =
+      node_lat.size() == node_ids.size() && node_lon.size() == node_ids.size() &&
+      way_categories.size() == way_count && way_flags.size() == way_count &&
+      way_speeds.size() == way_count && way_names.size() == way_count &&
+      way_node_offsets.size() == way_count + 1 && way_node_offsets.back() == way_nodes.size() &&
+      !string_offsets.empty() && string_offsets.back() == string_data.size() &&
+      std::all_of(way_nodes.begin(), way_nodes.end(), [&](std::uint32_t n) { return n < node_ids.size(); }) &&
+      std::all_of(way_names.begin(), way_names.end(), [&](std::uint32_t s) { return s + 1 < string_offsets.size(); });
+  if (!consistent) {
+    throw std::runtime_error(path.string() + " has inconsistent sections");
+  }
+
+  data.nodes.reserve(node_ids.size());
+  for (std::size_t i = 0; i < node_ids.size(); ++i) {
+    data.nodes.push_back(NodeRecord{node_ids[i], node_lat[i], node_lon[i]});
+  }
+
+  data.street_segments.reserve(way_count);
+  for (std::size_t w = 0; w < way_count; ++w) {
+    StreetSegmentRecord record;
+    record.osm_id = way_ids[w];
+    record.category = static_cast<HighwayCategory>(way_categories[w]);
+    record.max_speed_kph = way_speeds[w];
+    record.one_way = (way_flags[w] & kWayFlagOneWay) != 0;
+    record.name.assign(string_data.data() + string_offsets[way_names[w]],
+                       string_data.data() + string_offsets[way_names[w] + 1]);
+    for (std::uint64_t r = way_node_offsets[w]; r < way_node_offsets[w + 1]; ++r) {
+      record.node_refs.push_back(node_ids[way_nodes[r]]);
+    }
+    data.street_segments.push_back(std::move(record));
+  }
+}
+
+void read_pois(const fs::path& path, ConverterData& data) {
+  const std::vector<char> buffer = read_file(path);
+  BufferCursor cursor(buffer, path);
+  char magic[8];
+  cursor.read_into(magic, sizeof(magic));
+  const auto version = cursor.read<std::uint32_t>();
+  check_magic(magic, kOsmMagic, version, kOsmSchemaVersion, path);
+  cursor.read<std::uint64_t>();  // content hash, recomputed when the file is written back
+
+  const auto poi_count = cursor.read<std::uint64_t>();
+  for (std::uint64_t i = 0; i < poi_count; ++i) {
+    PoiRecord poi;
+    poi.osm_id = cursor.read<std::int64_t>();
+    poi.lat = cursor.read<double>();
+    poi.lon = cursor.read<double>();
+    poi.category = cursor.read_string();
+    poi.name = cursor.read_string();
+    data.pois.push_back(std::move(poi));
+  }
+}
+
+}  // namespace
+
+ConverterData read_map_binaries(const fs::path& streets_file, const fs::path& osm_file) {
+  ConverterData data;
+  read_streets(streets_file, data, nullptr);
+  read_pois(osm_file, data);
+  return data;
+}
+
+ConverterData read_map_binaries(const fs::path& streets_file, const fs::path& osm_file,
+                                StreetHierarchies& hierarchies) {
+  ConverterData data;
+  read_streets(streets_file, data, &hierarchies);
+  read_pois(osm_file, data);
+  return data;
+}
+
+std::uint64_t read_streets_content_hash(const fs::path& streets_file) {
+  std::ifstream in(streets_file, std::ios::binary);
+  FileHeader header{};
+  if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+    throw std::runtime_error("Failed to read the header of " + streets_file.string());
+  }
+  check_magic(header.magic, kStreetsMagic, header.version, kStreetsSchemaVersion, streets_file);
+  return header.content_hash;
+}
+
+}  // namespace gisevo::converter
@@ -0,0 +1,210 @@
+#include "converter/map_writer.hpp"
+
+#include "converter/content_hash.hpp"
+#include "converter/contraction.hpp"
+#include "converter/customizable.hpp"
+#include "converter/section_writer.hpp"
+#include "converter/street_tables.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace gisevo::converter {
+namespace {
+
+template <typename T>
+void write_pod(std::ostream& out, const T& value) {
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void write_string(std::ostream& out, const std::string& value) {
+  const std::uint32_t length = static_cast<std::uint32_t>(value.size());
+  write_pod(out, length);
+  out.write(value.data(), static_cast<std::streamsize>(value.size()));
+}
+
+// Same intersections, segments and edges in the same order, ignoring travel times
+bool same_routing_graph(const StreetTables& tables, const StreetHierarchies& previous) {
+  return tables.intersection_segment_offsets == previous.intersection_segment_offsets &&
+         tables.intersection_adjacent == previous.intersection_adjacent &&
+         tables.routing_edge_offsets == previous.routing_edge_offsets &&
+         std::equal(tables.routing_edges.begin(), tables.routing_edges.end(), previous.routing_edges.begin(),
+                    previous.routing_edges.end(), [](const RoutingEdge& a, const RoutingEdge& b) {
+                      return a.segment == b.segment && a.to == b.to;
+                    });
+}
+
+bool same_travel_times(const StreetTables& tables, const StreetHierarchies& previous) {
+  return std::equal(tables.routing_edges.begin(), tables.routing_edges.end(), previous.routing_edges.begin(),
+                    previous.routing_edges.end(),
+                    [](const RoutingEdge& a, const RoutingEdge& b) { return a.travel_time == b.travel_time; });
+}
+
+fs::path temporary_path(const fs::path& output_file) {
+  fs::path path = output_file;
+  path += ".tmp";
+  return path;
+}
+
+}  // namespace
+
+std::uint64_t write_streets_file(const ConverterData& data, const fs::path& output_file, bool contract,
+                                 const StreetHierarchies* previous) {
+  if (data.nodes.size() > std::numeric_limits<std::int32_t>::max()) {
+    throw std::runtime_error("Too many nodes for 32-bit node indices");
+  }
+  const StreetTables tables = build_street_tables(data);
+
+  SectionWriter writer;
+  writer.add(SectionId::kNodeIds, tables.node_ids);
+  writer.add(SectionId::kNodeLat, tables.node_lat);
+  writer.add(SectionId::kNodeLon, tables.node_lon);
+  writer.add(SectionId::kWayIds, tables.way_ids);
+  writer.add(SectionId::kWayCategories, tables.way_categories);
+  writer.add(SectionId::kWayFlags, tables.way_flags);
+  writer.add(SectionId::kWaySpeeds, tables.way_speeds);
+  writer.add(SectionId::kWayNames, tables.way_names);
+  writer.add(SectionId::kWayNodeOffsets, tables.way_node_offsets);
+  writer.add(SectionId::kWayNodes, tables.way_nodes);
+  writer.add(SectionId::kWayLengths, tables.way_lengths);
+  writer.add(SectionId::kStringOffsets, tables.string_offsets);
+  writer.add(SectionId::kStringData, tables.string_data);
+
+  writer.add(SectionId::kIntersectionNodes, tables.intersection_nodes);
+  writer.add(SectionId::kIntersectionSegmentOffsets, tables.intersection_segment_offsets);
+  writer.add(SectionId::kIntersectionSegments, tables.intersection_segments);
+  writer.add(SectionId::kIntersectionAdjacent, tables.intersection_adjacent);
+  writer.add(SectionId::kSegmentWays, tables.segment_ways);
+  writer.add(SectionId::kSegmentFrom, tables.segment_from);
+  writer.add(SectionId::kSegmentTo, tables.segment_to);
+  writer.add(SectionId::kSegmentStreets, tables.segment_streets);
+  writer.add(SectionId::kSegmentFlags, tables.segment_flags);
+  writer.add(SectionId::kSegmentSpeeds, tables.segment_speeds);
+  writer.add(SectionId::kSegmentLengths, tables.segment_lengths);
+  writer.add(SectionId::kSegmentTravelTimes, tables.segment_travel_times);
+  writer.add(SectionId::kSegmentCurveOffsets, tables.segment_curve_offsets);
+  writer.add(SectionId::kCurveNodes, tables.curve_nodes);
+
+  writer.add(SectionId::kStreetNames, tables.street_names);
+  writer.add(SectionId::kStreetKeys, tables.street_keys);
+  writer.add(SectionId::kStreetsByKey, tables.streets_by_key);
+  writer.add(SectionId::kStreetLengths, tables.street_lengths);
+  writer.add(SectionId::kStreetSegmentOffsets, tables.street_segment_offsets);
+  writer.add(SectionId::kStreetSegments, tables.street_segments);
+  writer.add(SectionId::kStreetIntersectionOffsets, tables.street_intersection_offsets);
+  writer.add(SectionId::kStreetIntersections, tables.street_intersections);
+
+  writer.add(SectionId::kSummary, std::span<const NetworkSummary>(&tables.summary, 1));
+
+  writer.add(SectionId::kRoutingEdgeOffsets, tables.routing_edge_offsets);
+  writer.add(SectionId::kRoutingEdges, tables.routing_edges);
+
+  // a file written with --no-contraction has empty hierarchies, which are never reused
+  const bool same_graph = contract && previous != nullptr && same_routing_graph(tables, *previous);
+  const bool reuse_ch = same_graph && !previous->contraction.ranks.empty();
+  const bool reuse_cch = same_graph && !previous->customizable.ranks.empty();
+
+  ContractionHierarchy hierarchy;
+  if (reuse_ch && same_travel_times(tables, *previous)) {
+    hierarchy = previous->contraction;
+  } else if (reuse_ch) {
+    hierarchy = build_contraction_hierarchy(tables, previous->contraction.ranks);
+  } else if (contract) {
+    hierarchy = build_contraction_hierarchy(tables);
+  }
+  writer.add(SectionId::kChRanks, hierarchy.ranks);
+  writer.add(SectionId::kChUpEdgeOffsets, hierarchy.up_edge_offsets);
+  writer.add(SectionId::kChUpEdges, hierarchy.up_edges);
+  writer.add(SectionId::kChDownEdgeOffsets, hierarchy.down_edge_offsets);
+  writer.add(SectionId::kChDownEdges, hierarchy.down_edges);
+
+  CustomizableHierarchy customizable;
+  if (reuse_cch) {
+    customizable = previous->customizable;
+  } else if (contract) {
+    customizable = build_customizable_hierarchy(tables);
+  }
+  writer.add(SectionId::kCchRanks, customizable.ranks);
+  writer.add(SectionId::kCchArcOffsets, customizable.arc_offsets);
+  writer.add(SectionId::kCchArcs, customizable.arcs);
+  writer.add(SectionId::kCchEdgeArcs, customizable.edge_arcs);
+
+  const fs::path temporary = temporary_path(output_file);
+  const std::uint64_t hash = writer.write(temporary, kStreetsMagic, kStreetsSchemaVersion);
+  fs::rename(temporary, output_file);
+  return hash;
+}
+
+void write_speed_profiles_file(const ConverterData& data, const SpeedProfileSet& profiles,
+                               std::uint64_t streets_hash, const fs::path& output_file) {
+  const StreetTables tables = build_street_tables(data);
+
+  std::vector<std::uint32_t> breakpoint_offsets{0, 0};
+  std::vector<SpeedBreakpoint> breakpoints;
+  for (const auto& corners : profiles.profiles) {
+    breakpoints.insert(breakpoints.end(), corners.begin(), corners.end());
+    breakpoint_offsets.push_back(static_cast<std::uint32_t>(breakpoints.size()));
+  }
+
+  std::vector<std::uint16_t> segment_profiles(tables.segment_ways.size(), kFreeFlowProfile);
+  for (std::size_t segment = 0; segment < segment_profiles.size(); ++segment) {
+    const std::uint32_t way = tables.segment_ways[segment];
+    const auto assigned = profiles.way_profiles.find(tables.way_ids[way]);
+    segment_profiles[segment] = assigned != profiles.way_profiles.end()
+                                    ? assigned->second
+                                    : profiles.category_profiles[tables.way_categories[way]];
+  }
+
+  SectionWriter writer;
+  writer.add(SectionId::kProfileBreakpointOffsets, breakpoint_offsets);
+  writer.add(SectionId::kProfileBreakpoints, breakpoints);
+  writer.add(SectionId::kSegmentProfiles, segment_profiles);
+  writer.add(SectionId::kProfileStreetsHash, std::span<const std::uint64_t>(&streets_hash, 1));
+
+  const fs::path temporary = temporary_path(output_file);
+  writer.write(temporary, kSpeedProfilesMagic, kSpeedProfilesSchemaVersion);
+  fs::rename(temporary, output_file);
+}
+
+void write_osm_file(const ConverterData& data, const fs::path& output_file) {
+  const fs::path temporary = temporary_path(output_file);
+  {
+    std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      throw std::runtime_error("Failed to open OSM output file: " + temporary.string());
+    }
+
+    // the records are built first so their hash can go in the header
+    std::ostringstream records;
+    const std::uint64_t poi_count = data.pois.size();
+    write_pod(records, poi_count);
+    for (const auto& poi : data.pois) {
+      write_pod(records, poi.osm_id);
+      write_pod(records, poi.lat);
+      write_pod(records, poi.lon);
+      write_string(records, poi.category);
+      write_string(records, poi.name);
+    }
+    const std::string bytes = std::move(records).str();
+
+    out.write(kOsmMagic, sizeof(kOsmMagic));
+    write_pod(out, kOsmSchemaVersion);
+    write_pod(out, content_hash(bytes.data(), bytes.size()));
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    if (!out) {
+      throw std::runtime_error("Failed to write OSM output file: " + temporary.string());
+    }
+  }
+  fs::rename(temporary, output_file);
+}
+
+}  // namespace gisevo::converter
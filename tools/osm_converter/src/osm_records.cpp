@@ -0,0 +1,172 @@
+#include "converter/osm_records.hpp"
+
+#include <osmium/osm/tag.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <exception>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace gisevo::converter {
+namespace {
+
+std::string to_lower_copy(std::string_view value) {
+  std::string result(value);
+  std::transform(result.begin(), result.end(), result.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return result;
+}
+
+HighwayCategory encode_highway_category(const char* value) {
+  if (value == nullptr) {
+    return HighwayCategory::kUnknown;
+  }
+  const std::string lower = to_lower_copy(value);
+  if (lower == "motorway") return HighwayCategory::kMotorway;
+  if (lower == "motorway_link") return HighwayCategory::kMotorway;
+  if (lower == "trunk") return HighwayCategory::kTrunk;
+  if (lower == "trunk_link") return HighwayCategory::kTrunk;
+  if (lower == "primary") return HighwayCategory::kPrimary;
+  if (lower == "primary_link") return HighwayCategory::kPrimary;
+  if (lower == "secondary") return HighwayCategory::kSecondary;
+  if (lower == "secondary_link") return HighwayCategory::kSecondary;
+  if (lower == "tertiary") return HighwayCategory::kTertiary;
+  if (lower == "tertiary_link") return HighwayCategory::kTertiary;
+  if (lower == "residential") return HighwayCategory::kResidential;
+  if (lower == "living_street") return HighwayCategory::kResidential;
+  if (lower == "service") return HighwayCategory::kService;
+  if (lower == "track") return HighwayCategory::kTrack;
+  if (lower == "footway") return HighwayCategory::kFootway;
+  if (lower == "pedestrian") return HighwayCategory::kFootway;
+  if (lower == "path") return HighwayCategory::kPath;
+  if (lower == "cycleway") return HighwayCategory::kCycleway;
+  return HighwayCategory::kUnknown;
+}
+
+float parse_max_speed(const osmium::TagList& tags) {
+  const char* raw_value = tags.get_value_by_key("maxspeed");
+  if (!raw_value) {
+    return -1.0F;
+  }
+  std::string value = raw_value;
+  value.erase(std::remove_if(value.begin(), value.end(), ::isspace), value.end());
+  bool mph = false;
+  if (value.size() > 3) {
+    const std::string suffix = to_lower_copy(std::string_view(value).substr(value.size() - 3));
+    if (suffix == "mph") {
+      mph = true;
+      value.resize(value.size() - 3);
+    }
+  }
+  try {
+    const float numeric = std::stof(value);
+    if (mph) {
+      return numeric * 1.60934F;
+    }
+    return numeric;
+  } catch (const std::exception&) {
+    return -1.0F;
+  }
+}
+
+enum class OneWay { kNo, kForward, kReverse };
+
+OneWay parse_one_way(const osmium::TagList& tags, HighwayCategory category) {
+  if (const char* raw_value = tags.get_value_by_key("oneway")) {
+    const std::string value = to_lower_copy(raw_value);
+    if (value == "yes" || value == "true" || value == "1") return OneWay::kForward;
+    if (value == "-1" || value == "reverse") return OneWay::kReverse;
+    if (value == "no" || value == "false" || value == "0") return OneWay::kNo;
+  }
+  // implied oneway: roundabouts and motorways unless tagged otherwise
+  if (const char* junction = tags.get_value_by_key("junction")) {
+    if (to_lower_copy(junction) == "roundabout") return OneWay::kForward;
+  }
+  if (category == HighwayCategory::kMotorway) return OneWay::kForward;
+  return OneWay::kNo;
+}
+
+std::optional<std::string> detect_poi_category(const osmium::TagList& tags) {
+  if (const char* amenity = tags.get_value_by_key("amenity")) {
+    return std::string("amenity:") + amenity;
+  }
+  if (const char* shop = tags.get_value_by_key("shop")) {
+    return std::string("shop:") + shop;
+  }
+  if (const char* tourism = tags.get_value_by_key("tourism")) {
+    return std::string("tourism:") + tourism;
+  }
+  if (const char* leisure = tags.get_value_by_key("leisure")) {
+    return std::string("leisure:") + leisure;
+  }
+  if (const char* railway = tags.get_value_by_key("railway")) {
+    return std::string("railway:") + railway;
+  }
+  if (const char* public_transport = tags.get_value_by_key("public_transport")) {
+    return std::string("public_transport:") + public_transport;
+  }
+  if (const char* highway = tags.get_value_by_key("highway")) {
+    const std::string lower = to_lower_copy(highway);
+    if (lower == "bus_stop" || lower == "tram_stop" || lower == "platform") {
+      return std::string("highway:") + lower;
+    }
+  }
+  if (const char* aeroway = tags.get_value_by_key("aeroway")) {
+    return std::string("aeroway:") + aeroway;
+  }
+  return std::nullopt;
+}
+
+}  // namespace
+
+std::optional<StreetSegmentRecord> make_street_record(const osmium::Way& way) {
+  const char* highway = way.tags().get_value_by_key("highway");
+  if (!highway || way.nodes().size() < 2) {
+    return std::nullopt;
+  }
+
+  StreetSegmentRecord record;
+  record.osm_id = way.id();
+  record.category = encode_highway_category(highway);
+  record.max_speed_kph = parse_max_speed(way.tags());
+
+  if (const char* name = way.tags().get_value_by_key("name")) {
+    record.name = name;
+  }
+
+  record.node_refs.reserve(way.nodes().size());
+  for (const auto& node_ref : way.nodes()) {
+    record.node_refs.push_back(node_ref.ref());
+  }
+
+  const OneWay one_way = parse_one_way(way.tags(), record.category);
+  record.one_way = one_way != OneWay::kNo;
+  if (one_way == OneWay::kReverse) {
+    std::reverse(record.node_refs.begin(), record.node_refs.end());
+  }
+  return record;
+}
+
+std::optional<PoiRecord> make_poi_record(const osmium::Node& node) {
+  if (node.tags().empty() || !node.location().valid()) {
+    return std::nullopt;
+  }
+  auto poi_category = detect_poi_category(node.tags());
+  if (!poi_category) {
+    return std::nullopt;
+  }
+
+  PoiRecord poi;
+  poi.osm_id = node.id();
+  poi.lat = node.location().lat();
+  poi.lon = node.location().lon();
+  poi.category = std::move(*poi_category);
+  if (const char* name = node.tags().get_value_by_key("name")) {
+    poi.name = name;
+  }
+  return poi;
+}
+
+}  // namespace gisevo::converter
@@ -0,0 +1,74 @@
+#include "converter/section_writer.hpp"
+
+#include "converter/content_hash.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace gisevo::converter {
+namespace {
+
+std::uint64_t align_up(std::uint64_t value) {
+  return (value + kSectionAlignment - 1) / kSectionAlignment * kSectionAlignment;
+}
+
+void pad_to(std::ofstream& out, std::uint64_t offset) {
+  static constexpr char kZeros[kSectionAlignment] = {};
+  const auto position = static_cast<std::uint64_t>(out.tellp());
+  out.write(kZeros, static_cast<std::streamsize>(offset - position));
+}
+
+}  // namespace
+
+std::uint64_t SectionWriter::write(const fs::path& output_file, const char (&magic)[8],
+                                   std::uint32_t version) const {
+  std::vector<SectionEntry> toc;
+  toc.reserve(sections_.size());
+
+  std::uint64_t offset = align_up(sizeof(FileHeader) + sections_.size() * sizeof(SectionEntry));
+  for (const auto& section : sections_) {
+    SectionEntry entry{};
+    entry.id = static_cast<std::uint32_t>(section.id);
+    entry.element_size = section.element_size;
+    entry.offset = offset;
+    entry.count = section.count;
+    toc.push_back(entry);
+    offset = align_up(offset + section.count * section.element_size);
+  }
+
+  FileHeader header{};
+  std::copy(std::begin(magic), std::end(magic), header.magic);
+  header.version = version;
+  header.section_count = static_cast<std::uint32_t>(toc.size());
+  header.file_size = offset;
+  // padding is all zeros, so hashing the table and payloads covers every byte that can differ
+  header.content_hash = content_hash(toc.data(), toc.size() * sizeof(SectionEntry));
+  for (const auto& section : sections_) {
+    header.content_hash = content_hash(section.data, section.count * section.element_size, header.content_hash);
+  }
+
+  std::ofstream out(output_file, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    throw std::runtime_error("Failed to open output file: " + output_file.string());
+  }
+
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.write(reinterpret_cast<const char*>(toc.data()),
+            static_cast<std::streamsize>(toc.size() * sizeof(SectionEntry)));
+  for (std::size_t i = 0; i < sections_.size(); ++i) {
+    pad_to(out, toc[i].offset);
+    out.write(sections_[i].data,
+              static_cast<std::streamsize>(sections_[i].count * sections_[i].element_size));
+  }
+  pad_to(out, header.file_size);
+
+  if (!out) {
+    throw std::runtime_error("Failed to write output file: " + output_file.string());
+  }
+  return header.content_hash;
+}
+
+}  // namespace gisevo::converter
@@ -0,0 +1,130 @@
+#include "converter/speed_profiles.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+namespace fs = std::filesystem;
+
+namespace gisevo::converter {
+namespace {
+
+constexpr std::string_view kDays[] = {"Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun"};
+
+template <typename T>
+bool parse_number(std::string_view text, T& value) {
+  const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+  return error == std::errc{} && end == text.data() + text.size();
+}
+
+// "<day><hh:mm>=<percent>"; false if malformed
+bool parse_breakpoint(std::string_view token, SpeedBreakpoint& breakpoint) {
+  const std::size_t equals = token.find('=');
+  if (equals != 8 || token[5] != ':') {
+    return false;
+  }
+  const auto day = std::find(std::begin(kDays), std::end(kDays), token.substr(0, 3));
+  int hours = 0;
+  int minutes = 0;
+  double percent = 0;
+  if (day == std::end(kDays) || !parse_number(token.substr(3, 2), hours) ||
+      !parse_number(token.substr(6, 2), minutes) || !parse_number(token.substr(equals + 1), percent) ||
+      hours > 23 || minutes > 59 || !(percent > 0 && percent <= 100)) {
+    return false;
+  }
+  breakpoint.minute = static_cast<std::uint16_t>((day - std::begin(kDays)) * 24 * 60 + hours * 60 + minutes);
+  breakpoint.speed_permille = static_cast<std::uint16_t>(std::max(1.0, std::round(percent * 10)));
+  return true;
+}
+
+}  // namespace
+
+SpeedProfileSet read_speed_profiles(const fs::path& description) {
+  std::ifstream in(description);
+  if (!in) {
+    throw std::runtime_error("Failed to open speed profiles: " + description.string());
+  }
+
+  SpeedProfileSet set;
+  std::unordered_map<std::string, std::uint16_t> ids;
+  std::string line;
+  for (std::size_t line_number = 1; std::getline(in, line); ++line_number) {
+    auto fail = [&](const std::string& why) {
+      throw std::runtime_error(description.string() + ":" + std::to_string(line_number) + ": " + why);
+    };
+    auto profile_id = [&](const std::string& name) {
+      const auto found = ids.find(name);
+      if (found == ids.end()) {
+        fail("unknown profile " + name);
+      }
+      return found->second;
+    };
+
+    std::istringstream words(line.substr(0, line.find('#')));
+    std::string keyword;
+    if (!(words >> keyword)) {
+      continue;
+    }
+    std::string name;
+    if (keyword == "profile") {
+      if (!(words >> name) || ids.contains(name)) {
+        fail("profile needs a new name");
+      }
+      if (set.profiles.size() == std::numeric_limits<std::uint16_t>::max()) {
+        fail("too many profiles");
+      }
+      std::vector<SpeedBreakpoint> corners;
+      for (std::string token; words >> token;) {
+        SpeedBreakpoint& corner = corners.emplace_back();
+        if (!parse_breakpoint(token, corner)) {
+          fail("expected <day><hh:mm>=<percent above 0, at most 100>, got " + token);
+        }
+      }
+      if (corners.empty()) {
+        fail("profile " + name + " has no corners");
+      }
+      std::sort(corners.begin(), corners.end(),
+                [](const SpeedBreakpoint& a, const SpeedBreakpoint& b) { return a.minute < b.minute; });
+      for (std::size_t i = 1; i < corners.size(); ++i) {
+        if (corners[i].minute == corners[i - 1].minute) {
+          fail("profile " + name + " has two corners at the same time");
+        }
+      }
+      set.names.push_back(name);
+      set.profiles.push_back(std::move(corners));
+      ids.emplace(name, static_cast<std::uint16_t>(set.profiles.size()));
+    } else if (keyword == "highway") {
+      std::string category;
+      if (!(words >> category >> name)) {
+        fail("expected highway <category> <profile>");
+      }
+      bool known = false;
+      for (int value = 0; value <= static_cast<int>(HighwayCategory::kCycleway); ++value) {
+        if (category == highway_category_name(static_cast<HighwayCategory>(value))) {
+          set.category_profiles[value] = profile_id(name);
+          known = true;
+        }
+      }
+      if (!known) {
+        fail("unknown highway category " + category);
+      }
+    } else if (keyword == "way") {
+      std::string id;
+      std::int64_t way_id = 0;
+      if (!(words >> id >> name) || !parse_number(std::string_view(id), way_id)) {
+        fail("expected way <osm id> <profile>");
+      }
+      set.way_profiles[way_id] = profile_id(name);
+    } else {
+      fail("unknown keyword " + keyword);
+    }
+  }
+  return set;
+}
+
+}  // namespace gisevo::converter
@@ -0,0 +1,308 @@
+#include "converter/street_tables.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <string_view>
+#include <unordered_map>
+
+namespace gisevo::converter {
+namespace {
+
+// Same constants as the runtime's m1.h so precomputed lengths match findDistanceBetweenTwoPoints
+constexpr double kEarthRadiusInMeters = 6372797.560856;
+constexpr double kDegreeToRadian = 0.017453292519943295769236907684886;
+constexpr std::int32_t kNotAnIntersection = -1;
+
+class StringPool {
+ public:
+  explicit StringPool(StreetTables& tables) : tables_(tables) {
+    tables_.string_offsets.push_back(0);
+    intern("");
+  }
+
+  std::uint32_t intern(const std::string& value) {
+    auto [iter, inserted] = lookup_.try_emplace(value, static_cast<std::uint32_t>(lookup_.size()));
+    if (inserted) {
+      tables_.string_data.insert(tables_.string_data.end(), value.begin(), value.end());
+      tables_.string_offsets.push_back(tables_.string_data.size());
+    }
+    return iter->second;
+  }
+
+  std::string_view get(std::uint32_t index) const {
+    return {tables_.string_data.data() + tables_.string_offsets[index],
+            tables_.string_offsets[index + 1] - tables_.string_offsets[index]};
+  }
+
+ private:
+  StreetTables& tables_;
+  std::unordered_map<std::string, std::uint32_t> lookup_;
+};
+
+void add_nodes(const ConverterData& data, StreetTables& tables) {
+  std::vector<std::uint32_t> order(data.nodes.size());
+  std::iota(order.begin(), order.end(), 0U);
+  std::sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) {
+    return data.nodes[a].osm_id < data.nodes[b].osm_id;
+  });
+  tables.node_ids.reserve(order.size());
+  tables.node_lat.reserve(order.size());
+  tables.node_lon.reserve(order.size());
+  for (const std::uint32_t i : order) {
+    tables.node_ids.push_back(data.nodes[i].osm_id);
+    tables.node_lat.push_back(data.nodes[i].lat);
+    tables.node_lon.push_back(data.nodes[i].lon);
+  }
+}
+
+// Ways are numbered in OSM id order, like the nodes, so both id sections can be searched in place
+void add_ways(const ConverterData& data, StreetTables& tables, StringPool& strings) {
+  std::vector<std::uint32_t> order(data.street_segments.size());
+  std::iota(order.begin(), order.end(), 0U);
+  std::stable_sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) {
+    return data.street_segments[a].osm_id < data.street_segments[b].osm_id;
+  });
+
+  tables.way_node_offsets.push_back(0);
+  for (const std::uint32_t i : order) {
+    const auto& way = data.street_segments[i];
+    const std::size_t begin = tables.way_nodes.size();
+    for (const std::int64_t ref : way.node_refs) {
+      const auto node = std::lower_bound(tables.node_ids.begin(), tables.node_ids.end(), ref);
+      if (node != tables.node_ids.end() && *node == ref) {
+        tables.way_nodes.push_back(static_cast<std::uint32_t>(node - tables.node_ids.begin()));
+      }
+    }
+    if (tables.way_nodes.size() - begin < 2) {
+      tables.way_nodes.resize(begin);
+      continue;
+    }
+
+    double length = 0.0;
+    for (std::size_t r = begin + 1; r < tables.way_nodes.size(); ++r) {
+      const std::uint32_t a = tables.way_nodes[r - 1];
+      const std::uint32_t b = tables.way_nodes[r];
+      length += distance_between_points_m(tables.node_lat[a], tables.node_lon[a], tables.node_lat[b],
+                                          tables.node_lon[b]);
+    }
+
+    tables.way_ids.push_back(way.osm_id);
+    tables.way_categories.push_back(static_cast<std::uint8_t>(way.category));
+    tables.way_flags.push_back(way.one_way ? kWayFlagOneWay : 0);
+    tables.way_speeds.push_back(way.max_speed_kph);
+    tables.way_names.push_back(strings.intern(way.name));
+    tables.way_node_offsets.push_back(tables.way_nodes.size());
+    tables.way_lengths.push_back(length);
+  }
+}
+
+// Splits every way at its intersections; streets are numbered in order of first use
+void add_segments(StreetTables& tables, StringPool& strings) {
+  const std::size_t node_count = tables.node_ids.size();
+  const std::size_t way_count = tables.way_ids.size();
+
+  std::vector<std::uint8_t> use_count(node_count, 0);
+  for (std::size_t w = 0; w < way_count; ++w) {
+    const std::uint64_t begin = tables.way_node_offsets[w];
+    const std::uint64_t end = tables.way_node_offsets[w + 1];
+    for (std::uint64_t r = begin + 1; r + 1 < end; ++r) {
+      std::uint8_t& count = use_count[tables.way_nodes[r]];
+      count = static_cast<std::uint8_t>(std::min(count + 1, 2));
+    }
+    use_count[tables.way_nodes[begin]] = 2;
+    use_count[tables.way_nodes[end - 1]] = 2;
+  }
+
+  std::vector<std::int32_t> node_to_intersection(node_count, kNotAnIntersection);
+  for (std::size_t node = 0; node < node_count; ++node) {
+    if (use_count[node] >= 2) {
+      node_to_intersection[node] = static_cast<std::int32_t>(tables.intersection_nodes.size());
+      tables.intersection_nodes.push_back(static_cast<std::uint32_t>(node));
+    }
+  }
+
+  std::vector<std::int32_t> string_to_street(tables.string_offsets.size() - 1, -1);
+  string_to_street[0] = 0;
+  tables.street_names.push_back(strings.intern(kUnknownStreetName));
+
+  auto distance_between = [&](std::uint32_t a, std::uint32_t b) {
+    return distance_between_points_m(tables.node_lat[a], tables.node_lon[a], tables.node_lat[b],
+                                     tables.node_lon[b]);
+  };
+
+  tables.segment_curve_offsets.push_back(0);
+  for (std::size_t w = 0; w < way_count; ++w) {
+    const float speed_kph = tables.way_speeds[w] > 0.0F
+                                ? tables.way_speeds[w]
+                                : default_speed_kph(static_cast<HighwayCategory>(tables.way_categories[w]));
+    const float speed = speed_kph / 3.6F;
+    std::int32_t& street = string_to_street[tables.way_names[w]];
+    if (street < 0) {
+      street = static_cast<std::int32_t>(tables.street_names.size());
+      tables.street_names.push_back(tables.way_names[w]);
+    }
+
+    const std::uint64_t begin = tables.way_node_offsets[w];
+    const std::uint64_t end = tables.way_node_offsets[w + 1];
+    std::int32_t from = node_to_intersection[tables.way_nodes[begin]];
+    double length = 0.0;
+    for (std::uint64_t r = begin + 1; r < end; ++r) {
+      const std::uint32_t node = tables.way_nodes[r];
+      length += distance_between(tables.way_nodes[r - 1], node);
+      const std::int32_t to = node_to_intersection[node];
+      if (to == kNotAnIntersection) {
+        tables.curve_nodes.push_back(node);
+        continue;
+      }
+      tables.segment_ways.push_back(static_cast<std::uint32_t>(w));
+      tables.segment_from.push_back(from);
+      tables.segment_to.push_back(to);
+      tables.segment_streets.push_back(street);
+      tables.segment_flags.push_back(tables.way_flags[w]);
+      tables.segment_speeds.push_back(speed);
+      tables.segment_lengths.push_back(length);
+      tables.segment_travel_times.push_back(length / speed);
+      tables.segment_curve_offsets.push_back(tables.curve_nodes.size());
+
+      from = to;
+      length = 0.0;
+    }
+  }
+}
+
+// Intersection -> incident segments (and the intersection across each one), in segment order
+void add_intersection_lists(StreetTables& tables) {
+  const std::size_t segment_count = tables.segment_from.size();
+  auto& offsets = tables.intersection_segment_offsets;
+  offsets.assign(tables.intersection_nodes.size() + 1, 0);
+  for (std::size_t s = 0; s < segment_count; ++s) {
+    ++offsets[tables.segment_from[s] + 1];
+    if (tables.segment_to[s] != tables.segment_from[s]) {
+      ++offsets[tables.segment_to[s] + 1];
+    }
+  }
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+  tables.intersection_segments.resize(offsets.back());
+  tables.intersection_adjacent.resize(offsets.back());
+  std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+  for (std::size_t s = 0; s < segment_count; ++s) {
+    const std::int32_t from = tables.segment_from[s];
+    const std::int32_t to = tables.segment_to[s];
+    tables.intersection_segments[fill[from]] = static_cast<std::int32_t>(s);
+    tables.intersection_adjacent[fill[from]++] = to;
+    if (to != from) {
+      tables.intersection_segments[fill[to]] = static_cast<std::int32_t>(s);
+      tables.intersection_adjacent[fill[to]++] = from;
+    }
+  }
+}
+
+void add_routing_edges(StreetTables& tables) {
+  const std::size_t intersection_count = tables.intersection_nodes.size();
+  tables.routing_edge_offsets.reserve(intersection_count + 1);
+  tables.routing_edge_offsets.push_back(0);
+  for (std::size_t i = 0; i < intersection_count; ++i) {
+    for (std::uint32_t k = tables.intersection_segment_offsets[i]; k < tables.intersection_segment_offsets[i + 1]; ++k) {
+      const std::int32_t segment = tables.intersection_segments[k];
+      const bool one_way = (tables.segment_flags[segment] & kWayFlagOneWay) != 0;
+      if (one_way && tables.segment_from[segment] != static_cast<std::int32_t>(i)) {
+        continue;
+      }
+      tables.routing_edges.push_back(RoutingEdge{segment, tables.intersection_adjacent[k], tables.segment_streets[segment],
+                                                 0, tables.segment_travel_times[segment]});
+    }
+    tables.routing_edge_offsets.push_back(static_cast<std::uint32_t>(tables.routing_edges.size()));
+  }
+}
+
+void add_street_lists(StreetTables& tables, StringPool& strings) {
+  const std::size_t street_count = tables.street_names.size();
+  std::vector<std::vector<std::int32_t>> segments(street_count);
+  std::vector<std::vector<std::int32_t>> intersections(street_count);
+  tables.street_lengths.assign(street_count, 0.0);
+  for (std::size_t s = 0; s < tables.segment_streets.size(); ++s) {
+    const std::int32_t street = tables.segment_streets[s];
+    segments[street].push_back(static_cast<std::int32_t>(s));
+    intersections[street].push_back(tables.segment_from[s]);
+    intersections[street].push_back(tables.segment_to[s]);
+    tables.street_lengths[street] += tables.segment_lengths[s];
+  }
+
+  tables.street_segment_offsets.push_back(0);
+  tables.street_intersection_offsets.push_back(0);
+  for (std::size_t street = 0; street < street_count; ++street) {
+    auto& ids = intersections[street];
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    tables.street_segments.insert(tables.street_segments.end(), segments[street].begin(), segments[street].end());
+    tables.street_intersections.insert(tables.street_intersections.end(), ids.begin(), ids.end());
+    tables.street_segment_offsets.push_back(static_cast<std::uint32_t>(tables.street_segments.size()));
+    tables.street_intersection_offsets.push_back(static_cast<std::uint32_t>(tables.street_intersections.size()));
+  }
+
+  for (const std::uint32_t name : tables.street_names) {
+    tables.street_keys.push_back(strings.intern(street_search_key(std::string(strings.get(name)))));
+  }
+  tables.streets_by_key.resize(street_count);
+  std::iota(tables.streets_by_key.begin(), tables.streets_by_key.end(), 0);
+  std::stable_sort(tables.streets_by_key.begin(), tables.streets_by_key.end(),
+                   [&](std::int32_t a, std::int32_t b) {
+                     return strings.get(tables.street_keys[a]) < strings.get(tables.street_keys[b]);
+                   });
+}
+
+void add_summary(StreetTables& tables) {
+  NetworkSummary& summary = tables.summary;
+  if (!tables.node_ids.empty()) {
+    const auto [min_lat, max_lat] = std::minmax_element(tables.node_lat.begin(), tables.node_lat.end());
+    const auto [min_lon, max_lon] = std::minmax_element(tables.node_lon.begin(), tables.node_lon.end());
+    summary.min_lat = *min_lat;
+    summary.max_lat = *max_lat;
+    summary.min_lon = *min_lon;
+    summary.max_lon = *max_lon;
+  }
+  for (const float speed : tables.segment_speeds) {
+    summary.max_speed = std::max(summary.max_speed, speed);
+  }
+}
+
+}  // namespace
+
+double distance_between_points_m(double lat1, double lon1, double lat2, double lon2) {
+  lat1 *= kDegreeToRadian;
+  lon1 *= kDegreeToRadian;
+  lat2 *= kDegreeToRadian;
+  lon2 *= kDegreeToRadian;
+  const double lat_avg = (lat1 + lat2) / 2;
+  const double dx = kEarthRadiusInMeters * (lon2 - lon1) * std::cos(lat_avg);
+  const double dy = kEarthRadiusInMeters * (lat2 - lat1);
+  return std::sqrt(dx * dx + dy * dy);
+}
+
+std::string street_search_key(std::string name) {
+  name.erase(std::remove(name.begin(), name.end(), ' '), name.end());
+  for (char& c : name) {
+    if (c >= 'A' && c <= 'Z') {
+      c = static_cast<char>(c + ('a' - 'A'));
+    }
+  }
+  return name;
+}
+
+StreetTables build_street_tables(const ConverterData& data) {
+  StreetTables tables;
+  StringPool strings(tables);
+  add_nodes(data, tables);
+  add_ways(data, tables, strings);
+  add_segments(tables, strings);
+  add_intersection_lists(tables);
+  add_routing_edges(tables);
+  add_street_lists(tables, strings);
+  add_summary(tables);
+  return tables;
+}
+
+}  // namespace gisevo::converter